@@ -0,0 +1,124 @@
+#pragma once
+
+#include "util_string.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace util {
+
+//-----------------------------------------------------------------------------
+// Arena (monotonic) allocator
+
+class CORE_EXPORT arena {
+ public:
+    enum : size_t { kDefBlockSize = 16384 };
+
+    explicit arena(size_t block_size = kDefBlockSize) : block_size_(block_size) {}
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+    arena(arena&& other) NOEXCEPT : block_size_(other.block_size_) { steal_data(other); }
+    arena& operator=(arena&& other) NOEXCEPT {
+        if (&other == this) { return *this; }
+        release();
+        block_size_ = other.block_size_;
+        steal_data(other);
+        return *this;
+    }
+    ~arena() { release(); }
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        assert(alignment && !(alignment & (alignment - 1)));
+        auto p = (reinterpret_cast<uintptr_t>(cur_) + alignment - 1) & ~(alignment - 1);
+        auto end = reinterpret_cast<uintptr_t>(end_);
+        if (p > end || size > end - p) { return allocate_slow(size, alignment); }
+        cur_ = reinterpret_cast<char*>(p + size);
+        return reinterpret_cast<void*>(p);
+    }
+
+    template<typename Ty>
+    Ty* allocate(size_t count) {
+        return static_cast<Ty*>(allocate(count * sizeof(Ty), alignof(Ty)));
+    }
+
+    // grows the most recent allocation in place if the current block has enough room
+    bool try_extend(void* p, size_t size, size_t new_size) {
+        assert(new_size >= size);
+        if (static_cast<char*>(p) + size != cur_ || new_size - size > static_cast<size_t>(end_ - cur_)) {
+            return false;
+        }
+        cur_ += new_size - size;
+        return true;
+    }
+
+    std::string_view copy_string(std::string_view s) {
+        auto p = static_cast<char*>(allocate(s.size() + 1, 1));
+        std::memcpy(p, s.data(), s.size());
+        p[s.size()] = '\0';
+        return std::string_view(p, s.size());
+    }
+
+    size_t block_size() const { return block_size_; }
+    size_t allocated_size() const { return allocated_size_; }
+
+    void clear();
+    void release();
+
+ private:
+    struct block_hdr_t {
+        block_hdr_t* next;
+        size_t size;
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    size_t block_size_;
+    size_t allocated_size_ = 0;
+    block_hdr_t* head_ = nullptr;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+
+    void steal_data(arena& other) {
+        allocated_size_ = other.allocated_size_, head_ = other.head_;
+        cur_ = other.cur_, end_ = other.end_;
+        other.allocated_size_ = 0, other.head_ = nullptr;
+        other.cur_ = other.end_ = nullptr;
+    }
+
+    void* allocate_slow(size_t size, size_t alignment);
+};
+
+//-----------------------------------------------------------------------------
+// Arena allocator adapter: memory is released with the arena only
+
+template<typename Ty>
+class arena_allocator {
+ public:
+    using value_type = Ty;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    explicit arena_allocator(arena& a) NOEXCEPT : arena_(&a) {}
+    template<typename Ty2>
+    arena_allocator(const arena_allocator<Ty2>& other) NOEXCEPT : arena_(other.get_arena()) {}
+
+    Ty* allocate(size_t n) { return arena_->template allocate<Ty>(n); }
+    void deallocate(Ty*, size_t) NOEXCEPT {}
+
+    arena* get_arena() const NOEXCEPT { return arena_; }
+
+    template<typename Ty2>
+    bool operator==(const arena_allocator<Ty2>& other) const NOEXCEPT {
+        return arena_ == other.get_arena();
+    }
+    template<typename Ty2>
+    bool operator!=(const arena_allocator<Ty2>& other) const NOEXCEPT {
+        return arena_ != other.get_arena();
+    }
+
+ private:
+    arena* arena_;
+};
+
+}  // namespace util
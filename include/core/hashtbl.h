@@ -0,0 +1,931 @@
+#pragma once
+
+#include "util_iterator.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef USE_SSE2
+#    include <emmintrin.h>
+#endif  // USE_SSE2
+
+namespace util {
+
+namespace impl {
+
+//-----------------------------------------------------------------------------
+// Open addressing hash table control bytes
+
+struct hashtbl_ctrl {
+    enum : std::int8_t { kEmpty = -128, kDeleted = -2, kSentinel = -1 };
+
+    static std::int8_t* empty_group() NOEXCEPT {
+        alignas(16) static const std::int8_t group[16] = {kSentinel, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+                                                          kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+                                                          kEmpty,    kEmpty, kEmpty, kEmpty};
+        return const_cast<std::int8_t*>(group);
+    }
+
+    static std::uint64_t mix(size_t hash) NOEXCEPT {
+        const std::uint64_t m = static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ull;
+        return m ^ (m >> 32);
+    }
+    static size_t h1(std::uint64_t hash) NOEXCEPT { return static_cast<size_t>(hash); }
+    static std::int8_t h2(std::uint64_t hash) NOEXCEPT { return static_cast<std::int8_t>(hash >> 57); }
+};
+
+template<typename MaskTy, unsigned Shift>
+class hashtbl_bitmask {
+ public:
+    explicit hashtbl_bitmask(MaskTy mask) NOEXCEPT : mask_(mask) {}
+    explicit operator bool() const NOEXCEPT { return mask_ != 0; }
+    unsigned lowest() const NOEXCEPT { return count_trailing_zeros(mask_) >> Shift; }
+    void clear_lowest() NOEXCEPT { mask_ &= mask_ - 1; }
+
+ private:
+    MaskTy mask_;
+};
+
+#ifdef USE_SSE2
+struct hashtbl_group {
+    enum : unsigned { kWidth = 16 };
+    using bitmask = hashtbl_bitmask<std::uint32_t, 0>;
+
+    explicit hashtbl_group(const std::int8_t* p) NOEXCEPT
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+    bitmask match(std::int8_t h2) const NOEXCEPT {
+        return bitmask(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))));
+    }
+    bitmask match_empty() const NOEXCEPT { return match(hashtbl_ctrl::kEmpty); }
+    bitmask match_empty_or_deleted() const NOEXCEPT { return bitmask(empty_or_deleted_mask()); }
+    unsigned count_leading_empty_or_deleted() const NOEXCEPT {
+        return count_trailing_zeros(empty_or_deleted_mask() + 1);
+    }
+
+    std::uint32_t empty_or_deleted_mask() const NOEXCEPT {
+        return static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(hashtbl_ctrl::kSentinel), ctrl)));
+    }
+
+    __m128i ctrl;
+};
+#else   // USE_SSE2
+struct hashtbl_group {
+    enum : unsigned { kWidth = 8 };
+    using bitmask = hashtbl_bitmask<std::uint64_t, 3>;
+    static const std::uint64_t kLsbs = 0x0101010101010101ull;
+    static const std::uint64_t kMsbs = 0x8080808080808080ull;
+
+    explicit hashtbl_group(const std::int8_t* p) NOEXCEPT { std::memcpy(&ctrl, p, sizeof(ctrl)); }
+
+    // note: can report false positives for full slots only, the keys are compared anyway
+    bitmask match(std::int8_t h2) const NOEXCEPT {
+        const std::uint64_t x = ctrl ^ (kLsbs * static_cast<std::uint8_t>(h2));
+        return bitmask((x - kLsbs) & ~x & kMsbs);
+    }
+    bitmask match_empty() const NOEXCEPT { return bitmask(ctrl & (~ctrl << 6) & kMsbs); }
+    bitmask match_empty_or_deleted() const NOEXCEPT { return bitmask(ctrl & (~ctrl << 7) & kMsbs); }
+    unsigned count_leading_empty_or_deleted() const NOEXCEPT {
+        const std::uint64_t gaps = 0x00fefefefefefefeull;
+        return (count_trailing_zeros(((~ctrl & (ctrl >> 7)) | gaps) + 1) + 7) >> 3;
+    }
+
+    std::uint64_t ctrl;
+};
+#endif  // USE_SSE2
+
+//-----------------------------------------------------------------------------
+// Hash table slot types
+
+template<typename Key>
+struct hashtbl_set_traits {
+    using key_type = Key;
+    using value_type = Key;
+    static const key_type& get_key(const value_type& v) { return v; }
+    template<typename Alloc>
+    static void transfer(Alloc& alloc, value_type* dst, value_type* src) {
+        std::allocator_traits<Alloc>::construct(alloc, dst, std::move(*src));
+        std::allocator_traits<Alloc>::destroy(alloc, src);
+    }
+};
+
+template<typename Key, typename Ty>
+struct hashtbl_map_traits {
+    using key_type = Key;
+    using mapped_type = Ty;
+    using value_type = std::pair<const Key, Ty>;
+    static const key_type& get_key(const value_type& v) { return v.first; }
+    template<typename Alloc>
+    static void transfer(Alloc& alloc, value_type* dst, value_type* src) {
+        std::allocator_traits<Alloc>::construct(alloc, dst, std::piecewise_construct,
+                                                std::forward_as_tuple(std::move(const_cast<Key&>(src->first))),
+                                                std::forward_as_tuple(std::move(src->second)));
+        std::allocator_traits<Alloc>::destroy(alloc, src);
+    }
+};
+
+}  // namespace impl
+
+//-----------------------------------------------------------------------------
+// Hash table iterator
+
+template<typename Traits, bool Const>
+class hashtbl_iterator : public container_iterator_facade<Traits, hashtbl_iterator<Traits, Const>,  //
+                                                          std::forward_iterator_tag, Const> {
+ private:
+    using super = container_iterator_facade<Traits, hashtbl_iterator, std::forward_iterator_tag, Const>;
+
+ public:
+    using reference = typename super::reference;
+    using pointer = typename super::pointer;
+
+    hashtbl_iterator() NOEXCEPT = default;
+    hashtbl_iterator(const std::int8_t* ctrl, pointer slot) NOEXCEPT : ctrl_(ctrl), slot_(slot) {}
+    hashtbl_iterator(const hashtbl_iterator&) NOEXCEPT = default;
+    hashtbl_iterator& operator=(const hashtbl_iterator&) NOEXCEPT = default;
+    ~hashtbl_iterator() = default;
+#ifdef _DEBUG
+    hashtbl_iterator& operator=(hashtbl_iterator&& it) NOEXCEPT {
+        assert(std::addressof(it) != this);
+        return *this = static_cast<const hashtbl_iterator&>(it);
+    }
+#endif  // _DEBUG
+
+    template<bool Const_ = Const>
+    hashtbl_iterator(const std::enable_if_t<Const_, hashtbl_iterator<Traits, false>>& it) NOEXCEPT
+        : ctrl_(it.ctrl_),
+          slot_(it.slot_) {}
+
+    template<bool Const_ = Const>
+    hashtbl_iterator& operator=(const std::enable_if_t<Const_, hashtbl_iterator<Traits, false>>& it) NOEXCEPT {
+        ctrl_ = it.ctrl_, slot_ = it.slot_;
+        return *this;
+    }
+
+    const std::int8_t* ctrl() const NOEXCEPT { return ctrl_; }
+
+    void increment() NOEXCEPT {
+        iterator_assert(ctrl_ && (*ctrl_ >= 0));
+        ++ctrl_, ++slot_;
+        skip_empty_or_deleted();
+    }
+
+    template<bool Const2>
+    bool equal(const hashtbl_iterator<Traits, Const2>& it) const NOEXCEPT {
+        return ctrl_ == it.ctrl_;
+    }
+
+    reference dereference() const NOEXCEPT {
+        iterator_assert(ctrl_ && (*ctrl_ >= 0));
+        return *slot_;
+    }
+
+    void skip_empty_or_deleted() NOEXCEPT {
+        while (*ctrl_ < impl::hashtbl_ctrl::kSentinel) {
+            const unsigned shift = impl::hashtbl_group(ctrl_).count_leading_empty_or_deleted();
+            ctrl_ += shift, slot_ += shift;
+        }
+    }
+
+ private:
+    template<typename, bool>
+    friend class hashtbl_iterator;
+    const std::int8_t* ctrl_{nullptr};
+    pointer slot_{nullptr};
+};
+
+template<typename Traits, bool Const1, bool Const2>
+struct is_iterator_comparable<hashtbl_iterator<Traits, Const1>, hashtbl_iterator<Traits, Const2>> : std::true_type {};
+
+#ifdef USE_CHECKED_ITERATORS
+template<typename Traits, bool Const>
+struct std::_Is_checked_helper<hashtbl_iterator<Traits, Const>> : std::true_type {};
+#endif  // USE_CHECKED_ITERATORS
+
+namespace impl {
+
+//-----------------------------------------------------------------------------
+// Hash table node handle
+
+// Slots are stored in place, so the handle owns a moved-out value instead of a detached node
+
+template<typename Traits, typename Alloc, typename NodeHandle, typename = void>
+class hashtbl_node_handle_getters : protected std::allocator_traits<Alloc>::template rebind_alloc<
+                                        typename Traits::value_type> {
+ protected:
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<typename Traits::value_type>;
+
+ public:
+    using value_type = typename Traits::value_type;
+    hashtbl_node_handle_getters() NOEXCEPT_IF(std::is_nothrow_default_constructible<alloc_type>::value) {}
+    explicit hashtbl_node_handle_getters(const alloc_type& alloc) NOEXCEPT : alloc_type(alloc) {}
+    value_type& value() const { return *static_cast<const NodeHandle*>(this)->get(); }
+};
+
+template<typename Traits, typename Alloc, typename NodeHandle>
+class hashtbl_node_handle_getters<Traits, Alloc, NodeHandle, std::void_t<typename Traits::mapped_type>>
+    : protected std::allocator_traits<Alloc>::template rebind_alloc<typename Traits::value_type> {
+ protected:
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<typename Traits::value_type>;
+
+ public:
+    using key_type = typename Traits::key_type;
+    using mapped_type = typename Traits::mapped_type;
+    hashtbl_node_handle_getters() NOEXCEPT_IF(std::is_nothrow_default_constructible<alloc_type>::value) {}
+    explicit hashtbl_node_handle_getters(const alloc_type& alloc) NOEXCEPT : alloc_type(alloc) {}
+    key_type& key() const { return const_cast<key_type&>(static_cast<const NodeHandle*>(this)->get()->first); }
+    mapped_type& mapped() const { return static_cast<const NodeHandle*>(this)->get()->second; }
+};
+
+template<typename Traits, typename Alloc>
+class hashtbl_node_handle
+    : public hashtbl_node_handle_getters<Traits, Alloc, hashtbl_node_handle<Traits, Alloc>> {
+ private:
+    using super = hashtbl_node_handle_getters<Traits, Alloc, hashtbl_node_handle>;
+    using alloc_type = typename super::alloc_type;
+    using alloc_traits = std::allocator_traits<alloc_type>;
+    using value_type = typename Traits::value_type;
+
+ public:
+    using allocator_type = Alloc;
+
+    hashtbl_node_handle() = default;
+    hashtbl_node_handle(hashtbl_node_handle&& nh) : super(static_cast<const alloc_type&>(nh)) {
+        if (nh.engaged_) { steal(nh); }
+    }
+
+    hashtbl_node_handle& operator=(hashtbl_node_handle&& nh) {
+        assert(std::addressof(nh) != this);
+        if (std::addressof(nh) == this) { return *this; }
+        reset();
+        alloc_type::operator=(static_cast<const alloc_type&>(nh));
+        if (nh.engaged_) { steal(nh); }
+        return *this;
+    }
+
+    ~hashtbl_node_handle() { reset(); }
+
+    allocator_type get_allocator() const { return static_cast<const alloc_type&>(*this); }
+    bool empty() const NOEXCEPT { return !engaged_; }
+    explicit operator bool() const NOEXCEPT { return engaged_; }
+    void swap(hashtbl_node_handle& nh) {
+        if (std::addressof(nh) == this) { return; }
+        hashtbl_node_handle tmp(std::move(nh));
+        nh = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+ protected:
+    typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage_;
+    bool engaged_ = false;
+
+    template<typename, typename, typename, typename>
+    friend class hashtbl_node_handle_getters;
+    template<typename, typename, typename, typename>
+    friend class hashtbl;
+
+    explicit hashtbl_node_handle(const alloc_type& alloc) NOEXCEPT : super(alloc) {}
+
+    value_type* get() const { return reinterpret_cast<value_type*>(const_cast<void*>(static_cast<const void*>(&storage_))); }
+
+    template<typename... Args>
+    void construct(Args&&... args) {
+        assert(!engaged_);
+        alloc_traits::construct(*this, get(), std::forward<Args>(args)...);
+        engaged_ = true;
+    }
+
+    void take(value_type* slot) {
+        assert(!engaged_);
+        Traits::transfer(static_cast<alloc_type&>(*this), get(), slot);
+        engaged_ = true;
+    }
+
+    void steal(hashtbl_node_handle& nh) {
+        Traits::transfer(static_cast<alloc_type&>(*this), get(), nh.get());
+        engaged_ = true, nh.engaged_ = false;
+    }
+
+    void reset() {
+        if (!engaged_) { return; }
+        alloc_traits::destroy(*this, get());
+        engaged_ = false;
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Hash table functors holder
+
+template<typename Alloc, typename Hash, typename KeyEqual, typename = void>
+class hashtbl_funcs : public Alloc {
+ public:
+    hashtbl_funcs() NOEXCEPT_IF((std::is_nothrow_default_constructible<Hash>::value) &&
+                                (std::is_nothrow_default_constructible<KeyEqual>::value) &&
+                                (std::is_nothrow_default_constructible<Alloc>::value)) {}
+    hashtbl_funcs(const Alloc& alloc, const Hash& hash, const KeyEqual& eq)
+        : Alloc(alloc), hash_(hash), key_eq_(eq) {}
+    hashtbl_funcs(Alloc&& alloc, Hash&& hash, KeyEqual&& eq)
+        : Alloc(std::move(alloc)), hash_(std::move(hash)), key_eq_(std::move(eq)) {}
+
+    const Hash& get_hasher() const { return hash_; }
+    const KeyEqual& get_key_eq() const { return key_eq_; }
+    void swap_funcs(hashtbl_funcs& other) {
+        std::swap(hash_, other.hash_);
+        std::swap(key_eq_, other.key_eq_);
+    }
+    void assign_funcs(const hashtbl_funcs& other) { hash_ = other.hash_, key_eq_ = other.key_eq_; }
+    void assign_funcs(hashtbl_funcs&& other) { hash_ = std::move(other.hash_), key_eq_ = std::move(other.key_eq_); }
+
+ private:
+    Hash hash_;
+    KeyEqual key_eq_;
+};
+
+template<typename Alloc, typename Hash, typename KeyEqual>
+class hashtbl_funcs<Alloc, Hash, KeyEqual,
+                    std::enable_if_t<(std::is_empty<Hash>::value && std::is_nothrow_default_constructible<Hash>::value &&
+                                      std::is_empty<KeyEqual>::value &&
+                                      std::is_nothrow_default_constructible<KeyEqual>::value)>> : public Alloc {
+ public:
+    hashtbl_funcs() NOEXCEPT_IF(std::is_nothrow_default_constructible<Alloc>::value) {}
+    hashtbl_funcs(const Alloc& alloc, const Hash&, const KeyEqual&) : Alloc(alloc) {}
+    hashtbl_funcs(Alloc&& alloc, Hash&&, KeyEqual&&) : Alloc(std::move(alloc)) {}
+
+    Hash get_hasher() const { return Hash(); }
+    KeyEqual get_key_eq() const { return KeyEqual(); }
+    void swap_funcs(hashtbl_funcs&) {}
+    void assign_funcs(const hashtbl_funcs&) {}
+};
+
+//-----------------------------------------------------------------------------
+// Open addressing hash table with unique keys
+
+// Slots and control bytes live in one allocation: `capacity_` is `2^n - 1`, followed by control bytes,
+// a sentinel and `kWidth - 1` cloned control bytes, so a group can be loaded at any slot position
+
+template<typename Traits, typename Hash, typename KeyEqual, typename Alloc>
+class hashtbl
+    : protected hashtbl_funcs<typename std::allocator_traits<Alloc>::template rebind_alloc<typename Traits::value_type>,
+                              Hash, KeyEqual> {
+ protected:
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<typename Traits::value_type>;
+    using alloc_traits = std::allocator_traits<alloc_type>;
+    using super = hashtbl_funcs<alloc_type, Hash, KeyEqual>;
+    using group_t = hashtbl_group;
+    using ctrl_t = hashtbl_ctrl;
+
+ public:
+    using key_type = typename Traits::key_type;
+    using value_type = typename Traits::value_type;
+    using allocator_type = Alloc;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using size_type = typename alloc_traits::size_type;
+    using difference_type = typename alloc_traits::difference_type;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using iterator = hashtbl_iterator<hashtbl, std::is_same<key_type, value_type>::value>;
+    using const_iterator = hashtbl_iterator<hashtbl, true>;
+    using node_type = hashtbl_node_handle<Traits, Alloc>;
+
+    struct insert_return_type {
+#if __cplusplus < 201703L
+        insert_return_type(iterator in_position, bool in_inserted, node_type&& in_node)
+            : position(in_position), inserted(in_inserted), node(std::move(in_node)) {}
+        insert_return_type(insert_return_type&& rt)
+            : position(rt.position), inserted(rt.inserted), node(std::move(rt.node)) {}
+        insert_return_type& operator=(insert_return_type&& rt) {
+            position = rt.position, inserted = rt.inserted, node = std::move(rt.node);
+            return *this;
+        }
+#endif  // __cplusplus
+        iterator position;
+        bool inserted;
+        node_type node;
+    };
+
+    hashtbl() NOEXCEPT_IF(std::is_nothrow_default_constructible<super>::value) {}
+    explicit hashtbl(size_type bucket_count, const hasher& hash, const key_equal& eq, const allocator_type& alloc)
+        : super(alloc_type(alloc), hash, eq) {
+        if (bucket_count) { reserve(bucket_count); }
+    }
+
+    hashtbl(const hashtbl& other)
+        : super(alloc_traits::select_on_container_copy_construction(other), other.get_hasher(), other.get_key_eq()) {
+        init_from(other);
+    }
+
+    hashtbl(const hashtbl& other, const allocator_type& alloc)
+        : super(alloc_type(alloc), other.get_hasher(), other.get_key_eq()) {
+        init_from(other);
+    }
+
+    hashtbl& operator=(const hashtbl& other) {
+        if (std::addressof(other) == this) { return *this; }
+        clear();
+        this->assign_funcs(other);
+        if (alloc_traits::propagate_on_container_copy_assignment::value && !is_alloc_always_equal<alloc_type>::value &&
+            !is_same_alloc(other)) {
+            tidy();
+            alloc_type::operator=(other);
+        }
+        init_from(other);
+        return *this;
+    }
+
+    hashtbl(hashtbl&& other) NOEXCEPT : super(std::move(other)) { steal_data(other); }
+
+    hashtbl(hashtbl&& other, const allocator_type& alloc)
+        : super(alloc_type(alloc), other.get_hasher(), other.get_key_eq()) {
+        if (is_alloc_always_equal<alloc_type>::value || is_same_alloc(other)) {
+            steal_data(other);
+        } else {
+            move_from(other);
+        }
+    }
+
+    hashtbl& operator=(hashtbl&& other) NOEXCEPT_IF(alloc_traits::propagate_on_container_move_assignment::value ||
+                                                    is_alloc_always_equal<alloc_type>::value) {
+        assert(std::addressof(other) != this);
+        if (std::addressof(other) == this) { return *this; }
+        tidy();
+        this->assign_funcs(std::move(other));
+        if (alloc_traits::propagate_on_container_move_assignment::value) {
+            alloc_type::operator=(std::move(other));
+            steal_data(other);
+        } else if (is_alloc_always_equal<alloc_type>::value || is_same_alloc(other)) {
+            steal_data(other);
+        } else {
+            move_from(other);
+        }
+        return *this;
+    }
+
+    ~hashtbl() { tidy(); }
+
+    allocator_type get_allocator() const { return allocator_type(static_cast<const alloc_type&>(*this)); }
+    hasher hash_function() const { return this->get_hasher(); }
+    key_equal key_eq() const { return this->get_key_eq(); }
+
+    bool empty() const NOEXCEPT { return size_ == 0; }
+    size_type size() const NOEXCEPT { return size_; }
+    size_type max_size() const NOEXCEPT { return alloc_traits::max_size(*this) / 2; }
+    size_type capacity() const NOEXCEPT { return capacity_; }
+    size_type bucket_count() const NOEXCEPT { return capacity_; }
+    float load_factor() const NOEXCEPT { return capacity_ ? static_cast<float>(size_) / capacity_ : 0.f; }
+    float max_load_factor() const NOEXCEPT { return 7.f / 8.f; }
+    void max_load_factor(float) NOEXCEPT {}  // fixed
+
+    iterator begin() NOEXCEPT { return first_iterator<iterator>(); }
+    const_iterator begin() const NOEXCEPT { return first_iterator<const_iterator>(); }
+    const_iterator cbegin() const NOEXCEPT { return first_iterator<const_iterator>(); }
+
+    iterator end() NOEXCEPT { return iterator(ctrl_ + capacity_, slots_ + capacity_); }
+    const_iterator end() const NOEXCEPT { return const_iterator(ctrl_ + capacity_, slots_ + capacity_); }
+    const_iterator cend() const NOEXCEPT { return const_iterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+    // - find
+
+    iterator find(const key_type& key) { return to_iterator<iterator>(find_index(key, hash_of(key))); }
+
+    template<typename Key, typename Hash_ = hasher, typename Eq_ = key_equal,
+             typename = std::void_t<typename Hash_::is_transparent, typename Eq_::is_transparent>>
+    iterator find(const Key& key) {
+        return to_iterator<iterator>(find_index(key, hash_of(key)));
+    }
+
+    const_iterator find(const key_type& key) const {
+        return to_iterator<const_iterator>(find_index(key, hash_of(key)));
+    }
+
+    template<typename Key, typename Hash_ = hasher, typename Eq_ = key_equal,
+             typename = std::void_t<typename Hash_::is_transparent, typename Eq_::is_transparent>>
+    const_iterator find(const Key& key) const {
+        return to_iterator<const_iterator>(find_index(key, hash_of(key)));
+    }
+
+    // - equal_range
+
+    std::pair<iterator, iterator> equal_range(const key_type& key) { return make_equal_range(find(key)); }
+
+    template<typename Key, typename Hash_ = hasher, typename Eq_ = key_equal,
+             typename = std::void_t<typename Hash_::is_transparent, typename Eq_::is_transparent>>
+    std::pair<iterator, iterator> equal_range(const Key& key) {
+        return make_equal_range(find(key));
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+        return make_equal_range(find(key));
+    }
+
+    template<typename Key, typename Hash_ = hasher, typename Eq_ = key_equal,
+             typename = std::void_t<typename Hash_::is_transparent, typename Eq_::is_transparent>>
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+        return make_equal_range(find(key));
+    }
+
+    // - count, contains
+
+    size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+    template<typename Key, typename Hash_ = hasher, typename Eq_ = key_equal,
+             typename = std::void_t<typename Hash_::is_transparent, typename Eq_::is_transparent>>
+    size_type count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    bool contains(const key_type& key) const { return find_index(key, hash_of(key)) != kNpos; }
+
+    template<typename Key, typename Hash_ = hasher, typename Eq_ = key_equal,
+             typename = std::void_t<typename Hash_::is_transparent, typename Eq_::is_transparent>>
+    bool contains(const Key& key) const {
+        return find_index(key, hash_of(key)) != kNpos;
+    }
+
+    // - insert, emplace
+
+    std::pair<iterator, bool> insert(const value_type& val) { return emplace_with_key(Traits::get_key(val), val); }
+    std::pair<iterator, bool> insert(value_type&& val) {
+        return emplace_with_key(Traits::get_key(val), std::move(val));
+    }
+
+    template<typename Val, typename = std::enable_if_t<std::is_constructible<value_type, Val&&>::value>>
+    std::pair<iterator, bool> insert(Val&& val) {
+        return emplace(std::forward<Val>(val));
+    }
+
+    iterator insert(const_iterator, const value_type& val) { return insert(val).first; }
+    iterator insert(const_iterator, value_type&& val) { return insert(std::move(val)).first; }
+
+    template<typename Val, typename = std::enable_if_t<std::is_constructible<value_type, Val&&>::value>>
+    iterator insert(const_iterator, Val&& val) {
+        return emplace(std::forward<Val>(val)).first;
+    }
+
+    void insert(std::initializer_list<value_type> init) { insert_impl(init.begin(), init.end()); }
+
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    void insert(InputIt first, InputIt last) {
+        insert_impl(first, last);
+    }
+
+    insert_return_type insert(node_type&& nh) {
+        if (nh.empty()) { return {end(), false, node_type(*this)}; }
+        const auto& key = Traits::get_key(*nh.get());
+        const std::uint64_t hash = hash_of(key);
+        size_type i = find_index(key, hash);
+        if (i != kNpos) { return {to_iterator<iterator>(i), false, std::move(nh)}; }
+        i = insert_slot(hash);
+        Traits::transfer(static_cast<alloc_type&>(*this), slots_ + i, nh.get());
+        nh.engaged_ = false;
+        return {to_iterator<iterator>(i), true, node_type(*this)};
+    }
+
+    iterator insert(const_iterator, node_type&& nh) { return insert(std::move(nh)).position; }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        node_type nh(*this);
+        nh.construct(std::forward<Args>(args)...);
+        auto result = insert(std::move(nh));
+        return std::make_pair(result.position, result.inserted);
+    }
+
+    template<typename... Args>
+    iterator emplace_hint(const_iterator, Args&&... args) {
+        return emplace(std::forward<Args>(args)...).first;
+    }
+
+    // - clear, swap, erase, extract
+
+    void clear() NOEXCEPT {
+        if (!capacity_) { return; }
+        destroy_slots();
+        reset_ctrl();
+    }
+
+    iterator erase(const_iterator pos) {
+        const size_type i = to_index(pos);
+        erase_at(i);
+        iterator next(ctrl_ + i + 1, slots_ + i + 1);
+        next.skip_empty_or_deleted();
+        return next;
+    }
+
+    template<typename Key_ = key_type>
+    iterator erase(std::enable_if_t<!std::is_same<Key_, value_type>::value, iterator> pos) {
+        return erase(static_cast<const_iterator>(pos));
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        while (first != last) { first = erase(first); }
+        const size_type i = static_cast<size_type>(last.ctrl() - static_cast<const std::int8_t*>(ctrl_));
+        return iterator(ctrl_ + i, slots_ + i);
+    }
+
+    size_type erase(const key_type& key) {
+        const size_type i = find_index(key, hash_of(key));
+        if (i == kNpos) { return 0; }
+        erase_at(i);
+        return 1;
+    }
+
+    template<typename Key, typename Hash_ = hasher, typename Eq_ = key_equal,
+             typename = std::void_t<typename Hash_::is_transparent, typename Eq_::is_transparent>>
+    size_type erase(const Key& key) {
+        const size_type i = find_index(key, hash_of(key));
+        if (i == kNpos) { return 0; }
+        erase_at(i);
+        return 1;
+    }
+
+    node_type extract(const_iterator pos) {
+        node_type nh(*this);
+        const size_type i = to_index(pos);
+        nh.take(slots_ + i);
+        release_at(i);
+        return nh;
+    }
+
+    node_type extract(const key_type& key) {
+        node_type nh(*this);
+        const size_type i = find_index(key, hash_of(key));
+        if (i == kNpos) { return nh; }
+        nh.take(slots_ + i);
+        release_at(i);
+        return nh;
+    }
+
+    void reserve(size_type count) {
+        if (count <= size_ + growth_left_) { return; }
+        resize(capacity_for(count));
+    }
+
+    void rehash(size_type count) {
+        if (!count && !size_) {
+            tidy();
+            return;
+        }
+        size_type new_capacity = capacity_for(std::max(count, size_));
+        if (new_capacity != capacity_) { resize(new_capacity); }
+    }
+
+ protected:
+    static const size_type kNpos = ~size_type(0);
+    static const size_type kWidth = group_t::kWidth;
+
+    pointer slots_ = nullptr;
+    std::int8_t* ctrl_ = ctrl_t::empty_group();
+    size_type capacity_ = 0;
+    size_type size_ = 0;
+    size_type growth_left_ = 0;
+
+    template<typename Key>
+    std::uint64_t hash_of(const Key& key) const {
+        return ctrl_t::mix(this->get_hasher()(key));
+    }
+
+    bool is_same_alloc(const alloc_type& alloc) { return static_cast<alloc_type&>(*this) == alloc; }
+
+    static size_type capacity_to_growth(size_type capacity) { return capacity - (capacity + 1) / 8; }
+
+    static size_type capacity_for(size_type count) {
+        size_type capacity = kWidth - 1;
+        while (capacity_to_growth(capacity) < count) { capacity = 2 * capacity + 1; }
+        return capacity;
+    }
+
+    static size_type alloc_count(size_type capacity) {
+        return capacity + (capacity + kWidth + sizeof(value_type) - 1) / sizeof(value_type);
+    }
+
+    template<typename Iter>
+    Iter first_iterator() const {
+        Iter it(ctrl_, slots_);
+        it.skip_empty_or_deleted();
+        return it;
+    }
+
+    template<typename Iter>
+    Iter to_iterator(size_type i) const {
+        if (i == kNpos) { return Iter(ctrl_ + capacity_, slots_ + capacity_); }
+        return Iter(ctrl_ + i, slots_ + i);
+    }
+
+    size_type to_index(const_iterator pos) const {
+        const size_type i = static_cast<size_type>(pos.ctrl() - static_cast<const std::int8_t*>(ctrl_));
+        assert(i < capacity_ && ctrl_[i] >= 0);
+        return i;
+    }
+
+    template<typename Iter>
+    static std::pair<Iter, Iter> make_equal_range(Iter it) {
+        if (*it.ctrl() < 0) { return std::make_pair(it, it); }
+        Iter next = it;
+        next.increment();
+        return std::make_pair(it, next);
+    }
+
+    template<typename Key>
+    size_type find_index(const Key& key, std::uint64_t hash) const {
+        const std::int8_t h2 = ctrl_t::h2(hash);
+        size_type pos = ctrl_t::h1(hash) & capacity_, step = 0;
+        while (true) {
+            group_t g(ctrl_ + pos);
+            for (auto m = g.match(h2); m; m.clear_lowest()) {
+                const size_type i = (pos + m.lowest()) & capacity_;
+                if (this->get_key_eq()(key, Traits::get_key(slots_[i]))) { return i; }
+            }
+            if (g.match_empty()) { return kNpos; }
+            step += kWidth;
+            pos = (pos + step) & capacity_;
+        }
+    }
+
+    size_type find_first_non_full(std::uint64_t hash) const {
+        size_type pos = ctrl_t::h1(hash) & capacity_, step = 0;
+        while (true) {
+            auto m = group_t(ctrl_ + pos).match_empty_or_deleted();
+            if (m) { return (pos + m.lowest()) & capacity_; }
+            step += kWidth;
+            pos = (pos + step) & capacity_;
+        }
+    }
+
+    void set_ctrl(size_type i, std::int8_t h) {
+        ctrl_[i] = h;
+        if (i < kWidth - 1) { ctrl_[capacity_ + 1 + i] = h; }
+    }
+
+    // finds a free slot for the hash and marks it as used, growing the table if needed
+    size_type insert_slot(std::uint64_t hash) {
+        size_type i = find_first_non_full(hash);
+        if (!growth_left_ && ctrl_[i] != ctrl_t::kDeleted) {
+            rehash_and_grow();
+            i = find_first_non_full(hash);
+        }
+        growth_left_ -= ctrl_[i] == ctrl_t::kEmpty ? 1 : 0;
+        set_ctrl(i, ctrl_t::h2(hash));
+        ++size_;
+        return i;
+    }
+
+    // marks a used slot as free, the value must be already destroyed or moved out
+    void release_at(size_type i) {
+        set_ctrl(i, ctrl_t::kDeleted);
+        --size_;
+    }
+
+    void erase_at(size_type i) {
+        alloc_traits::destroy(*this, slots_ + i);
+        release_at(i);
+    }
+
+    template<typename... Args>
+    void construct_at(size_type i, Args&&... args) {
+        try {
+            alloc_traits::construct(*this, slots_ + i, std::forward<Args>(args)...);
+        } catch (...) {
+            release_at(i);
+            throw;
+        }
+    }
+
+    template<typename Key, typename... Args>
+    std::pair<iterator, bool> emplace_with_key(const Key& key, Args&&... args) {
+        const std::uint64_t hash = hash_of(key);
+        size_type i = find_index(key, hash);
+        if (i != kNpos) { return std::make_pair(to_iterator<iterator>(i), false); }
+        i = insert_slot(hash);
+        construct_at(i, std::forward<Args>(args)...);
+        return std::make_pair(to_iterator<iterator>(i), true);
+    }
+
+    template<typename InputIt>
+    void insert_impl(InputIt first, InputIt last) {
+        for (; first != last; ++first) { emplace(*first); }
+    }
+
+    void rehash_and_grow() {
+        if (capacity_ && (size_ <= capacity_to_growth(capacity_) / 2)) {
+            resize(capacity_);  // drop tombstones only
+        } else {
+            resize(capacity_ ? 2 * capacity_ + 1 : kWidth - 1);
+        }
+    }
+
+    void allocate(size_type capacity) {
+        slots_ = std::addressof(*alloc_traits::allocate(*this, alloc_count(capacity)));
+        ctrl_ = reinterpret_cast<std::int8_t*>(slots_ + capacity);
+        capacity_ = capacity;
+        reset_ctrl();
+    }
+
+    void reset_ctrl() {
+        std::memset(ctrl_, ctrl_t::kEmpty, capacity_ + kWidth);
+        ctrl_[capacity_] = ctrl_t::kSentinel;
+        size_ = 0;
+        growth_left_ = capacity_to_growth(capacity_);
+    }
+
+    void resize(size_type new_capacity) {
+        auto old_slots = slots_;
+        auto old_ctrl = ctrl_;
+        const size_type old_capacity = capacity_, old_size = size_;
+        allocate(new_capacity);
+        for (size_type i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] < 0) { continue; }
+            const std::uint64_t hash = hash_of(Traits::get_key(old_slots[i]));
+            const size_type j = find_first_non_full(hash);
+            set_ctrl(j, ctrl_t::h2(hash));
+            Traits::transfer(static_cast<alloc_type&>(*this), slots_ + j, old_slots + i);
+        }
+        size_ = old_size;
+        growth_left_ -= old_size;
+        if (old_capacity) { alloc_traits::deallocate(*this, old_slots, alloc_count(old_capacity)); }
+    }
+
+    void destroy_slots() {
+        if (std::is_trivially_destructible<value_type>::value) { return; }
+        for (size_type i = 0; i < capacity_; ++i) {
+            if (ctrl_[i] >= 0) { alloc_traits::destroy(*this, slots_ + i); }
+        }
+    }
+
+    void tidy() {
+        if (!capacity_) { return; }
+        destroy_slots();
+        alloc_traits::deallocate(*this, slots_, alloc_count(capacity_));
+        slots_ = nullptr;
+        ctrl_ = ctrl_t::empty_group();
+        capacity_ = size_ = growth_left_ = 0;
+    }
+
+    void steal_data(hashtbl& other) {
+        slots_ = get_and_set(other.slots_, nullptr);
+        ctrl_ = get_and_set(other.ctrl_, ctrl_t::empty_group());
+        capacity_ = get_and_set(other.capacity_, 0);
+        size_ = get_and_set(other.size_, 0);
+        growth_left_ = get_and_set(other.growth_left_, 0);
+    }
+
+    void init_from(const hashtbl& other) {
+        if (!other.size_) { return; }
+        reserve(other.size_);
+        for (size_type i = 0; i < other.capacity_; ++i) {
+            if (other.ctrl_[i] < 0) { continue; }
+            const std::uint64_t hash = hash_of(Traits::get_key(other.slots_[i]));
+            construct_at(insert_slot(hash), other.slots_[i]);
+        }
+    }
+
+    void move_from(hashtbl& other) {
+        if (!other.size_) { return; }
+        reserve(other.size_);
+        for (size_type i = 0; i < other.capacity_; ++i) {
+            if (other.ctrl_[i] < 0) { continue; }
+            const std::uint64_t hash = hash_of(Traits::get_key(other.slots_[i]));
+            const size_type j = insert_slot(hash);
+            Traits::transfer(static_cast<alloc_type&>(*this), slots_ + j, other.slots_ + i);
+            other.release_at(i);
+        }
+    }
+
+    void swap_impl(hashtbl& other, std::true_type) {
+        std::swap(static_cast<alloc_type&>(*this), static_cast<alloc_type&>(other));
+        swap_impl(other, std::false_type());
+    }
+
+    void swap_impl(hashtbl& other, std::false_type) {
+        this->swap_funcs(other);
+        std::swap(slots_, other.slots_);
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+    }
+
+    template<typename Hash2, typename KeyEqual2>
+    void merge_impl(hashtbl<Traits, Hash2, KeyEqual2, Alloc>&& other) {
+        if (!other.size_ || (static_cast<void*>(std::addressof(other)) == static_cast<void*>(this))) { return; }
+        for (size_type i = 0; i < other.capacity_; ++i) {
+            if (other.ctrl_[i] < 0) { continue; }
+            const auto& key = Traits::get_key(other.slots_[i]);
+            const std::uint64_t hash = hash_of(key);
+            if (find_index(key, hash) != kNpos) { continue; }
+            const size_type j = insert_slot(hash);
+            Traits::transfer(static_cast<alloc_type&>(*this), slots_ + j, other.slots_ + i);
+            other.release_at(i);
+        }
+    }
+
+    template<typename, typename, typename, typename>
+    friend class hashtbl;
+};
+
+}  // namespace impl
+
+}  // namespace util
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "util_iterator.h"
+#include "util_string.h"
+
+#include <cstdint>
+
+namespace util {
+
+//-----------------------------------------------------------------------------
+// Rope: text stored as a balanced tree (implicit treap) of fixed-capacity chunks
+
+class CORE_EXPORT rope {
+ private:
+    struct node_t {
+        node_t* left;
+        node_t* right;
+        node_t* parent;
+        std::uint32_t priority;
+        size_t size;  // total characters in subtree
+        size_t len;   // characters in this chunk
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+        const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    };
+
+ public:
+    enum : size_t { kChunkSize = 1024 };
+    static const size_t npos = size_t(-1);
+
+    class piece_iterator {
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::string_view;
+        using pointer = void;
+
+        piece_iterator() NOEXCEPT = default;
+        std::string_view operator*() const NOEXCEPT {
+            return std::string_view(node_->data() + offset_, std::min(node_->len - offset_, remaining_));
+        }
+        piece_iterator& operator++() NOEXCEPT {
+            remaining_ -= std::min(node_->len - offset_, remaining_);
+            node_ = rope::next_node(node_), offset_ = 0;
+            return *this;
+        }
+        piece_iterator operator++(int) NOEXCEPT {
+            auto it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const piece_iterator& it) const NOEXCEPT { return remaining_ == it.remaining_; }
+        bool operator!=(const piece_iterator& it) const NOEXCEPT { return remaining_ != it.remaining_; }
+
+     private:
+        friend class rope;
+        const node_t* node_ = nullptr;
+        size_t offset_ = 0;
+        size_t remaining_ = 0;
+        piece_iterator(const node_t* node, size_t offset, size_t remaining) NOEXCEPT : node_(node),
+                                                                                       offset_(offset),
+                                                                                       remaining_(remaining) {}
+    };
+
+    rope() NOEXCEPT = default;
+    explicit rope(std::string_view s) { append(s); }
+    rope(const rope& other) {
+        rope tmp;  // frees appended chunks if `append` throws
+        for (std::string_view piece : other.pieces()) { tmp.append(piece); }
+        swap(tmp);
+    }
+    rope& operator=(const rope& other) {
+        if (&other == this) { return *this; }
+        rope tmp(other);
+        swap(tmp);
+        return *this;
+    }
+    rope(rope&& other) NOEXCEPT : root_(other.root_), seed_(other.seed_) { other.root_ = nullptr; }
+    rope& operator=(rope&& other) NOEXCEPT {
+        if (&other == this) { return *this; }
+        clear();
+        swap(other);
+        return *this;
+    }
+    ~rope() { clear(); }
+
+    void swap(rope& other) NOEXCEPT {
+        std::swap(root_, other.root_);
+        std::swap(seed_, other.seed_);
+    }
+
+    bool empty() const NOEXCEPT { return !root_; }
+    size_t size() const NOEXCEPT { return root_ ? root_->size : 0; }
+
+    char operator[](size_t pos) const {
+        assert(pos < size());
+        size_t offset = pos;
+        return find_node(offset)->data()[offset];
+    }
+
+    iterator_range<piece_iterator> pieces(size_t pos = 0, size_t n = npos) const {
+        pos = std::min(pos, size()), n = std::min(n, size() - pos);
+        if (!n) { return {piece_iterator(), piece_iterator()}; }
+        size_t offset = pos;
+        const node_t* node = find_node(offset);
+        return {piece_iterator(node, offset, n), piece_iterator()};
+    }
+
+    std::string str(size_t pos = 0, size_t n = npos) const {
+        std::string result;
+        result.reserve(std::min(n, size() - std::min(pos, size())));
+        for (std::string_view piece : pieces(pos, n)) { result += piece; }
+        return result;
+    }
+
+    rope substr(size_t pos = 0, size_t n = npos) const {
+        rope result;
+        for (std::string_view piece : pieces(pos, n)) { result.append(piece); }
+        return result;
+    }
+
+    void clear() NOEXCEPT {
+        free_tree(root_);
+        root_ = nullptr;
+    }
+
+    rope& append(std::string_view s) { return insert(size(), s); }
+    rope& append(rope&& other);
+    rope& operator+=(std::string_view s) { return append(s); }
+    rope& insert(size_t pos, std::string_view s);
+    rope& erase(size_t pos = 0, size_t n = npos);
+    rope& replace(size_t pos, size_t n, std::string_view s) { return erase(pos, n).insert(pos, s); }
+    rope split_off(size_t pos);
+
+    size_t find(std::string_view s, size_t pos = 0) const;
+    size_t find(char ch, size_t pos = 0) const;
+
+    int compare(std::string_view s) const NOEXCEPT;
+
+    friend bool operator==(const rope& lhs, std::string_view rhs) NOEXCEPT {
+        return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
+    }
+    friend bool operator!=(const rope& lhs, std::string_view rhs) NOEXCEPT { return !(lhs == rhs); }
+
+ private:
+    node_t* root_ = nullptr;
+    std::uint32_t seed_ = 0x9e3779b9;
+
+    static size_t subtree_size(const node_t* node) NOEXCEPT { return node ? node->size : 0; }
+
+    static const node_t* next_node(const node_t* node) NOEXCEPT {
+        if (node->right) {
+            node = node->right;
+            while (node->left) { node = node->left; }
+            return node;
+        }
+        while (node->parent && node == node->parent->right) { node = node->parent; }
+        return node->parent;
+    }
+
+    // returns the node containing character `offset`; `offset` becomes the position within the node
+    const node_t* find_node(size_t& offset) const NOEXCEPT {
+        const node_t* node = root_;
+        while (true) {
+            const size_t left_size = subtree_size(node->left);
+            if (offset < left_size) {
+                node = node->left;
+                continue;
+            }
+            offset -= left_size;
+            if (offset < node->len) { return node; }
+            offset -= node->len, node = node->right;
+        }
+    }
+
+    node_t* new_node(const char* s, size_t len);
+    static void free_tree(node_t* node) NOEXCEPT;
+    static void update(node_t* node) NOEXCEPT;
+    static node_t* merge(node_t* l, node_t* r) NOEXCEPT;
+    std::pair<node_t*, node_t*> split(node_t* node, size_t pos);  // the tree is intact if it throws
+    node_t* join(node_t* l, node_t* r) NOEXCEPT;
+    node_t* build(std::string_view s);
+};
+
+}  // namespace util
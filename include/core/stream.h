@@ -1,8 +1,10 @@
 #pragma once
 
+#include "arena.h"
 #include "util_string.h"
 
 #include <iostream>
+#include <memory>
 
 #if __cplusplus < 201703L
 template<typename Ty>
@@ -24,4 +26,188 @@ inline QDataStream& operator<<(QDataStream& os, const std::string& s) { return o
 CORE_EXPORT QDataStream& operator>>(QDataStream& is, std::string& s);
 #endif  // USE_QT
 
-namespace util {}
+namespace util {
+
+//-----------------------------------------------------------------------------
+// Output sinks: satisfy `is_string_buffer`, so formatters and converters write into them directly
+
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_ostream_sink {
+ public:
+    using traits_type = Traits;
+
+    explicit basic_ostream_sink(std::basic_ostream<CharT, Traits>& os) : os_(os) {}
+    basic_ostream_sink& append(const CharT* s, size_t count) {
+        // write to stream buffer directly: `write()` constructs a sentry for each piece
+        if (os_.rdbuf()->sputn(s, count) != static_cast<std::streamsize>(count)) { os_.setstate(std::ios::badbit); }
+        return *this;
+    }
+    std::basic_ostream<CharT, Traits>& stream() const { return os_; }
+
+ private:
+    std::basic_ostream<CharT, Traits>& os_;
+};
+
+using ostream_sink = basic_ostream_sink<char>;
+
+// Fixed-size buffer: excess characters are dropped
+class buffer_sink {
+ public:
+    using traits_type = std::char_traits<char>;
+
+    buffer_sink(char* first, char* last) NOEXCEPT : first_(first), cur_(first), last_(last) {}
+    template<size_t N>
+    explicit buffer_sink(char (&buf)[N]) NOEXCEPT : buffer_sink(buf, buf + N) {}
+
+    buffer_sink& append(const char* s, size_t count) NOEXCEPT {
+        const size_t avail = static_cast<size_t>(last_ - cur_);
+        if (count > avail) { count = avail, truncated_ = true; }
+        std::memcpy(cur_, s, count);
+        cur_ += count;
+        return *this;
+    }
+
+    size_t size() const NOEXCEPT { return static_cast<size_t>(cur_ - first_); }
+    bool truncated() const NOEXCEPT { return truncated_; }
+    std::string_view view() const NOEXCEPT { return std::string_view(first_, size()); }
+    void clear() NOEXCEPT { cur_ = first_, truncated_ = false; }
+
+ private:
+    char* first_;
+    char* cur_;
+    char* last_;
+    bool truncated_ = false;
+};
+
+// Growing buffer allocated from arena: the result lives as long as the arena
+class arena_sink {
+ public:
+    using traits_type = std::char_traits<char>;
+
+    explicit arena_sink(arena& a, size_t capacity = 64) : arena_(a), capacity_(capacity) {
+        data_ = static_cast<char*>(arena_.allocate(capacity_, 1));
+    }
+
+    arena_sink& append(const char* s, size_t count) {
+        if (count > capacity_ - size_) { grow(size_ + count); }
+        std::memcpy(data_ + size_, s, count);
+        size_ += count;
+        return *this;
+    }
+
+    size_t size() const NOEXCEPT { return size_; }
+    size_t capacity() const NOEXCEPT { return capacity_; }
+    std::string_view view() const NOEXCEPT { return std::string_view(data_, size_); }
+    void clear() NOEXCEPT { size_ = 0; }
+
+ private:
+    arena& arena_;
+    char* data_;
+    size_t size_ = 0;
+    size_t capacity_;
+
+    void grow(size_t min_capacity) {
+        const size_t new_capacity = std::max(min_capacity, 2 * capacity_);
+        if (arena_.try_extend(data_, capacity_, new_capacity)) {
+            capacity_ = new_capacity;
+            return;
+        }
+        auto new_data = static_cast<char*>(arena_.allocate(new_capacity, 1));
+        std::memcpy(new_data, data_, size_);
+        data_ = new_data, capacity_ = new_capacity;
+    }
+};
+
+// File descriptor: output is batched and written when the buffer fills up, on `flush()` or destruction
+class CORE_EXPORT fd_sink {
+ public:
+    using traits_type = std::char_traits<char>;
+    enum : size_t { kDefBufSize = 16384 };
+
+    explicit fd_sink(int fd, size_t buf_size = kDefBufSize)
+        : fd_(fd), buf_(new char[buf_size]), cur_(buf_.get()), end_(buf_.get() + buf_size) {}
+    fd_sink(const fd_sink&) = delete;
+    fd_sink& operator=(const fd_sink&) = delete;
+    ~fd_sink() { flush(); }
+
+    fd_sink& append(const char* s, size_t count) {
+        if (count <= static_cast<size_t>(end_ - cur_)) {
+            std::memcpy(cur_, s, count);
+            cur_ += count;
+            return *this;
+        }
+        append_slow(s, count);
+        return *this;
+    }
+
+    int fd() const NOEXCEPT { return fd_; }
+    bool good() const NOEXCEPT { return good_; }
+    bool flush();
+
+ private:
+    int fd_;
+    std::unique_ptr<char[]> buf_;
+    char* cur_;
+    char* end_;
+    bool good_ = true;
+
+    void append_slow(const char* s, size_t count);
+    bool write_all(const char* s, size_t count);
+};
+
+//-----------------------------------------------------------------------------
+// Read-only memory-mapped file
+
+class CORE_EXPORT mapped_file {
+ public:
+    mapped_file() NOEXCEPT = default;
+    explicit mapped_file(const char* path) { open(path); }
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) NOEXCEPT : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr, other.size_ = 0;
+    }
+    mapped_file& operator=(mapped_file&& other) NOEXCEPT {
+        if (&other == this) { return *this; }
+        close();
+        data_ = other.data_, size_ = other.size_;
+        other.data_ = nullptr, other.size_ = 0;
+        return *this;
+    }
+    ~mapped_file() { close(); }
+
+    bool open(const char* path);
+    void close() NOEXCEPT;
+
+    bool is_open() const NOEXCEPT { return data_ != nullptr; }
+    const char* data() const NOEXCEPT { return data_; }
+    size_t size() const NOEXCEPT { return size_; }
+    std::string_view view() const NOEXCEPT { return std::string_view(data_, size_); }
+
+ private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Formats arguments directly into output stream
+template<typename CharT, typename Traits, size_t PieceCount, unsigned ArgCount, typename... Ts>
+std::basic_ostream<CharT, Traits>& sformat_to(std::basic_ostream<CharT, Traits>& os,
+                                              const sformat_layout<PieceCount, ArgCount>& layout, const Ts&... args) {
+    typename std::basic_ostream<CharT, Traits>::sentry ok(os);
+    if (ok) {
+        basic_ostream_sink<CharT, Traits> sink(os);
+        sformat_to(sink, layout, args...);
+    }
+    return os;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const sformat& fmt) {
+    std::ostream::sentry ok(os);
+    if (ok) {
+        ostream_sink sink(os);
+        fmt.str(sink);
+    }
+    return os;
+}
+
+}  // namespace util
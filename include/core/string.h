@@ -0,0 +1,553 @@
+#pragma once
+
+#include "util_string.h"
+
+#include <iosfwd>
+
+namespace util {
+
+//-----------------------------------------------------------------------------
+// String with inline buffer
+
+template<typename Ty, size_t InlineSize = 23, typename Alloc = std::allocator<Ty>>
+class basic_string : public std::allocator_traits<Alloc>::template rebind_alloc<Ty> {
+ private:
+    static_assert(std::is_trivial<Ty>::value, "util::basic_string must have a trivial value type");
+    static_assert(InlineSize * sizeof(Ty) >= sizeof(size_t), "too small inline buffer");
+
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<Ty>;
+    using alloc_traits = std::allocator_traits<alloc_type>;
+
+ public:
+    using traits_type = std::char_traits<Ty>;
+    using value_type = Ty;
+    using allocator_type = Alloc;
+    using size_type = typename alloc_traits::size_type;
+    using difference_type = typename alloc_traits::difference_type;
+    using pointer = Ty*;
+    using const_pointer = const Ty*;
+    using reference = Ty&;
+    using const_reference = const Ty&;
+    using iterator = array_iterator<basic_string, false>;
+    using const_iterator = array_iterator<basic_string, true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using view_type = std::basic_string_view<Ty>;
+
+    static const size_type npos = size_type(-1);
+    enum : size_type { kInlineCapacity = InlineSize };
+
+    basic_string() NOEXCEPT_IF(std::is_nothrow_default_constructible<alloc_type>::value) { buf_[0] = Ty(); }
+    explicit basic_string(const allocator_type& alloc) NOEXCEPT : alloc_type(alloc) { buf_[0] = Ty(); }
+    basic_string(const Ty* s, size_type count, const allocator_type& alloc = allocator_type()) : basic_string(alloc) {
+        append(s, count);
+    }
+    basic_string(const Ty* s, const allocator_type& alloc = allocator_type()) : basic_string(alloc) {
+        append(s, traits_type::length(s));
+    }
+    explicit basic_string(view_type s, const allocator_type& alloc = allocator_type()) : basic_string(alloc) {
+        append(s.data(), s.size());
+    }
+    basic_string(size_type count, Ty ch, const allocator_type& alloc = allocator_type()) : basic_string(alloc) {
+        append(count, ch);
+    }
+    basic_string(std::initializer_list<Ty> l, const allocator_type& alloc = allocator_type()) : basic_string(alloc) {
+        append(l.begin(), l.size());
+    }
+
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    basic_string(InputIt first, InputIt last, const allocator_type& alloc = allocator_type()) : basic_string(alloc) {
+        append(first, last);
+    }
+
+    basic_string(const basic_string& other)
+        : alloc_type(alloc_traits::select_on_container_copy_construction(other)) {
+        buf_[0] = Ty();
+        append(other.data_, other.size_);
+    }
+
+    basic_string(const basic_string& other, const allocator_type& alloc) : basic_string(alloc) {
+        append(other.data_, other.size_);
+    }
+
+    basic_string(basic_string&& other) NOEXCEPT : alloc_type(std::move(other)) { steal_data(other); }
+
+    basic_string(basic_string&& other, const allocator_type& alloc) : basic_string(alloc) {
+        if (is_alloc_always_equal<alloc_type>::value || is_same_alloc(other)) {
+            steal_data(other);
+        } else {
+            append(other.data_, other.size_);
+        }
+    }
+
+    ~basic_string() { tidy(); }
+
+    basic_string& operator=(const basic_string& other) {
+        if (std::addressof(other) == this) { return *this; }
+        if (alloc_traits::propagate_on_container_copy_assignment::value && !is_alloc_always_equal<alloc_type>::value &&
+            !is_same_alloc(other)) {
+            tidy();
+            alloc_type::operator=(other);
+        }
+        return assign(other.data_, other.size_);
+    }
+
+    basic_string& operator=(basic_string&& other) NOEXCEPT_IF(alloc_traits::propagate_on_container_move_assignment::value ||
+                                                              is_alloc_always_equal<alloc_type>::value) {
+        if (std::addressof(other) == this) { return *this; }
+        if (alloc_traits::propagate_on_container_move_assignment::value) {
+            tidy();
+            alloc_type::operator=(std::move(other));
+            steal_data(other);
+        } else if (is_alloc_always_equal<alloc_type>::value || is_same_alloc(other)) {
+            tidy();
+            steal_data(other);
+        } else {
+            assign(other.data_, other.size_);
+        }
+        return *this;
+    }
+
+    basic_string& operator=(view_type s) { return assign(s.data(), s.size()); }
+    basic_string& operator=(const Ty* s) { return assign(s, traits_type::length(s)); }
+    basic_string& operator=(Ty ch) { return assign(&ch, 1); }
+    basic_string& operator=(std::initializer_list<Ty> l) { return assign(l.begin(), l.size()); }
+
+    void swap(basic_string& other) NOEXCEPT {
+        if (std::addressof(other) == this) { return; }
+        if (alloc_traits::propagate_on_container_swap::value) {
+            std::swap(static_cast<alloc_type&>(*this), static_cast<alloc_type&>(other));
+        }
+        swap_data(other);
+    }
+
+    allocator_type get_allocator() const { return static_cast<const alloc_type&>(*this); }
+
+    bool empty() const NOEXCEPT { return size_ == 0; }
+    size_type size() const NOEXCEPT { return size_; }
+    size_type length() const NOEXCEPT { return size_; }
+    size_type capacity() const NOEXCEPT { return is_inline() ? kInlineCapacity : capacity_; }
+    size_type max_size() const NOEXCEPT { return alloc_traits::max_size(*this) - 1; }
+    bool is_inline() const NOEXCEPT { return data_ == buf_; }
+
+    iterator begin() NOEXCEPT { return iterator(data_, data_, data_ + size_); }
+    const_iterator begin() const NOEXCEPT { return const_iterator(data_, data_, data_ + size_); }
+    const_iterator cbegin() const NOEXCEPT { return const_iterator(data_, data_, data_ + size_); }
+
+    iterator end() NOEXCEPT { return iterator(data_ + size_, data_, data_ + size_); }
+    const_iterator end() const NOEXCEPT { return const_iterator(data_ + size_, data_, data_ + size_); }
+    const_iterator cend() const NOEXCEPT { return const_iterator(data_ + size_, data_, data_ + size_); }
+
+    reverse_iterator rbegin() NOEXCEPT { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const NOEXCEPT { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const NOEXCEPT { return const_reverse_iterator(end()); }
+
+    reverse_iterator rend() NOEXCEPT { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const NOEXCEPT { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const NOEXCEPT { return const_reverse_iterator(begin()); }
+
+    pointer data() NOEXCEPT { return data_; }
+    const_pointer data() const NOEXCEPT { return data_; }
+    const_pointer c_str() const NOEXCEPT { return data_; }
+
+    operator view_type() const NOEXCEPT { return view_type(data_, size_); }
+    explicit operator std::basic_string<Ty>() const { return std::basic_string<Ty>(data_, size_); }
+    view_type view() const NOEXCEPT { return view_type(data_, size_); }
+
+    reference operator[](size_type i) {
+        assert(i < size_);
+        return data_[i];
+    }
+    const_reference operator[](size_type i) const {
+        assert(i <= size_);
+        return data_[i];
+    }
+
+    reference at(size_type i) {
+        if (i >= size_) { throw std::out_of_range("invalid string position"); }
+        return data_[i];
+    }
+    const_reference at(size_type i) const {
+        if (i >= size_) { throw std::out_of_range("invalid string position"); }
+        return data_[i];
+    }
+
+    reference front() {
+        assert(size_ > 0);
+        return data_[0];
+    }
+    const_reference front() const {
+        assert(size_ > 0);
+        return data_[0];
+    }
+
+    reference back() {
+        assert(size_ > 0);
+        return data_[size_ - 1];
+    }
+    const_reference back() const {
+        assert(size_ > 0);
+        return data_[size_ - 1];
+    }
+
+    void clear() NOEXCEPT { set_size(0); }
+
+    void reserve(size_type cap) {
+        if (cap > capacity()) { realloc(cap); }
+    }
+
+    void shrink_to_fit() {
+        if (is_inline() || size_ == capacity_) { return; }
+        if (size_ > kInlineCapacity) { return realloc(size_); }
+        auto p = data_;
+        auto cap = capacity_;
+        data_ = buf_;
+        traits_type::copy(buf_, p, size_ + 1);
+        alloc_traits::deallocate(*this, p, cap + 1);
+    }
+
+    void resize(size_type sz, Ty ch = Ty()) {
+        if (sz > size_) { return append(sz - size_, ch), void(); }
+        set_size(sz);
+    }
+
+    void push_back(Ty ch) {
+        if (size_ == capacity()) { realloc(grow_capacity(size_ + 1)); }
+        data_[size_] = ch;
+        set_size(size_ + 1);
+    }
+
+    void pop_back() {
+        assert(size_ > 0);
+        set_size(size_ - 1);
+    }
+
+    basic_string& assign(const Ty* s, size_type count) {
+        if (count <= capacity()) {
+            traits_type::move(data_, s, count);
+            set_size(count);
+            return *this;
+        }
+        auto cap = grow_capacity(count);
+        auto p = alloc_traits::allocate(*this, cap + 1);
+        traits_type::copy(p, s, count);
+        tidy();
+        data_ = p, capacity_ = cap;
+        set_size(count);
+        return *this;
+    }
+    basic_string& assign(view_type s) { return assign(s.data(), s.size()); }
+    basic_string& assign(size_type count, Ty ch) {
+        clear();
+        return append(count, ch);
+    }
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    basic_string& assign(InputIt first, InputIt last) {
+        clear();
+        return append(first, last);
+    }
+
+    basic_string& append(const Ty* s, size_type count) {
+        if (count > capacity() - size_) { return realloc_append(s, count); }
+        traits_type::copy(data_ + size_, s, count);
+        set_size(size_ + count);
+        return *this;
+    }
+    basic_string& append(view_type s) { return append(s.data(), s.size()); }
+    basic_string& append(const Ty* s) { return append(s, traits_type::length(s)); }
+    basic_string& append(size_type count, Ty ch) {
+        if (count > capacity() - size_) { realloc(grow_capacity(size_ + count)); }
+        traits_type::assign(data_ + size_, count, ch);
+        set_size(size_ + count);
+        return *this;
+    }
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    basic_string& append(InputIt first, InputIt last) {
+        append_range(first, last, is_random_access_iterator<InputIt>());
+        return *this;
+    }
+
+    basic_string& operator+=(view_type s) { return append(s.data(), s.size()); }
+    basic_string& operator+=(const Ty* s) { return append(s, traits_type::length(s)); }
+    basic_string& operator+=(Ty ch) {
+        push_back(ch);
+        return *this;
+    }
+    basic_string& operator+=(std::initializer_list<Ty> l) { return append(l.begin(), l.size()); }
+
+    basic_string& insert(size_type pos, view_type s) { return replace(pos, 0, s); }
+    basic_string& insert(size_type pos, size_type count, Ty ch) {
+        return replace(pos, 0, basic_string(count, ch, get_allocator()));
+    }
+
+    basic_string& erase(size_type pos = 0, size_type count = npos) {
+        if (pos > size_) { throw std::out_of_range("invalid string position"); }
+        count = std::min(count, size_ - pos);
+        traits_type::move(data_ + pos, data_ + pos + count, size_ - pos - count);
+        set_size(size_ - count);
+        return *this;
+    }
+
+    basic_string& replace(size_type pos, size_type count, view_type s) {
+        if (pos > size_) { throw std::out_of_range("invalid string position"); }
+        count = std::min(count, size_ - pos);
+        const size_type new_size = size_ - count + s.size();
+        const size_type tail = size_ - pos - count;
+        if (new_size > capacity()) {
+            auto cap = grow_capacity(new_size);
+            auto p = alloc_traits::allocate(*this, cap + 1);
+            traits_type::copy(p, data_, pos);
+            traits_type::copy(p + pos, s.data(), s.size());
+            traits_type::copy(p + pos + s.size(), data_ + pos + count, tail);
+            tidy();
+            data_ = p, capacity_ = cap;
+        } else if (s.data() + s.size() > data_ && s.data() < data_ + size_) {
+            return replace(pos, count, basic_string(s, get_allocator()));  // overlapped
+        } else {
+            traits_type::move(data_ + pos + s.size(), data_ + pos + count, tail);
+            traits_type::copy(data_ + pos, s.data(), s.size());
+        }
+        set_size(new_size);
+        return *this;
+    }
+
+    basic_string substr(size_type pos = 0, size_type count = npos) const {
+        if (pos > size_) { throw std::out_of_range("invalid string position"); }
+        return basic_string(data_ + pos, std::min(count, size_ - pos), get_allocator());
+    }
+
+    int compare(view_type s) const NOEXCEPT { return view().compare(s); }
+    size_type find(Ty ch, size_type pos = 0) const NOEXCEPT { return view().find(ch, pos); }
+    size_type find(view_type s, size_type pos = 0) const NOEXCEPT { return view().find(s, pos); }
+    size_type rfind(Ty ch, size_type pos = npos) const NOEXCEPT { return view().rfind(ch, pos); }
+    size_type rfind(view_type s, size_type pos = npos) const NOEXCEPT { return view().rfind(s, pos); }
+
+ private:
+    Ty* data_ = buf_;
+    size_type size_ = 0;
+    union {
+        size_type capacity_;
+        Ty buf_[InlineSize + 1];
+    };
+
+    bool is_same_alloc(const alloc_type& alloc) { return static_cast<alloc_type&>(*this) == alloc; }
+
+    void set_size(size_type sz) NOEXCEPT {
+        size_ = sz;
+        data_[sz] = Ty();
+    }
+
+    size_type grow_capacity(size_type sz) const {
+        if (sz > max_size()) { throw std::length_error("too much to reserve"); }
+        return std::max(sz, std::min(size_ + (size_ >> 1), max_size()));
+    }
+
+    void tidy() NOEXCEPT {
+        if (!is_inline()) { alloc_traits::deallocate(*this, data_, capacity_ + 1); }
+        data_ = buf_;
+        size_ = 0;
+        buf_[0] = Ty();
+    }
+
+    void steal_data(basic_string& other) NOEXCEPT {
+        if (other.is_inline()) {
+            traits_type::copy(buf_, other.buf_, other.size_ + 1);
+            size_ = other.size_;
+        } else {
+            data_ = other.data_, size_ = other.size_, capacity_ = other.capacity_;
+            other.data_ = other.buf_;
+        }
+        other.set_size(0);
+    }
+
+    void swap_data(basic_string& other) NOEXCEPT {
+        if (!is_inline() && !other.is_inline()) {
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(capacity_, other.capacity_);
+            return;
+        }
+        basic_string* a = this;
+        basic_string* b = std::addressof(other);
+        if (!a->is_inline()) { std::swap(a, b); }
+        Ty tmp[InlineSize + 1];
+        const size_type sz = a->size_;
+        traits_type::copy(tmp, a->buf_, sz + 1);
+        if (b->is_inline()) {
+            traits_type::copy(a->buf_, b->buf_, b->size_ + 1);
+        } else {
+            a->data_ = b->data_, a->capacity_ = b->capacity_;
+            b->data_ = b->buf_;
+        }
+        a->size_ = b->size_;
+        traits_type::copy(b->buf_, tmp, sz + 1);
+        b->size_ = sz;
+    }
+
+    void realloc(size_type cap) {
+        auto p = alloc_traits::allocate(*this, cap + 1);
+        traits_type::copy(p, data_, size_ + 1);
+        const size_type sz = size_;
+        tidy();
+        data_ = p, size_ = sz, capacity_ = cap;
+    }
+
+    basic_string& realloc_append(const Ty* s, size_type count) {
+        auto cap = grow_capacity(size_ + count);
+        auto p = alloc_traits::allocate(*this, cap + 1);
+        traits_type::copy(p, data_, size_);
+        traits_type::copy(p + size_, s, count);  // `s` may point to the old buffer
+        const size_type sz = size_ + count;
+        tidy();
+        data_ = p, capacity_ = cap;
+        set_size(sz);
+        return *this;
+    }
+
+    template<typename RandIt>
+    void append_range(RandIt first, RandIt last, std::true_type) {
+        assert(first <= last);
+        auto count = static_cast<size_type>(last - first);
+        if (count > capacity() - size_) { realloc(grow_capacity(size_ + count)); }
+        std::copy(first, last, data_ + size_);
+        set_size(size_ + count);
+    }
+
+    template<typename InputIt>
+    void append_range(InputIt first, InputIt last, std::false_type) {
+        for (; first != last; ++first) { push_back(*first); }
+    }
+};
+
+using string = basic_string<char>;
+using wstring = basic_string<wchar_t>;
+
+template<typename Alloc>
+using string_with_alloc = basic_string<char, 23, Alloc>;
+
+#define UTIL_STRING_TEMPLATE_PARAMS  typename Ty, size_t InlineSize, typename Alloc
+#define UTIL_STRING_TYPE             basic_string<Ty, InlineSize, Alloc>
+
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator==(const UTIL_STRING_TYPE& lhs, type_identity_t<std::basic_string_view<Ty>, void> rhs) {
+    return lhs.size() == rhs.size() && lhs.view() == rhs;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator==(type_identity_t<std::basic_string_view<Ty>, void> lhs, const UTIL_STRING_TYPE& rhs) {
+    return rhs == lhs;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS, size_t InlineSize2, typename Alloc2>
+bool operator==(const UTIL_STRING_TYPE& lhs, const basic_string<Ty, InlineSize2, Alloc2>& rhs) {
+    return lhs == rhs.view();
+}
+
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator!=(const UTIL_STRING_TYPE& lhs, type_identity_t<std::basic_string_view<Ty>, void> rhs) {
+    return !(lhs == rhs);
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator!=(type_identity_t<std::basic_string_view<Ty>, void> lhs, const UTIL_STRING_TYPE& rhs) {
+    return !(rhs == lhs);
+}
+template<UTIL_STRING_TEMPLATE_PARAMS, size_t InlineSize2, typename Alloc2>
+bool operator!=(const UTIL_STRING_TYPE& lhs, const basic_string<Ty, InlineSize2, Alloc2>& rhs) {
+    return !(lhs == rhs.view());
+}
+
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator<(const UTIL_STRING_TYPE& lhs, type_identity_t<std::basic_string_view<Ty>, void> rhs) {
+    return lhs.compare(rhs) < 0;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator<(type_identity_t<std::basic_string_view<Ty>, void> lhs, const UTIL_STRING_TYPE& rhs) {
+    return rhs.compare(lhs) > 0;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS, size_t InlineSize2, typename Alloc2>
+bool operator<(const UTIL_STRING_TYPE& lhs, const basic_string<Ty, InlineSize2, Alloc2>& rhs) {
+    return lhs.compare(rhs.view()) < 0;
+}
+
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator<=(const UTIL_STRING_TYPE& lhs, type_identity_t<std::basic_string_view<Ty>, void> rhs) {
+    return lhs.compare(rhs) <= 0;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator<=(type_identity_t<std::basic_string_view<Ty>, void> lhs, const UTIL_STRING_TYPE& rhs) {
+    return rhs.compare(lhs) >= 0;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS, size_t InlineSize2, typename Alloc2>
+bool operator<=(const UTIL_STRING_TYPE& lhs, const basic_string<Ty, InlineSize2, Alloc2>& rhs) {
+    return lhs.compare(rhs.view()) <= 0;
+}
+
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator>(const UTIL_STRING_TYPE& lhs, type_identity_t<std::basic_string_view<Ty>, void> rhs) {
+    return lhs.compare(rhs) > 0;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator>(type_identity_t<std::basic_string_view<Ty>, void> lhs, const UTIL_STRING_TYPE& rhs) {
+    return rhs.compare(lhs) < 0;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS, size_t InlineSize2, typename Alloc2>
+bool operator>(const UTIL_STRING_TYPE& lhs, const basic_string<Ty, InlineSize2, Alloc2>& rhs) {
+    return lhs.compare(rhs.view()) > 0;
+}
+
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator>=(const UTIL_STRING_TYPE& lhs, type_identity_t<std::basic_string_view<Ty>, void> rhs) {
+    return lhs.compare(rhs) >= 0;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+bool operator>=(type_identity_t<std::basic_string_view<Ty>, void> lhs, const UTIL_STRING_TYPE& rhs) {
+    return rhs.compare(lhs) <= 0;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS, size_t InlineSize2, typename Alloc2>
+bool operator>=(const UTIL_STRING_TYPE& lhs, const basic_string<Ty, InlineSize2, Alloc2>& rhs) {
+    return lhs.compare(rhs.view()) >= 0;
+}
+
+template<UTIL_STRING_TEMPLATE_PARAMS>
+UTIL_STRING_TYPE operator+(const UTIL_STRING_TYPE& lhs, type_identity_t<std::basic_string_view<Ty>, void> rhs) {
+    UTIL_STRING_TYPE result(lhs.get_allocator());
+    result.reserve(lhs.size() + rhs.size());
+    result += lhs;
+    result += rhs;
+    return result;
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+UTIL_STRING_TYPE operator+(UTIL_STRING_TYPE&& lhs, type_identity_t<std::basic_string_view<Ty>, void> rhs) {
+    return std::move(lhs += rhs);
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+UTIL_STRING_TYPE operator+(const UTIL_STRING_TYPE& lhs, Ty ch) {
+    UTIL_STRING_TYPE result(lhs);
+    return std::move(result += ch);
+}
+template<UTIL_STRING_TEMPLATE_PARAMS>
+UTIL_STRING_TYPE operator+(UTIL_STRING_TYPE&& lhs, Ty ch) {
+    return std::move(lhs += ch);
+}
+
+template<UTIL_STRING_TEMPLATE_PARAMS>
+std::basic_ostream<Ty>& operator<<(std::basic_ostream<Ty>& os, const UTIL_STRING_TYPE& s) {
+    return os << s.view();
+}
+
+#undef UTIL_STRING_TEMPLATE_PARAMS
+#undef UTIL_STRING_TYPE
+
+}  // namespace util
+
+namespace std {
+template<typename Ty, size_t InlineSize, typename Alloc>
+struct hash<util::basic_string<Ty, InlineSize, Alloc>> {
+    size_t operator()(const util::basic_string<Ty, InlineSize, Alloc>& s) const {
+        return std::hash<std::basic_string_view<Ty>>{}(s.view());
+    }
+};
+template<typename Ty, size_t InlineSize, typename Alloc>
+void swap(util::basic_string<Ty, InlineSize, Alloc>& s1, util::basic_string<Ty, InlineSize, Alloc>& s2)
+    NOEXCEPT_IF(NOEXCEPT_IF(s1.swap(s2))) {
+    s1.swap(s2);
+}
+}  // namespace std
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "arena.h"
+#include "unordered_set.h"
+
+#include <shared_mutex>
+
+namespace util {
+
+//-----------------------------------------------------------------------------
+// String interning pool
+
+// Keeps one copy of each distinct string. Returned views stay valid until the pool is cleared or destroyed, so
+// views obtained from the same pool are equal if and only if their data pointers are equal
+class string_pool {
+ public:
+    explicit string_pool(size_t block_size = arena::kDefBlockSize) : arena_(block_size) {}
+    string_pool(const string_pool&) = delete;
+    string_pool& operator=(const string_pool&) = delete;
+    string_pool(string_pool&&) = default;
+    string_pool& operator=(string_pool&&) = default;
+
+    size_t size() const { return index_.size(); }
+    bool empty() const { return index_.empty(); }
+
+    hashed_string_view intern(hashed_string_view s) {
+        auto it = index_.find(s);
+        if (it != index_.end()) { return *it; }
+        return *index_.emplace(arena_.copy_string(s.view()), s.hash()).first;
+    }
+
+    // Returns a view with null data if the string is not in the pool
+    hashed_string_view find(hashed_string_view s) const {
+        auto it = index_.find(s);
+        return it != index_.end() ? *it : hashed_string_view(std::string_view(), 0);
+    }
+
+    bool contains(hashed_string_view s) const { return index_.find(s) != index_.end(); }
+
+    void clear() {
+        index_.clear();
+        arena_.clear();
+    }
+
+ private:
+    arena arena_;
+    unordered_set<hashed_string_view, string_hash, string_equal_to> index_;
+};
+
+// Lookups of already interned strings take a shared lock only
+class CORE_EXPORT concurrent_string_pool {
+ public:
+    explicit concurrent_string_pool(size_t block_size = arena::kDefBlockSize) : pool_(block_size) {}
+
+    size_t size() const;
+    hashed_string_view intern(hashed_string_view s);
+    hashed_string_view find(hashed_string_view s) const;
+    void clear();
+
+ private:
+    mutable std::shared_mutex mutex_;
+    string_pool pool_;
+};
+
+}  // namespace util
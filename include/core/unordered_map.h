@@ -0,0 +1,210 @@
+#pragma once
+
+#include "hashtbl.h"
+
+namespace util {
+
+//-----------------------------------------------------------------------------
+// Unordered map front-end
+
+template<typename Key, typename Ty, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Alloc = std::allocator<std::pair<const Key, Ty>>>
+class unordered_map : public impl::hashtbl<impl::hashtbl_map_traits<Key, Ty>, Hash, KeyEqual, Alloc> {
+ private:
+    using super = impl::hashtbl<impl::hashtbl_map_traits<Key, Ty>, Hash, KeyEqual, Alloc>;
+    using alloc_traits = typename super::alloc_traits;
+
+ public:
+    using allocator_type = typename super::allocator_type;
+    using key_type = typename super::key_type;
+    using mapped_type = Ty;
+    using value_type = typename super::value_type;
+    using size_type = typename super::size_type;
+    using hasher = typename super::hasher;
+    using key_equal = typename super::key_equal;
+    using iterator = typename super::iterator;
+    using const_iterator = typename super::const_iterator;
+
+    unordered_map() = default;
+    explicit unordered_map(size_type bucket_count, const hasher& hash = hasher(), const key_equal& eq = key_equal(),
+                           const allocator_type& alloc = allocator_type())
+        : super(bucket_count, hash, eq, alloc) {}
+    unordered_map(size_type bucket_count, const allocator_type& alloc)
+        : super(bucket_count, hasher(), key_equal(), alloc) {}
+    unordered_map(size_type bucket_count, const hasher& hash, const allocator_type& alloc)
+        : super(bucket_count, hash, key_equal(), alloc) {}
+    explicit unordered_map(const allocator_type& alloc) : super(0, hasher(), key_equal(), alloc) {}
+
+#if __cplusplus < 201703L
+    unordered_map(const unordered_map&) = default;
+    unordered_map& operator=(const unordered_map&) = default;
+    unordered_map(unordered_map&& other) : super(std::move(other)) {}
+    unordered_map& operator=(unordered_map&& other) {
+        super::operator=(std::move(other));
+        return *this;
+    }
+    ~unordered_map() = default;
+#endif  // __cplusplus
+
+    unordered_map(std::initializer_list<value_type> init, size_type bucket_count = 0, const hasher& hash = hasher(),
+                  const key_equal& eq = key_equal(), const allocator_type& alloc = allocator_type())
+        : super(bucket_count, hash, eq, alloc) {
+        this->insert_impl(init.begin(), init.end());
+    }
+
+    unordered_map(std::initializer_list<value_type> init, const allocator_type& alloc)
+        : super(0, hasher(), key_equal(), alloc) {
+        this->insert_impl(init.begin(), init.end());
+    }
+
+    unordered_map& operator=(std::initializer_list<value_type> init) {
+        this->clear();
+        this->insert_impl(init.begin(), init.end());
+        return *this;
+    }
+
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    unordered_map(InputIt first, InputIt last, size_type bucket_count = 0, const hasher& hash = hasher(),
+                  const key_equal& eq = key_equal(), const allocator_type& alloc = allocator_type())
+        : super(bucket_count, hash, eq, alloc) {
+        this->insert_impl(first, last);
+    }
+
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    unordered_map(InputIt first, InputIt last, const allocator_type& alloc) : super(0, hasher(), key_equal(), alloc) {
+        this->insert_impl(first, last);
+    }
+
+    unordered_map(const unordered_map& other, const allocator_type& alloc) : super(other, alloc) {}
+    unordered_map(unordered_map&& other, const allocator_type& alloc) : super(std::move(other), alloc) {}
+
+    void swap(unordered_map& other) {
+        if (std::addressof(other) == this) { return; }
+        this->swap_impl(other, typename alloc_traits::propagate_on_container_swap());
+    }
+
+    const mapped_type& at(const key_type& key) const {
+        auto it = this->find(key);
+        if (it == this->end()) { throw std::out_of_range("invalid unordered_map key"); }
+        return it->second;
+    }
+
+    mapped_type& at(const key_type& key) {
+        auto it = this->find(key);
+        if (it == this->end()) { throw std::out_of_range("invalid unordered_map key"); }
+        return it->second;
+    }
+
+    mapped_type& operator[](const key_type& key) { return try_emplace_impl(key).first->second; }
+    mapped_type& operator[](key_type&& key) { return try_emplace_impl(std::move(key)).first->second; }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    iterator try_emplace(const_iterator, const key_type& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...).first;
+    }
+
+    template<typename... Args>
+    iterator try_emplace(const_iterator, key_type&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...).first;
+    }
+
+    template<typename Ty2>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, Ty2&& obj) {
+        auto result = try_emplace_impl(key, std::forward<Ty2>(obj));
+        if (!result.second) { result.first->second = std::forward<Ty2>(obj); }
+        return result;
+    }
+
+    template<typename Ty2>
+    std::pair<iterator, bool> insert_or_assign(key_type&& key, Ty2&& obj) {
+        auto result = try_emplace_impl(std::move(key), std::forward<Ty2>(obj));
+        if (!result.second) { result.first->second = std::forward<Ty2>(obj); }
+        return result;
+    }
+
+    template<typename Ty2>
+    iterator insert_or_assign(const_iterator, const key_type& key, Ty2&& obj) {
+        return insert_or_assign(key, std::forward<Ty2>(obj)).first;
+    }
+
+    template<typename Ty2>
+    iterator insert_or_assign(const_iterator, key_type&& key, Ty2&& obj) {
+        return insert_or_assign(std::move(key), std::forward<Ty2>(obj)).first;
+    }
+
+    template<typename Hash2, typename KeyEqual2>
+    void merge(unordered_map<Key, Ty, Hash2, KeyEqual2, Alloc>& other) {
+        this->merge_impl(std::move(other));
+    }
+    template<typename Hash2, typename KeyEqual2>
+    void merge(unordered_map<Key, Ty, Hash2, KeyEqual2, Alloc>&& other) {
+        this->merge_impl(std::move(other));
+    }
+
+ protected:
+    template<typename Key2, typename... Args>
+    std::pair<iterator, bool> try_emplace_impl(Key2&& key, Args&&... args) {
+        const std::uint64_t hash = this->hash_of(key);
+        auto i = this->find_index(key, hash);
+        if (i != super::kNpos) { return std::make_pair(this->template to_iterator<iterator>(i), false); }
+        i = this->insert_slot(hash);
+        this->construct_at(i, std::piecewise_construct, std::forward_as_tuple(std::forward<Key2>(key)),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::make_pair(this->template to_iterator<iterator>(i), true);
+    }
+};
+
+#if __cplusplus >= 201703L
+template<typename InputIt,
+         typename Hash = std::hash<std::remove_const_t<typename std::iterator_traits<InputIt>::value_type::first_type>>,
+         typename KeyEqual =
+             std::equal_to<std::remove_const_t<typename std::iterator_traits<InputIt>::value_type::first_type>>,
+         typename Alloc =
+             std::allocator<std::pair<std::add_const_t<typename std::iterator_traits<InputIt>::value_type::first_type>,
+                                      typename std::iterator_traits<InputIt>::value_type::second_type>>>
+unordered_map(InputIt, InputIt, typename std::allocator_traits<Alloc>::size_type = 0, Hash = Hash(),
+              KeyEqual = KeyEqual(), Alloc = Alloc())
+    -> unordered_map<std::remove_const_t<typename std::iterator_traits<InputIt>::value_type::first_type>,
+                     typename std::iterator_traits<InputIt>::value_type::second_type, Hash, KeyEqual, Alloc>;
+template<typename Key, typename Ty, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Alloc = std::allocator<std::pair<const Key, Ty>>>
+unordered_map(std::initializer_list<std::pair<Key, Ty>>, typename std::allocator_traits<Alloc>::size_type = 0,
+              Hash = Hash(), KeyEqual = KeyEqual(), Alloc = Alloc()) -> unordered_map<Key, Ty, Hash, KeyEqual, Alloc>;
+#endif  // __cplusplus
+
+template<typename Key, typename Ty, typename Hash, typename KeyEqual, typename Alloc>
+bool operator==(const unordered_map<Key, Ty, Hash, KeyEqual, Alloc>& lh,
+                const unordered_map<Key, Ty, Hash, KeyEqual, Alloc>& rh) {
+    if (lh.size() != rh.size()) { return false; }
+    for (const auto& v : lh) {
+        auto it = rh.find(v.first);
+        if (it == rh.end() || !(it->second == v.second)) { return false; }
+    }
+    return true;
+}
+
+template<typename Key, typename Ty, typename Hash, typename KeyEqual, typename Alloc>
+bool operator!=(const unordered_map<Key, Ty, Hash, KeyEqual, Alloc>& lh,
+                const unordered_map<Key, Ty, Hash, KeyEqual, Alloc>& rh) {
+    return !(lh == rh);
+}
+
+}  // namespace util
+
+namespace std {
+template<typename Key, typename Ty, typename Hash, typename KeyEqual, typename Alloc>
+void swap(util::unordered_map<Key, Ty, Hash, KeyEqual, Alloc>& m1, util::unordered_map<Key, Ty, Hash, KeyEqual, Alloc>& m2)
+    NOEXCEPT_IF(NOEXCEPT_IF(m1.swap(m2))) {
+    m1.swap(m2);
+}
+}  // namespace std
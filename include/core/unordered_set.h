@@ -0,0 +1,128 @@
+#pragma once
+
+#include "hashtbl.h"
+
+namespace util {
+
+//-----------------------------------------------------------------------------
+// Unordered set front-end
+
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Alloc = std::allocator<Key>>
+class unordered_set : public impl::hashtbl<impl::hashtbl_set_traits<Key>, Hash, KeyEqual, Alloc> {
+ private:
+    using super = impl::hashtbl<impl::hashtbl_set_traits<Key>, Hash, KeyEqual, Alloc>;
+    using alloc_traits = typename super::alloc_traits;
+
+ public:
+    using allocator_type = typename super::allocator_type;
+    using key_type = typename super::key_type;
+    using value_type = typename super::value_type;
+    using size_type = typename super::size_type;
+    using hasher = typename super::hasher;
+    using key_equal = typename super::key_equal;
+
+    unordered_set() = default;
+    explicit unordered_set(size_type bucket_count, const hasher& hash = hasher(), const key_equal& eq = key_equal(),
+                           const allocator_type& alloc = allocator_type())
+        : super(bucket_count, hash, eq, alloc) {}
+    unordered_set(size_type bucket_count, const allocator_type& alloc)
+        : super(bucket_count, hasher(), key_equal(), alloc) {}
+    unordered_set(size_type bucket_count, const hasher& hash, const allocator_type& alloc)
+        : super(bucket_count, hash, key_equal(), alloc) {}
+    explicit unordered_set(const allocator_type& alloc) : super(0, hasher(), key_equal(), alloc) {}
+
+#if __cplusplus < 201703L
+    unordered_set(const unordered_set&) = default;
+    unordered_set& operator=(const unordered_set&) = default;
+    unordered_set(unordered_set&& other) : super(std::move(other)) {}
+    unordered_set& operator=(unordered_set&& other) {
+        super::operator=(std::move(other));
+        return *this;
+    }
+    ~unordered_set() = default;
+#endif  // __cplusplus
+
+    unordered_set(std::initializer_list<value_type> init, size_type bucket_count = 0, const hasher& hash = hasher(),
+                  const key_equal& eq = key_equal(), const allocator_type& alloc = allocator_type())
+        : super(bucket_count, hash, eq, alloc) {
+        this->insert_impl(init.begin(), init.end());
+    }
+
+    unordered_set(std::initializer_list<value_type> init, const allocator_type& alloc)
+        : super(0, hasher(), key_equal(), alloc) {
+        this->insert_impl(init.begin(), init.end());
+    }
+
+    unordered_set& operator=(std::initializer_list<value_type> init) {
+        this->clear();
+        this->insert_impl(init.begin(), init.end());
+        return *this;
+    }
+
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    unordered_set(InputIt first, InputIt last, size_type bucket_count = 0, const hasher& hash = hasher(),
+                  const key_equal& eq = key_equal(), const allocator_type& alloc = allocator_type())
+        : super(bucket_count, hash, eq, alloc) {
+        this->insert_impl(first, last);
+    }
+
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    unordered_set(InputIt first, InputIt last, const allocator_type& alloc) : super(0, hasher(), key_equal(), alloc) {
+        this->insert_impl(first, last);
+    }
+
+    unordered_set(const unordered_set& other, const allocator_type& alloc) : super(other, alloc) {}
+    unordered_set(unordered_set&& other, const allocator_type& alloc) : super(std::move(other), alloc) {}
+
+    void swap(unordered_set& other) {
+        if (std::addressof(other) == this) { return; }
+        this->swap_impl(other, typename alloc_traits::propagate_on_container_swap());
+    }
+
+    template<typename Hash2, typename KeyEqual2>
+    void merge(unordered_set<Key, Hash2, KeyEqual2, Alloc>& other) {
+        this->merge_impl(std::move(other));
+    }
+    template<typename Hash2, typename KeyEqual2>
+    void merge(unordered_set<Key, Hash2, KeyEqual2, Alloc>&& other) {
+        this->merge_impl(std::move(other));
+    }
+};
+
+#if __cplusplus >= 201703L
+template<typename InputIt, typename Hash = std::hash<typename std::iterator_traits<InputIt>::value_type>,
+         typename KeyEqual = std::equal_to<typename std::iterator_traits<InputIt>::value_type>,
+         typename Alloc = std::allocator<typename std::iterator_traits<InputIt>::value_type>>
+unordered_set(InputIt, InputIt, typename std::allocator_traits<Alloc>::size_type = 0, Hash = Hash(),
+              KeyEqual = KeyEqual(), Alloc = Alloc())
+    -> unordered_set<typename std::iterator_traits<InputIt>::value_type, Hash, KeyEqual, Alloc>;
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Alloc = std::allocator<Key>>
+unordered_set(std::initializer_list<Key>, typename std::allocator_traits<Alloc>::size_type = 0, Hash = Hash(),
+              KeyEqual = KeyEqual(), Alloc = Alloc()) -> unordered_set<Key, Hash, KeyEqual, Alloc>;
+#endif  // __cplusplus
+
+template<typename Key, typename Hash, typename KeyEqual, typename Alloc>
+bool operator==(const unordered_set<Key, Hash, KeyEqual, Alloc>& lh, const unordered_set<Key, Hash, KeyEqual, Alloc>& rh) {
+    if (lh.size() != rh.size()) { return false; }
+    for (const auto& v : lh) {
+        if (!rh.contains(v)) { return false; }
+    }
+    return true;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Alloc>
+bool operator!=(const unordered_set<Key, Hash, KeyEqual, Alloc>& lh, const unordered_set<Key, Hash, KeyEqual, Alloc>& rh) {
+    return !(lh == rh);
+}
+
+}  // namespace util
+
+namespace std {
+template<typename Key, typename Hash, typename KeyEqual, typename Alloc>
+void swap(util::unordered_set<Key, Hash, KeyEqual, Alloc>& s1, util::unordered_set<Key, Hash, KeyEqual, Alloc>& s2)
+    NOEXCEPT_IF(NOEXCEPT_IF(s1.swap(s2))) {
+    s1.swap(s2);
+}
+}  // namespace std
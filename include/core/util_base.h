@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <tuple>
 #include <type_traits>
 
@@ -55,6 +57,14 @@
 #    define USE_CHECKED_ITERATORS
 #endif  // defined(_MSC_VER) && (_MSC_VER >= 1800)
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#    define USE_SSE2
+#endif  // SSE2
+
+#ifdef _MSC_VER
+#    include <intrin.h>
+#endif  // _MSC_VER
+
 #if __cplusplus < 201703L
 #    define NOEXCEPT
 #    define NOEXCEPT_IF(x)
@@ -168,6 +178,45 @@ Ty get_and_set(Ty& v, std::remove_reference_t<Ty> v_new) {
     return v_new;
 }
 
+//-----------------------------------------------------------------------------
+// Bit scanning
+
+inline unsigned count_trailing_zeros(std::uint32_t x) NOEXCEPT {
+    assert(x != 0);
+#ifdef _MSC_VER
+    unsigned long n;
+    _BitScanForward(&n, x);
+    return static_cast<unsigned>(n);
+#else   // _MSC_VER
+    return static_cast<unsigned>(__builtin_ctz(x));
+#endif  // _MSC_VER
+}
+
+inline unsigned count_trailing_zeros(std::uint64_t x) NOEXCEPT {
+    assert(x != 0);
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long n;
+    _BitScanForward64(&n, x);
+    return static_cast<unsigned>(n);
+#elif defined(_MSC_VER)
+    return static_cast<std::uint32_t>(x) ? count_trailing_zeros(static_cast<std::uint32_t>(x)) :
+                                           32 + count_trailing_zeros(static_cast<std::uint32_t>(x >> 32));
+#else   // _MSC_VER
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif  // _MSC_VER
+}
+
+inline unsigned count_ones(std::uint64_t x) NOEXCEPT {
+#ifdef _MSC_VER
+    x -= (x >> 1) & 0x5555555555555555ull;
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return static_cast<unsigned>((x * 0x0101010101010101ull) >> 56);
+#else   // _MSC_VER
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#endif  // _MSC_VER
+}
+
 template<typename QtTy>
 struct qt_type_converter;
 
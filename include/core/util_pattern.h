@@ -0,0 +1,108 @@
+#pragma once
+
+#include "util_string.h"
+
+#include <array>
+#include <vector>
+
+namespace util {
+
+// Regular expression compiled into Thompson NFA and matched by Pike VM: matching time is linear in the length
+// of the input for any pattern. Supported syntax is the subset of ECMAScript without backreferences and
+// lookarounds: literals, `.`, classes `[...]`, escapes `\d\D\w\W\s\S\n\r\t\f\v\0\xHH`, assertions `^$\b\B`,
+// groups `(...)` and `(?:...)`, alternation `|`, greedy and lazy quantifiers `*+?{n}{n,}{n,m}`. Alternatives
+// and quantifiers have the same priority as in `std::regex`, so the found match is the same
+class CORE_EXPORT pattern {
+ public:
+    // Throws `std::invalid_argument` if the pattern is malformed or is not supported
+    explicit pattern(std::string_view re);
+
+    // Finds the leftmost match in [first, last); `^` and `$` match at `first` and `last`
+    bool search(const char* first, const char* last, std::pair<const char*, const char*>& m) const;
+
+    // Finds the match which ends rightmost in [first, last); greedy quantifiers extend it to the left as far
+    // as possible, lazy ones as little as possible
+    bool reversed_search(const char* first, const char* last, std::pair<const char*, const char*>& m) const;
+
+    // Returns `true` if the whole string matches
+    bool match(std::string_view s) const;
+
+    // The literal string every match starts with
+    std::string_view literal_prefix() const { return forward_.prefix; }
+
+ private:
+    class compiler;
+
+    enum class opcode : uint8_t {
+        kChar = 0,
+        kAny,
+        kClass,
+        kSplit,  // continue at `x`, then at `y` with lower priority
+        kJump,
+        kAssertBegin,
+        kAssertEnd,
+        kAssertWordBoundary,
+        kAssertNotWordBoundary,
+        kMatch,
+    };
+
+    struct instruction {
+        opcode op;
+        unsigned char ch;
+        uint32_t x;  // jump target or class index
+        uint32_t y;
+    };
+
+    struct program {
+        std::vector<instruction> code;
+        std::string prefix;                   // required literal prefix
+        std::array<bool, 256> first_bytes{};  // bytes a match can start with
+        unsigned first_byte_count = 0;        // 0 if a match can be empty
+        std::array<char, 2> first_byte_pair{};  // the bytes if there are at most 2 of them
+        bool is_anchored = false;             // starts with `^` in all alternatives
+    };
+
+    std::vector<std::array<uint64_t, 4>> classes_;
+    program forward_;
+    program reversed_;  // matches reversed strings
+
+    bool in_class(uint32_t cls, unsigned char ch) const { return (classes_[cls][ch >> 6] >> (ch & 63)) & 1; }
+
+    template<bool Reversed>
+    bool run(const program& prog, const char* first, const char* last, bool whole,
+             std::pair<const char*, const char*>& m) const;
+};
+
+namespace impl {
+
+template<>
+struct string_finder<pattern> {
+    const pattern& pat;
+    using is_finder = int;
+    using iterator = std::string_view::const_iterator;
+    explicit string_finder(const pattern& in_pat) : pat(in_pat) {}
+    std::pair<iterator, iterator> operator()(iterator begin, iterator end) const {
+        const char* first = begin != end ? &*begin : nullptr;
+        std::pair<const char*, const char*> m;
+        if (!pat.search(first, first + (end - begin), m)) { return std::make_pair(end, end); }
+        return std::make_pair(begin + (m.first - first), begin + (m.second - first));
+    }
+};
+
+template<>
+struct reversed_string_finder<pattern> {
+    const pattern& pat;
+    using is_reversed_finder = int;
+    using iterator = std::string_view::const_iterator;
+    explicit reversed_string_finder(const pattern& in_pat) : pat(in_pat) {}
+    std::pair<iterator, iterator> operator()(iterator begin, iterator end) const {
+        const char* first = begin != end ? &*begin : nullptr;
+        std::pair<const char*, const char*> m;
+        if (!pat.reversed_search(first, first + (end - begin), m)) { return std::make_pair(begin, begin); }
+        return std::make_pair(begin + (m.first - first), begin + (m.second - first));
+    }
+};
+
+}  // namespace impl
+
+}  // namespace util
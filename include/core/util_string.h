@@ -1,13 +1,21 @@
 #pragma once
 
 #include "util_iterator.h"
+#include "util_span.h"
 
+#include <array>
 #include <cctype>
 #include <cstring>
 #include <limits>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#ifdef USE_SSE2
+#    include <emmintrin.h>
+#endif  // USE_SSE2
+
 #ifdef USE_QT
 #    include <QHash>
 #    include <QString>
@@ -159,6 +167,8 @@ auto basic_string_view<Ty>::rfind(basic_string_view s, size_type pos) const -> s
 
 using string_view = basic_string_view<char>;
 using wstring_view = basic_string_view<wchar_t>;
+using u16string_view = basic_string_view<char16_t>;
+using u32string_view = basic_string_view<char32_t>;
 
 #    if defined(_MSC_VER)
 template<typename Ty>
@@ -246,7 +256,7 @@ uint32_t to_utf16(uint32_t code, OutputIt out,  //
             return 2;
         }
         code = 0xFFFD;
-    } else if ((code & 0xD800) == 0xD800) {
+    } else if ((code & 0xF800) == 0xD800) {
         code = 0xFFFD;
     }
     *out++ = static_cast<uint16_t>(code);
@@ -303,11 +313,68 @@ enum class scvt_fp {
     kScientific = 1,
     kFixed = 2,
     kGeneral = kScientific | kFixed,
+    kShortest = 4,  // shortest round-trip representation, precision is ignored
+    kShortestScientific = kShortest | kScientific,
+    kShortestFixed = kShortest | kFixed,
+    kShortestGeneral = kShortest | kGeneral,
 };
 
 enum class scvt_base { kBase8 = 0, kBase10 = 1, kBase16 = 2 };
 
 namespace impl {
+
+// Returns pointer to the first character equal to `ch1` or `ch2`, or `last`
+inline const char* find_first_of2(const char* first, const char* last, char ch1, char ch2) NOEXCEPT {
+#ifdef USE_SSE2
+    const __m128i v1 = _mm_set1_epi8(ch1), v2 = _mm_set1_epi8(ch2);
+    for (; last - first >= 16; first += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, v1), _mm_cmpeq_epi8(v, v2)));
+        if (mask) { return first + count_trailing_zeros(static_cast<std::uint32_t>(mask)); }
+    }
+#else   // USE_SSE2
+    const std::uint64_t lo = 0x0101010101010101ull, hi = 0x8080808080808080ull;
+    const std::uint64_t v1 = lo * static_cast<std::uint8_t>(ch1), v2 = lo * static_cast<std::uint8_t>(ch2);
+    for (; last - first >= 8; first += 8) {
+        std::uint64_t v;
+        std::memcpy(&v, first, sizeof(v));
+        const std::uint64_t x1 = v ^ v1, x2 = v ^ v2;
+        if (((x1 - lo) & ~x1 & hi) | ((x2 - lo) & ~x2 & hi)) { break; }  // has zero byte: match in this chunk
+    }
+#endif  // USE_SSE2
+    for (; first < last; ++first) {
+        if (*first == ch1 || *first == ch2) { return first; }
+    }
+    return last;
+}
+
+// Returns pointer to the first occurrence of `s` (`s_len` >= 2) or `last`:
+// candidates matching the first and the last characters are verified only
+inline const char* find_substring(const char* first, const char* last, const char* s, size_t s_len) NOEXCEPT {
+    assert(s_len >= 2);
+    if (static_cast<size_t>(last - first) < s_len) { return last; }
+    const char* const last_pos = last - s_len;  // the last possible match position
+#ifdef USE_SSE2
+    const __m128i v_first = _mm_set1_epi8(s[0]), v_last = _mm_set1_epi8(s[s_len - 1]);
+    for (; last_pos - first >= 15; first += 16) {
+        const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + s_len - 1));
+        auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, v_first), _mm_cmpeq_epi8(block_last, v_last))));
+        for (; mask; mask &= mask - 1) {
+            const char* p = first + count_trailing_zeros(mask);
+            if (std::memcmp(p + 1, s + 1, s_len - 2) == 0) { return p; }
+        }
+    }
+#endif  // USE_SSE2
+    for (; first <= last_pos; ++first) {
+        first = static_cast<const char*>(std::memchr(first, s[0], last_pos - first + 1));
+        if (!first) { break; }
+        if (first[s_len - 1] == s[s_len - 1] && std::memcmp(first + 1, s + 1, s_len - 2) == 0) { return first; }
+    }
+    return last;
+}
+
 template<typename Ty>
 struct string_finder;
 template<typename Ty>
@@ -320,12 +387,16 @@ struct string_finder<char> {
     using iterator = std::string_view::const_iterator;
     explicit string_finder(char in_ch) : ch(in_ch) {}
     std::pair<iterator, iterator> operator()(iterator begin, iterator end) const {
-        for (; begin < end; ++begin) {
-            if (*begin == '\\') {
-                if (++begin == end) { break; }
-            } else if (*begin == ch) {
+        if (begin == end) { return std::make_pair(end, end); }
+        const char *const first = &*begin, *const last = first + (end - begin);
+        for (const char* p = first;; p += 2) {
+            p = find_first_of2(p, last, '\\', ch);
+            if (p == last) { break; }
+            if (*p != '\\') {
+                begin += p - first;
                 return std::make_pair(begin, begin + 1);
             }
+            if (last - p <= 2) { break; }  // skip escaped character
         }
         return std::make_pair(end, end);
     }
@@ -356,10 +427,13 @@ struct string_finder<std::string_view> {
     explicit string_finder(std::string_view in_s) : s(in_s) {}
     std::pair<iterator, iterator> operator()(iterator begin, iterator end) const {
         if (static_cast<size_t>(end - begin) < s.size()) { return std::make_pair(end, end); }
-        for (auto last = end - s.size(); begin <= last; ++begin) {
-            if (std::equal(begin, begin + s.size(), s.begin())) { return std::make_pair(begin, begin + s.size()); }
-        }
-        return std::make_pair(end, end);
+        if (s.empty()) { return std::make_pair(begin, begin); }
+        const char *const first = &*begin, *const last = first + (end - begin);
+        const char* p = s.size() == 1 ? static_cast<const char*>(std::memchr(first, s[0], last - first)) :
+                                        find_substring(first, last, s.data(), s.size());
+        if (!p || p == last) { return std::make_pair(end, end); }
+        begin += p - first;
+        return std::make_pair(begin, begin + s.size());
     }
 };
 
@@ -399,6 +473,9 @@ inline impl::reversed_string_finder<std::string_view> rsfind(std::string_view s)
     return impl::reversed_string_finder<std::string_view>(s);
 }
 
+// Compares strings mapped to upper case by bytes as unsigned; only ASCII letters are mapped
+CORE_EXPORT int compare_strings_nocase(std::string_view lhs, std::string_view rhs);
+
 template<typename Ty = void>
 struct equal_to_nocase {
     bool operator()(const Ty& lhs, const Ty& rhs) const { return compare_strings_nocase(lhs, rhs) == 0; }
@@ -432,31 +509,78 @@ is_equal_to_predicate<Str, Func, equal_to_nocase<>> is_equal_to_nocase(const Str
     return is_equal_to_predicate<Str, Func, equal_to_nocase<>>(s, fn);
 }
 
-template<typename Finder, typename = std::void_t<typename Finder::is_finder>>
-std::string replace_strings(std::string_view s, Finder finder, std::string_view with) {
-    std::string result;
-    result.reserve(s.size());
+// Output string buffer: `std::string`, `util::basic_string`, etc.
+template<typename Ty, typename = void>
+struct is_string_buffer : std::false_type {};
+template<typename Ty>
+struct is_string_buffer<Ty, std::void_t<typename Ty::traits_type, decltype(std::declval<Ty&>().append(
+                                                                      std::declval<const char*>(), size_t(0)))>>
+    : std::true_type {};
+
+template<typename Ty>
+struct string_converter;
+
+template<typename Ty, typename = void>
+struct has_string_converter : std::false_type {};
+template<typename Ty>
+struct has_string_converter<Ty, std::void_t<typename string_converter<Ty>::is_string_converter>> : std::true_type {};
+
+// Appends value string representation without intermediate `std::string`
+template<typename StrTy, typename Ty, typename... Args>
+std::enable_if_t<is_string_buffer<StrTy>::value && has_string_converter<Ty>::value, StrTy&> append_to(
+    StrTy& out, const Ty& val, Args&&... args) {
+    char buf[string_converter<Ty>::kMaxChars];
+    char* last = string_converter<Ty>::to_chars(buf, buf + sizeof(buf), val, std::forward<Args>(args)...);
+    out.append(buf, last - buf);
+    return out;
+}
+
+namespace impl {
+template<typename StrTy, typename Ty>
+void append_joined(StrTy& out, const Ty& val, std::true_type) {
+    append_to(out, val);
+}
+template<typename StrTy, typename Ty>
+void append_joined(StrTy& out, const Ty& val, std::false_type) {
+    out += val;
+}
+}  // namespace impl
+
+template<typename Finder, typename StrTy, typename = std::void_t<typename Finder::is_finder>>
+std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> replace_strings(std::string_view s, Finder finder,
+                                                                        std::string_view with, StrTy& out) {
+    out.reserve(out.size() + s.size());
     for (auto p = s.begin(); p < s.end();) {
         auto sub = finder(p, s.end());
-        result.append(p, sub.first);
-        if (sub.first != sub.second) { result += with; }
+        out.append(p, sub.first);
+        if (sub.first != sub.second) { out += with; }
         p = sub.second;
     }
+    return out;
+}
+
+template<typename Finder, typename = std::void_t<typename Finder::is_finder>>
+std::string replace_strings(std::string_view s, Finder finder, std::string_view with) {
+    std::string result;
+    replace_strings(s, finder, with, result);
     return result;
 }
 
-template<typename Range, typename InputFn = nofunc>
+template<typename Range, typename StrTy, typename InputFn = nofunc>
+std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> join_strings(const Range& r, std::string_view sep,
+                                                                     StrTy& out, InputFn fn = InputFn{}) {
+    for (auto it = std::begin(r); it != std::end(r);) {
+        const auto& val = fn(*it);
+        impl::append_joined(out, val, has_string_converter<std::decay_t<decltype(val)>>{});
+        if (++it != std::end(r)) { out += sep; }
+    }
+    return out;
+}
+
+template<typename Range, typename InputFn = nofunc, typename = std::enable_if_t<!is_string_buffer<InputFn>::value>>
 std::string join_strings(const Range& r, std::string_view sep, InputFn fn = InputFn{}) {
-    if (std::begin(r) == std::end(r)) { return {}; }
     std::string s;
-    for (auto it = std::begin(r);;) {
-        s += fn(*it);
-        if (++it != std::end(r)) {
-            s += sep;
-        } else {
-            break;
-        }
-    }
+    join_strings(r, sep, s, fn);
     return s;
 }
 
@@ -623,17 +747,472 @@ unpack_strings(std::string_view s, char sep, OutputIt out,  //
     return count;
 }
 
+//-----------------------------------------------------------------------------
+// Lazy split ranges: pieces are found on demand while iterating
+
+template<typename Finder, split_flags flags>
+class split_string_iterator : public iterator_facade<split_string_iterator<Finder, flags>, std::string_view,
+                                                     std::forward_iterator_tag, std::string_view, void> {
+ public:
+    using iterator = std::string_view::const_iterator;
+
+    split_string_iterator() NOEXCEPT = default;
+    split_string_iterator(std::string_view s, const Finder& finder) : s_(s), finder_(finder), at_end_(false) {
+        find_next(s_.begin());
+    }
+    split_string_iterator(const split_string_iterator&) = default;
+
+    // finders can refer to their patterns, so they are copy-constructed, not assigned
+    split_string_iterator& operator=(const split_string_iterator& it) {
+        if (&it == this) { return *this; }
+        s_ = it.s_;
+        finder_.reset();
+        if (it.finder_) { finder_.emplace(*it.finder_); }
+        p_ = it.p_, sub_ = it.sub_, at_end_ = it.at_end_;
+        return *this;
+    }
+
+    void increment() {
+        iterator_assert(!at_end_);
+        if (sub_.first == s_.end()) {
+            at_end_ = true;
+        } else {
+            find_next(sub_.second);
+        }
+    }
+    std::string_view dereference() const NOEXCEPT {
+        iterator_assert(!at_end_);
+        return s_.substr(p_ - s_.begin(), sub_.first - p_);
+    }
+    bool equal(const split_string_iterator& it) const NOEXCEPT {
+        return at_end_ == it.at_end_ && (at_end_ || p_ == it.p_);
+    }
+
+ private:
+    std::string_view s_;
+    std::optional<Finder> finder_;  // own copy: the iterator can outlive the range
+    iterator p_{};
+    std::pair<iterator, iterator> sub_{};
+    bool at_end_ = true;
+
+    void find_next(iterator p) {
+        for (;;) {
+            sub_ = (*finder_)(p, s_.end());
+            if (!(flags & split_flags::kSkipEmpty) || (p < sub_.first)) {
+                p_ = p;
+                return;
+            }
+            if (sub_.first == s_.end()) {
+                at_end_ = true;
+                return;
+            }
+            p = sub_.second;
+        }
+    }
+};
+
+template<typename Finder, split_flags flags>
+struct is_iterator_comparable<split_string_iterator<Finder, flags>, split_string_iterator<Finder, flags>>
+    : std::true_type {};
+
+template<typename Finder, split_flags flags>
+class split_string_range {
+ public:
+    using iterator = split_string_iterator<Finder, flags>;
+    split_string_range(std::string_view s, Finder finder) : s_(s), finder_(finder) {}
+    iterator begin() const { return iterator(s_, finder_); }
+    iterator end() const { return iterator(); }
+
+ private:
+    std::string_view s_;
+    Finder finder_;
+};
+
+template<split_flags flags = split_flags::kNoFlags, typename Finder,
+         typename = std::void_t<typename Finder::is_finder>>
+split_string_range<Finder, flags> lazy_split_string(std::string_view s, Finder finder) {
+    return split_string_range<Finder, flags>(s, finder);
+}
+
+class separate_words_iterator : public iterator_facade<separate_words_iterator, std::string_view,
+                                                       std::forward_iterator_tag, std::string_view, void> {
+ public:
+    using iterator = std::string_view::const_iterator;
+
+    separate_words_iterator() NOEXCEPT = default;
+    separate_words_iterator(std::string_view s, char sep) : s_(s), sep_(sep), at_end_(false) { find_next(s_.begin()); }
+
+    void increment() {
+        iterator_assert(!at_end_);
+        if (p_ == s_.end()) {
+            at_end_ = true;
+        } else {
+            find_next(p_ + 1);
+        }
+    }
+    std::string_view dereference() const NOEXCEPT {
+        iterator_assert(!at_end_);
+        return s_.substr(p0_ - s_.begin(), p_ - p0_);
+    }
+    bool equal(const separate_words_iterator& it) const NOEXCEPT {
+        return at_end_ == it.at_end_ && (at_end_ || p_ == it.p_);
+    }
+
+ private:
+    enum class state_t : char { kStart = 0, kSepFound, kSkipSep };
+    std::string_view s_;
+    char sep_ = ' ';
+    state_t state_ = state_t::kStart;
+    iterator p0_{}, p_{};
+    bool at_end_ = true;
+
+    void find_next(iterator p) {  // the same as `separate_words` loop
+        for (;; ++p) {
+            while ((p < s_.end()) && std::isblank(*p)) { ++p; }  // skip blanks
+            auto p0 = p;
+            if (p == s_.end()) {
+                if (state_ != state_t::kSepFound) {
+                    at_end_ = true;
+                    return;
+                }
+            } else {
+                auto prev_state = state_;
+                do {  // find separator or blank
+                    if (*p == '\\') {
+                        if (++p == s_.end()) { break; }
+                    } else if (std::isblank(*p)) {
+                        state_ = state_t::kSkipSep;
+                        break;
+                    } else if (*p == sep_) {
+                        state_ = state_t::kSepFound;
+                        break;
+                    }
+                } while (++p < s_.end());
+                if ((p == p0) && (prev_state == state_t::kSkipSep)) { continue; }
+            }
+            p0_ = p0, p_ = p;
+            return;
+        }
+    }
+};
+
+template<>
+struct is_iterator_comparable<separate_words_iterator, separate_words_iterator> : std::true_type {};
+
+inline iterator_range<separate_words_iterator> lazy_separate_words(std::string_view s, char sep) {
+    return {separate_words_iterator(s, sep), separate_words_iterator()};
+}
+
+// Unescaped piece refers to the source string if it has no escapes or to iterator's own buffer otherwise,
+// so it is valid till the iterator is incremented or destroyed
+class unpack_strings_iterator : public iterator_facade<unpack_strings_iterator, std::string_view,
+                                                       std::input_iterator_tag, std::string_view, void> {
+ public:
+    using iterator = std::string_view::const_iterator;
+
+    unpack_strings_iterator() NOEXCEPT = default;
+    unpack_strings_iterator(std::string_view s, char sep) : s_(s), sep_(sep), at_end_(false) { find_next(s_.begin()); }
+
+    void increment() {
+        iterator_assert(!at_end_);
+        if (p_ == s_.end()) {
+            at_end_ = true;
+        } else {
+            find_next(p_ + 1);
+        }
+    }
+    std::string_view dereference() const NOEXCEPT {
+        iterator_assert(!at_end_);
+        return escaped_ ? std::string_view(buf_) : s_.substr(p0_ - s_.begin(), p_ - p0_);
+    }
+    bool equal(const unpack_strings_iterator& it) const NOEXCEPT {
+        return at_end_ == it.at_end_ && (at_end_ || p_ == it.p_);
+    }
+
+ private:
+    std::string_view s_;
+    char sep_ = ' ';
+    iterator p0_{}, p_{};
+    std::string buf_;
+    bool escaped_ = false;
+    bool at_end_ = true;
+
+    void find_next(iterator p) {  // the same as `unpack_strings` loop
+        auto p0 = p;
+        escaped_ = false;
+        for (; p < s_.end(); ++p) {
+            if (*p == '\\') {
+                if (!escaped_) { buf_.clear(), escaped_ = true; }
+                buf_.append(p0, p);
+                p0 = p + 1;
+                if (++p == s_.end()) { break; }
+            } else if (*p == sep_) {
+                break;
+            }
+        }
+        if (escaped_) { buf_.append(p0, p); }
+        p0_ = p0, p_ = p;
+        if ((p == s_.end()) && (escaped_ ? buf_.empty() : p0 == p)) { at_end_ = true; }
+    }
+};
+
+template<>
+struct is_iterator_comparable<unpack_strings_iterator, unpack_strings_iterator> : std::true_type {};
+
+inline iterator_range<unpack_strings_iterator> lazy_unpack_strings(std::string_view s, char sep) {
+    return {unpack_strings_iterator(s, sep), unpack_strings_iterator()};
+}
+
+// Bulk UTF validation and transcoding of whole buffers: ill-formed sequences, overlong forms, surrogate code
+// points in UTF-8 and UTF-32, unpaired surrogates in UTF-16 and values above 0x10FFFF are rejected;
+// output buffer must have room for `s.size()` UTF-16 or UTF-32 units, or `3 * s.size()` UTF-8 units for
+// UTF-16 input and `4 * s.size()` UTF-8 units for UTF-32 input
+struct utf_result {
+    bool ok;           // false if input is invalid
+    size_t in_count;   // consumed input units: position of the first invalid unit if not ok
+    size_t out_count;  // written output units
+};
+
+CORE_EXPORT size_t find_invalid_utf8(std::string_view s) NOEXCEPT;  // returns `s.size()` if valid
+CORE_EXPORT size_t find_invalid_utf16(std::u16string_view s) NOEXCEPT;
+inline bool is_valid_utf8(std::string_view s) NOEXCEPT { return find_invalid_utf8(s) == s.size(); }
+CORE_EXPORT utf_result utf8_to_utf16(std::string_view s, char16_t* out) NOEXCEPT;
+CORE_EXPORT utf_result utf8_to_utf32(std::string_view s, char32_t* out) NOEXCEPT;
+CORE_EXPORT utf_result utf16_to_utf8(std::u16string_view s, char* out) NOEXCEPT;
+CORE_EXPORT utf_result utf32_to_utf8(std::u32string_view s, char* out) NOEXCEPT;
+
+// Wide strings hold UTF-16 whatever the size of `wchar_t` is; with 4-byte `wchar_t` units above 0xFFFF are
+// also accepted as code points; invalid input is converted leniently
 CORE_EXPORT std::wstring from_utf8_to_wide(std::string_view s);
 CORE_EXPORT std::string from_wide_to_utf8(std::wstring_view s);
 CORE_EXPORT std::string_view trim_string(std::string_view s);
 CORE_EXPORT std::vector<std::string> unpack_strings(std::string_view s, char sep);
+// Characters of `symb` are encoded as `\` followed by the character of `code` at the same position; for large
+// payloads see `escape_table`
 CORE_EXPORT std::string encode_escapes(std::string_view s, std::string_view symb, std::string_view code);
 CORE_EXPORT std::string decode_escapes(std::string_view s, std::string_view symb, std::string_view code);
+
+template<typename StrTy>
+std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> encode_escapes(std::string_view s, std::string_view symb,
+                                                                        std::string_view code, StrTy& out) {
+    out.reserve(out.size() + s.size());
+    auto p = s.begin(), p0 = p;
+    for (; p < s.end(); ++p) {
+        auto pos = symb.find(*p);
+        if (pos != std::string_view::npos) {
+            out.append(p0, p);
+            out += '\\';
+            out += code[pos];
+            p0 = p + 1;
+        }
+    }
+    out.append(p0, p);
+    return out;
+}
+
+template<typename StrTy>
+std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> decode_escapes(std::string_view s, std::string_view symb,
+                                                                        std::string_view code, StrTy& out) {
+    out.reserve(out.size() + s.size());
+    auto p = s.begin(), p0 = p;
+    for (; p < s.end(); ++p) {
+        if (*p != '\\') { continue; }
+        out.append(p0, p);
+        p0 = p + 1;
+        if (++p == s.end()) { break; }
+        auto pos = code.find(*p);
+        if (pos != std::string_view::npos) {
+            out += symb[pos];
+            p0 = p + 1;
+        }
+    }
+    out.append(p0, p);
+    return out;
+}
+// Escape table compiled once from `symb` and `code` for encoding and decoding of large payloads: characters
+// to escape are searched by 16-byte blocks, and unescaped runs are copied in bulk
+class CORE_EXPORT escape_table {
+ public:
+    escape_table(std::string_view symb, std::string_view code);
+
+    // Exact output sizes
+    size_t encoded_size(std::string_view s) const NOEXCEPT;
+    size_t decoded_size(std::string_view s) const NOEXCEPT;
+
+    // Output buffer must have room for `encoded_size(s)` or `decoded_size(s)` characters; return the end of
+    // output. Decoded output never outruns the input, so it can be decoded in place
+    char* encode(std::string_view s, char* out) const NOEXCEPT;
+    char* decode(std::string_view s, char* out) const NOEXCEPT;
+
+    std::string encode(std::string_view s) const;
+    std::string decode(std::string_view s) const;
+    void decode_in_place(std::string& s) const { s.resize(decode(s, &s[0]) - s.data()); }
+
+    template<typename StrTy>
+    std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> encode(std::string_view s, StrTy& out) const {
+        const char *p = s.data(), *last = s.data() + s.size();
+        while (true) {
+            const char* p_escaped = find_escaped(p, last);
+            out.append(p, p_escaped - p);
+            if (p_escaped == last) { break; }
+            const char seq[2] = {'\\', code_[static_cast<uint8_t>(*p_escaped)]};
+            out.append(seq, 2);
+            p = p_escaped + 1;
+        }
+        return out;
+    }
+
+    template<typename StrTy>
+    std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> decode(std::string_view s, StrTy& out) const {
+        const char *p = s.data(), *last = s.data() + s.size();
+        while (true) {
+            const char* p_escape = impl::find_first_of2(p, last, '\\', '\\');
+            out.append(p, p_escape - p);
+            if (last - p_escape < 2) { break; }  // trailing `\` is dropped
+            out.append(&symb_[static_cast<uint8_t>(p_escape[1])], 1);
+            p = p_escape + 2;
+        }
+        return out;
+    }
+
+    // Returns pointer to the first character to be escaped, or `last`
+    const char* find_escaped(const char* first, const char* last) const NOEXCEPT;
+
+ private:
+    enum : size_t { kMaxVectorSymbols = 8 };
+    std::string symbols_;              // distinct characters to escape
+    std::array<bool, 256> is_escaped_;
+    std::array<char, 256> code_;       // escape code of character
+    std::array<char, 256> symb_;       // character of escape code, or the code itself
+};
+
 CORE_EXPORT std::pair<unsigned, unsigned> parse_flag_string(
     std::string_view s, const std::vector<std::pair<std::string_view, unsigned>>& flag_tbl);
 
-CORE_EXPORT int compare_strings_nocase(std::string_view lhs, std::string_view rhs);
+// Case mapping and case-insensitive comparison do not depend on locale: only ASCII letters are mapped, other
+// bytes, including UTF-8 sequences, are kept as is
+
+namespace impl {
+inline char to_lower_ascii(char ch) { return static_cast<unsigned char>(ch - 'A') < 26 ? ch + ('a' - 'A') : ch; }
+inline char to_upper_ascii(char ch) { return static_cast<unsigned char>(ch - 'a') < 26 ? ch - ('a' - 'A') : ch; }
+CORE_EXPORT void to_lower_ascii(const char* first, const char* last, char* out) NOEXCEPT;
+CORE_EXPORT void to_upper_ascii(const char* first, const char* last, char* out) NOEXCEPT;
+}  // namespace impl
+
 CORE_EXPORT std::string to_lower(std::string s);
+// Keys mapped to upper case once are compared with `memcmp` (e.g. by `std::less<>`) in the same order as by
+// `compare_strings_nocase`
+CORE_EXPORT std::string to_upper(std::string s);
+
+template<typename StrTy>
+std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> to_lower(std::string_view s, StrTy& out) {
+    char buf[64];
+    for (size_t pos = 0; pos < s.size(); pos += sizeof(buf)) {
+        const size_t count = std::min(s.size() - pos, sizeof(buf));
+        impl::to_lower_ascii(s.data() + pos, s.data() + pos + count, buf);
+        out.append(buf, count);
+    }
+    return out;
+}
+
+template<typename StrTy>
+std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> to_upper(std::string_view s, StrTy& out) {
+    char buf[64];
+    for (size_t pos = 0; pos < s.size(); pos += sizeof(buf)) {
+        const size_t count = std::min(s.size() - pos, sizeof(buf));
+        impl::to_upper_ascii(s.data() + pos, s.data() + pos + count, buf);
+        out.append(buf, count);
+    }
+    return out;
+}
+
+//-------------------------------------------------------------------
+// Hashed string view
+
+CORE_EXPORT std::uint64_t hash_bytes(const void* data, size_t size);
+
+template<typename Ty>
+std::uint64_t hash_string(std::basic_string_view<Ty> s) {
+    return hash_bytes(s.data(), s.size() * sizeof(Ty));
+}
+
+template<typename Ty>
+class basic_hashed_string_view {
+ public:
+    using value_type = Ty;
+    using view_type = std::basic_string_view<Ty>;
+    using size_type = typename view_type::size_type;
+    using const_iterator = typename view_type::const_iterator;
+
+    basic_hashed_string_view() : hash_(hash_string(view_type())) {}
+    basic_hashed_string_view(view_type s) : s_(s), hash_(hash_string(s)) {}
+    basic_hashed_string_view(const Ty* s) : basic_hashed_string_view(view_type(s)) {}
+    basic_hashed_string_view(const std::basic_string<Ty>& s) : basic_hashed_string_view(view_type(s)) {}
+    basic_hashed_string_view(view_type s, std::uint64_t hash) : s_(s), hash_(hash) {}
+
+    const Ty* data() const { return s_.data(); }
+    size_type size() const { return s_.size(); }
+    bool empty() const { return s_.empty(); }
+    const_iterator begin() const { return s_.begin(); }
+    const_iterator end() const { return s_.end(); }
+    std::uint64_t hash() const { return hash_; }
+    view_type view() const { return s_; }
+    operator view_type() const { return s_; }
+
+    friend bool operator==(const basic_hashed_string_view& lhs, const basic_hashed_string_view& rhs) {
+        return lhs.hash_ == rhs.hash_ && lhs.s_.size() == rhs.s_.size() &&
+               (lhs.s_.data() == rhs.s_.data() || lhs.s_ == rhs.s_);
+    }
+    friend bool operator!=(const basic_hashed_string_view& lhs, const basic_hashed_string_view& rhs) {
+        return !(lhs == rhs);
+    }
+
+ private:
+    view_type s_;
+    std::uint64_t hash_;
+};
+
+using hashed_string_view = basic_hashed_string_view<char>;
+using hashed_wstring_view = basic_hashed_string_view<wchar_t>;
+
+// Transparent hasher and equality comparator: keys and probes of `basic_hashed_string_view` type use their
+// cached hash values, plain strings are hashed on the fly, once per lookup
+template<typename Ty>
+struct basic_string_hash {
+    using is_transparent = int;
+    size_t operator()(const basic_hashed_string_view<Ty>& s) const { return static_cast<size_t>(s.hash()); }
+    size_t operator()(std::basic_string_view<Ty> s) const { return static_cast<size_t>(hash_string(s)); }
+    size_t operator()(const std::basic_string<Ty>& s) const { return (*this)(std::basic_string_view<Ty>(s)); }
+    size_t operator()(const Ty* s) const { return (*this)(std::basic_string_view<Ty>(s)); }
+};
+
+template<typename Ty>
+struct basic_string_equal_to {
+    using is_transparent = int;
+    bool operator()(const basic_hashed_string_view<Ty>& lhs, const basic_hashed_string_view<Ty>& rhs) const {
+        return lhs == rhs;
+    }
+    template<typename Ty1, typename Ty2>
+    bool operator()(const Ty1& lhs, const Ty2& rhs) const {
+        return std::basic_string_view<Ty>(lhs) == std::basic_string_view<Ty>(rhs);
+    }
+};
+
+// Orders by hash value first, so the order is not lexicographical. The comparator is deliberately not
+// transparent: a plain string probe is converted to the key type, and so hashed, once per lookup rather than
+// once per visited tree node
+template<typename Ty>
+struct basic_hashed_string_less {
+    bool operator()(const basic_hashed_string_view<Ty>& lhs, const basic_hashed_string_view<Ty>& rhs) const {
+        if (lhs.hash() != rhs.hash()) { return lhs.hash() < rhs.hash(); }
+        if (lhs.data() == rhs.data() && lhs.size() == rhs.size()) { return false; }
+        return lhs.view() < rhs.view();
+    }
+};
+
+using string_hash = basic_string_hash<char>;
+using string_equal_to = basic_string_equal_to<char>;
+using hashed_string_less = basic_hashed_string_less<char>;
 
 //-------------------------------------------------------------------
 // String converters
@@ -649,56 +1228,103 @@ struct string_converter;
 
 template<>
 struct CORE_EXPORT string_converter<int16_t> : string_converter_base<int16_t> {
+    enum : size_t { kMaxChars = 32 };
     static const char* from_string(std::string_view s, int16_t& val, bool* ok = nullptr);
     static std::string to_string(int16_t val, scvt_base base = scvt_base::kBase10);
+    static char* to_chars(char* first, char* last, int16_t val, scvt_base base = scvt_base::kBase10);
+    static size_t from_strings(span<const std::string_view> s, span<int16_t> val, span<uint64_t> error_mask = {});
+    static void to_strings(span<const int16_t> val, std::string& out, std::string_view sep = "\n",
+                           scvt_base base = scvt_base::kBase10);
 };
 
 template<>
 struct CORE_EXPORT string_converter<int32_t> : string_converter_base<int32_t> {
+    enum : size_t { kMaxChars = 32 };
     static const char* from_string(std::string_view s, int32_t& val, bool* ok = nullptr);
     static std::string to_string(int32_t val, scvt_base base = scvt_base::kBase10);
+    static char* to_chars(char* first, char* last, int32_t val, scvt_base base = scvt_base::kBase10);
+    static size_t from_strings(span<const std::string_view> s, span<int32_t> val, span<uint64_t> error_mask = {});
+    static void to_strings(span<const int32_t> val, std::string& out, std::string_view sep = "\n",
+                           scvt_base base = scvt_base::kBase10);
 };
 
 template<>
 struct CORE_EXPORT string_converter<int64_t> : string_converter_base<int64_t> {
+    enum : size_t { kMaxChars = 32 };
     static const char* from_string(std::string_view s, int64_t& val, bool* ok = nullptr);
     static std::string to_string(int64_t val, scvt_base base = scvt_base::kBase10);
+    static char* to_chars(char* first, char* last, int64_t val, scvt_base base = scvt_base::kBase10);
+    static size_t from_strings(span<const std::string_view> s, span<int64_t> val, span<uint64_t> error_mask = {});
+    static void to_strings(span<const int64_t> val, std::string& out, std::string_view sep = "\n",
+                           scvt_base base = scvt_base::kBase10);
 };
 
 template<>
 struct CORE_EXPORT string_converter<uint16_t> : string_converter_base<uint16_t> {
+    enum : size_t { kMaxChars = 32 };
     static const char* from_string(std::string_view s, uint16_t& val, bool* ok = nullptr);
     static std::string to_string(uint16_t val, scvt_base base = scvt_base::kBase10);
+    static char* to_chars(char* first, char* last, uint16_t val, scvt_base base = scvt_base::kBase10);
+    static size_t from_strings(span<const std::string_view> s, span<uint16_t> val, span<uint64_t> error_mask = {});
+    static void to_strings(span<const uint16_t> val, std::string& out, std::string_view sep = "\n",
+                           scvt_base base = scvt_base::kBase10);
 };
 
 template<>
 struct CORE_EXPORT string_converter<uint32_t> : string_converter_base<uint32_t> {
+    enum : size_t { kMaxChars = 32 };
     static const char* from_string(std::string_view s, uint32_t& val, bool* ok = nullptr);
     static std::string to_string(uint32_t val, scvt_base base = scvt_base::kBase10);
+    static char* to_chars(char* first, char* last, uint32_t val, scvt_base base = scvt_base::kBase10);
+    static size_t from_strings(span<const std::string_view> s, span<uint32_t> val, span<uint64_t> error_mask = {});
+    static void to_strings(span<const uint32_t> val, std::string& out, std::string_view sep = "\n",
+                           scvt_base base = scvt_base::kBase10);
 };
 
 template<>
 struct CORE_EXPORT string_converter<uint64_t> : string_converter_base<uint64_t> {
+    enum : size_t { kMaxChars = 32 };
     static const char* from_string(std::string_view s, uint64_t& val, bool* ok = nullptr);
     static std::string to_string(uint64_t val, scvt_base base = scvt_base::kBase10);
+    static char* to_chars(char* first, char* last, uint64_t val, scvt_base base = scvt_base::kBase10);
+    static size_t from_strings(span<const std::string_view> s, span<uint64_t> val, span<uint64_t> error_mask = {});
+    static void to_strings(span<const uint64_t> val, std::string& out, std::string_view sep = "\n",
+                           scvt_base base = scvt_base::kBase10);
 };
 
 template<>
 struct CORE_EXPORT string_converter<float> : string_converter_base<float> {
+    enum : size_t { kMaxChars = 128 };
     static const char* from_string(std::string_view s, float& val, bool* ok = nullptr);
     static std::string to_string(float val, scvt_fp fmt = scvt_fp::kGeneral, int prec = -1);
+    static char* to_chars(char* first, char* last, float val, scvt_fp fmt = scvt_fp::kGeneral, int prec = -1);
+    static size_t from_strings(span<const std::string_view> s, span<float> val, span<uint64_t> error_mask = {});
+    static void to_strings(span<const float> val, std::string& out, std::string_view sep = "\n",
+                           scvt_fp fmt = scvt_fp::kGeneral, int prec = -1);
 };
 
 template<>
 struct CORE_EXPORT string_converter<double> : string_converter_base<double> {
+    enum : size_t { kMaxChars = 512 };
     static const char* from_string(std::string_view s, double& val, bool* ok = nullptr);
     static std::string to_string(double val, scvt_fp fmt = scvt_fp::kGeneral, int prec = -1);
+    static char* to_chars(char* first, char* last, double val, scvt_fp fmt = scvt_fp::kGeneral, int prec = -1);
+    static size_t from_strings(span<const std::string_view> s, span<double> val, span<uint64_t> error_mask = {});
+    static void to_strings(span<const double> val, std::string& out, std::string_view sep = "\n",
+                           scvt_fp fmt = scvt_fp::kGeneral, int prec = -1);
 };
 
 template<>
 struct CORE_EXPORT string_converter<bool> : string_converter_base<bool> {
+    enum : size_t { kMaxChars = 8 };
     static const char* from_string(std::string_view s, bool& val, bool* ok = nullptr);
     static std::string to_string(bool val) { return val ? "true" : "false"; }
+    static char* to_chars(char* first, char* last, bool val) {
+        std::string_view s = val ? "true" : "false";
+        if (static_cast<size_t>(last - first) < s.size()) { return first; }
+        std::memcpy(first, s.data(), s.size());
+        return first + s.size();
+    }
 };
 
 template<typename Ty, typename Def, typename... Args>
@@ -720,6 +1346,26 @@ std::string to_string(const Ty& val, Args&&... args) {
     return string_converter<Ty>::to_string(val, std::forward<Args>(args)...);
 }
 
+// Writes value string representation to [first, last) range without allocations; returns the pointer past the last
+// written character or `first` if the range is too small
+template<typename Ty, typename... Args>
+char* to_chars(char* first, char* last, const Ty& val, Args&&... args) {
+    return string_converter<Ty>::to_chars(first, last, val, std::forward<Args>(args)...);
+}
+
+// Batch conversions: fields must be converted entirely, surrounding spaces are allowed; failed fields get default
+// value and are marked in optional `error_mask` bit array; returns the number of failed fields
+template<typename Ty, typename... Args>
+size_t from_strings(span<const std::string_view> s, span<Ty> val, Args&&... args) {
+    return string_converter<Ty>::from_strings(s, val, std::forward<Args>(args)...);
+}
+
+// Appends values separated with `sep` to one output buffer
+template<typename Ty, typename... Args>
+void to_strings(span<const Ty> val, std::string& out, Args&&... args) {
+    string_converter<Ty>::to_strings(val, out, std::forward<Args>(args)...);
+}
+
 #ifdef USE_QT
 template<>
 struct qt_type_converter<QString> {
@@ -759,42 +1405,246 @@ class CORE_EXPORT sformat {
     explicit sformat(std::string_view fmt) : fmt_(fmt) {}
     std::string str() const;
     operator std::string() const { return str(); }
+
+    // Writes formatted string into output buffer or sink
+    template<typename StrTy>
+    std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> str(StrTy& out) const {
+        auto p = fmt_.data(), p0 = p, end = p + fmt_.size();
+        while (p < end) {
+            if (*p != '%') {
+                ++p;
+                continue;
+            }
+            out.append(p0, p++ - p0);
+            if (p == end) {
+                return out;
+            } else if (*p >= '0' && *p <= '9') {
+                size_t n = static_cast<size_t>(*p++ - '0');
+                while ((p < end) && *p >= '0' && *p <= '9') { n = 10 * n + static_cast<size_t>(*p++ - '0'); }
+                if ((n > 0) && (n <= arg_ends_.size())) {
+                    const size_t start = n > 1 ? arg_ends_[n - 2] : 0;
+                    out.append(buf_.data() + start, arg_ends_[n - 1] - start);
+                }
+                p0 = p;
+            } else {
+                p0 = p++;
+            }
+        }
+        out.append(p0, p - p0);
+        return out;
+    }
 #ifdef USE_QT
     operator QString() const { return to_qt<QString>(str()); }
 #endif  // USE_QT
 
     template<typename Ty, typename... Args>
     sformat& arg(Ty&& v, Args&&... args) {
-        args_.emplace_back(arg_cvt(std::forward<Ty>(v), std::forward<Args>(args)...));
+        append_arg(std::forward<Ty>(v), std::forward<Args>(args)...);
+        arg_ends_.push_back(buf_.size());
         return *this;
     }
 
     template<typename Ty, typename... Args>
     sformat& arg(Ty&& v, sfield field, Args&&... args) {
-        auto s = arg_cvt(std::forward<Ty>(v), std::forward<Args>(args)...);
+        const size_t start = buf_.size();
+        append_arg(std::forward<Ty>(v), std::forward<Args>(args)...);
         auto width = static_cast<size_t>(field.width);
-        if (width > s.size()) { s.insert(0, width - s.size(), field.fill); }
-        args_.emplace_back(std::move(s));
+        if (width > buf_.size() - start) { buf_.insert(start, width - buf_.size() + start, field.fill); }
+        arg_ends_.push_back(buf_.size());
         return *this;
     }
 
  private:
-    std::string arg_cvt(std::string_view s) { return static_cast<std::string>(s); }
-    std::string arg_cvt(std::string s) { return std::move(s); }
-    std::string arg_cvt(const char* s) { return std::string(s); }
-    std::string arg_cvt(const sformat& fmt) { return fmt.str(); }
-    std::string arg_cvt(void* p) { return arg_cvt(reinterpret_cast<uintptr_t>(p), scvt_base::kBase16); }
+    void append_arg(std::string_view s) { buf_ += s; }
+    void append_arg(const char* s) { buf_ += s; }
+    void append_arg(const sformat& fmt) { fmt.str(buf_); }
+    void append_arg(void* p) { append_to(buf_, reinterpret_cast<uintptr_t>(p), scvt_base::kBase16); }
 #ifdef USE_QT
-    std::string arg_cvt(const QString& s) { return from_qt<std::string>(s); }
+    void append_arg(const QString& s) { buf_ += from_qt<std::string>(s); }
 #endif  // USE_QT
 
     template<typename Ty, typename = std::void_t<typename string_converter<Ty>::is_string_converter>, typename... Args>
-    std::string arg_cvt(const Ty& v, Args&&... args) {
-        return to_string(v, std::forward<Args>(args)...);
+    void append_arg(const Ty& v, Args&&... args) {
+        append_to(buf_, v, std::forward<Args>(args)...);
+    }
+
+    std::string_view fmt_;
+    std::string buf_;               // all converted arguments one after another
+    std::vector<size_t> arg_ends_;  // argument end positions in `buf_`
+};
+
+//-------------------------------------------------------------------
+// String formatter with placeholder layout parsed at compile time
+
+namespace impl {
+// Calls `fn(arg, offset, size)` for each piece of format string: `arg` is the argument number of `%N`
+// placeholder or 0 for text piece; `%` followed by not a digit is dropped and the next character is taken as text
+template<typename Fn>
+constexpr void sformat_parse(std::string_view fmt, Fn fn) {
+    size_t p = 0, p0 = 0;
+    while (p < fmt.size()) {
+        if (fmt[p] != '%') {
+            ++p;
+            continue;
+        }
+        if (p0 != p) { fn(0u, p0, p - p0); }
+        if (++p == fmt.size()) {
+            return;
+        } else if (fmt[p] >= '0' && fmt[p] <= '9') {
+            unsigned n = 0;
+            for (; (p < fmt.size()) && (fmt[p] >= '0') && (fmt[p] <= '9'); ++p) {
+                n = 10 * n + static_cast<unsigned>(fmt[p] - '0');
+                if (n > 999) { throw std::logic_error("too big argument number"); }
+            }
+            if (n == 0) { throw std::logic_error("zero argument number"); }
+            fn(n, size_t(0), size_t(0));
+            p0 = p;
+        } else {
+            p0 = p++;
+        }
+    }
+    if (p0 != p) { fn(0u, p0, p - p0); }
+}
+
+constexpr size_t sformat_piece_count(std::string_view fmt) {
+    size_t count = 0;
+    sformat_parse(fmt, [&count](unsigned, size_t, size_t) { ++count; });
+    return count;
+}
+
+constexpr unsigned sformat_arg_count(std::string_view fmt) {
+    unsigned count = 0;
+    sformat_parse(fmt, [&count](unsigned arg, size_t, size_t) { count = arg > count ? arg : count; });
+    return count;
+}
+}  // namespace impl
+
+// Use `UTIL_SFORMAT_LAYOUT` macro to make the layout
+template<size_t PieceCount, unsigned ArgCount>
+class sformat_layout {
+ public:
+    struct piece_t {
+        unsigned arg = 0;  // argument number or 0 for text piece
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    constexpr explicit sformat_layout(std::string_view fmt) : fmt_(fmt) {
+        size_t n = 0;
+        impl::sformat_parse(fmt, [this, &n](unsigned arg, size_t offset, size_t size) {
+            pieces_[n].arg = arg, pieces_[n].offset = offset, pieces_[n++].size = size;
+        });
     }
 
+    constexpr std::string_view fmt() const { return fmt_; }
+    static constexpr size_t size() { return PieceCount; }
+    constexpr const piece_t& operator[](size_t n) const { return pieces_[n]; }
+    static constexpr unsigned arg_count() { return ArgCount; }
+
+ private:
     std::string_view fmt_;
-    std::vector<std::string> args_;
+    std::array<piece_t, PieceCount> pieces_{};
 };
 
+// Makes the layout of a string literal at compile time, so invalid format string fails compilation; `sformat_to`
+// fails compilation too if the layout refers to more arguments than are given
+#define UTIL_SFORMAT_LAYOUT(fmt) \
+    ([]() -> const auto& { \
+        static constexpr ::util::sformat_layout<::util::impl::sformat_piece_count(fmt), \
+                                                ::util::impl::sformat_arg_count(fmt)> \
+            layout(fmt); \
+        return layout; \
+    }())
+
+// Argument with conversion parameters and optional field
+template<typename Ty, typename... Args>
+struct sformat_arg {
+    const Ty& val;
+    sfield field;
+    std::tuple<Args...> args;
+};
+
+template<typename Ty, typename... Args>
+sformat_arg<Ty, Args...> sarg(const Ty& val, sfield field, Args... args) {
+    return sformat_arg<Ty, Args...>{val, field, std::tuple<Args...>(args...)};
+}
+
+template<typename Ty, typename... Args>
+sformat_arg<Ty, Args...> sarg(const Ty& val, Args... args) {
+    return sformat_arg<Ty, Args...>{val, sfield(0), std::tuple<Args...>(args...)};
+}
+
+namespace impl {
+template<typename StrTy>
+void sformat_append(StrTy& out, std::string_view s, sfield field = sfield(0)) {
+    if (s.size() < static_cast<size_t>(field.width)) {
+        std::array<char, 64> fill;
+        fill.fill(field.fill);
+        for (size_t n = static_cast<size_t>(field.width) - s.size(), count = 0; n > 0; n -= count) {
+            out.append(fill.data(), count = std::min(n, fill.size()));
+        }
+    }
+    out.append(s.data(), s.size());
+}
+
+template<typename StrTy, typename Ty, typename... Args>
+std::enable_if_t<has_string_converter<Ty>::value> sformat_append(StrTy& out, const Ty& val, sfield field,
+                                                                 Args... args) {
+    char buf[string_converter<Ty>::kMaxChars];
+    char* last = string_converter<Ty>::to_chars(buf, buf + sizeof(buf), val, args...);
+    sformat_append(out, std::string_view(buf, last - buf), field);
+}
+
+template<typename StrTy, typename Ty>
+std::enable_if_t<has_string_converter<Ty>::value> sformat_append(StrTy& out, const Ty& val) {
+    sformat_append(out, val, sfield(0));
+}
+
+template<typename StrTy>
+void sformat_append(StrTy& out, const char* s) {
+    sformat_append(out, std::string_view(s));
+}
+
+template<typename StrTy>
+void sformat_append(StrTy& out, const void* p) {
+    sformat_append(out, reinterpret_cast<uintptr_t>(p), sfield(0), scvt_base::kBase16);
+}
+
+template<typename StrTy, typename Ty, typename... Args>
+void sformat_append(StrTy& out, const sformat_arg<Ty, Args...>& arg) {
+    std::apply([&out, &arg](Args... args) { sformat_append(out, arg.val, arg.field, args...); }, arg.args);
+}
+
+template<typename StrTy, typename Ty>
+void sformat_append_erased(StrTy& out, const void* arg) {
+    sformat_append(out, *static_cast<const Ty*>(arg));
+}
+}  // namespace impl
+
+// Formats arguments directly into output string buffer
+template<typename StrTy, size_t PieceCount, unsigned ArgCount, typename... Ts>
+std::enable_if_t<is_string_buffer<StrTy>::value, StrTy&> sformat_to(
+    StrTy& out, const sformat_layout<PieceCount, ArgCount>& layout, const Ts&... args) {
+    static_assert(ArgCount <= sizeof...(Ts), "format string refers to missing arguments");
+    using append_func_t = void (*)(StrTy&, const void*);
+    const std::pair<append_func_t, const void*> arg_table[] = {
+        {&impl::sformat_append_erased<StrTy, Ts>, static_cast<const void*>(&args)}..., {nullptr, nullptr}};
+    for (size_t n = 0; n < layout.size(); ++n) {
+        const auto& piece = layout[n];
+        if (!piece.arg) {
+            out.append(layout.fmt().data() + piece.offset, piece.size);
+        } else {
+            arg_table[piece.arg - 1].first(out, arg_table[piece.arg - 1].second);
+        }
+    }
+    return out;
+}
+
 }  // namespace util
+
+namespace std {
+template<typename Ty>
+struct hash<util::basic_hashed_string_view<Ty>> {
+    size_t operator()(const util::basic_hashed_string_view<Ty>& s) const { return static_cast<size_t>(s.hash()); }
+};
+}  // namespace std
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "util_span.h"
+#include "variant.h"
+#include "xml_parser.h"
+
+#include <vector>
+
+namespace util {
+
+class xml_node;
+
+// Document tree built from `xml_parser` tokens. Nodes are allocated in the document's arena by pages and refer
+// to each other by 32-bit indices, attributes of each element are stored in the arena contiguously, names are
+// interned, text and attribute values are views into the parsed buffer, or into the arena if they contain
+// character references. Whitespace-only text is not stored, declarations and doctypes are skipped
+class CORE_EXPORT xml_document {
+ public:
+    enum : unsigned { kEagerAll = ~0u };
+
+    using attribute = std::pair<std::string_view, std::string_view>;
+
+    // Names are interned into `names` pool if given, or into document's own pool
+    explicit xml_document(string_pool* names = nullptr) : names_(names ? names : &own_names_) {}
+    xml_document(const xml_document&) = delete;
+    xml_document& operator=(const xml_document&) = delete;
+
+    // Parses the buffer in place: the buffer must outlive the document. Elements of depth `eager_depth`
+    // (top-level elements have depth 1) are built with their attributes, but their content, unless it is plain
+    // text, is only scanned for the end tag and is parsed when children of the element are visited first time;
+    // returns `false` if the document is malformed, errors in deferred content are found when it is parsed
+    bool load(std::string_view buf, unsigned eager_depth = kEagerAll);
+    // Reads the whole stream into document's own buffer
+    bool load(std::istream& is, unsigned eager_depth = kEagerAll);
+
+    // The node containing top-level elements and text
+    xml_node document_node();
+    // The first top-level element
+    xml_node root();
+
+    bool has_errors() const { return has_errors_; }
+    size_t node_count() const { return node_count_; }
+    // Memory held by nodes, attributes, own buffer and decoded strings, except for interned names
+    size_t memory_usage() const;
+    string_pool& names() { return *names_; }
+
+ private:
+    friend class xml_node;
+
+    enum : uint32_t { kNodePageSize = 1024 };
+
+    struct node_t {
+        std::string_view str;  // element name or text
+        const attribute* attributes;
+        uint32_t attribute_count : 31;
+        uint32_t is_text : 1;
+        uint32_t parent;
+        uint32_t first_child;  // 0 if none or not yet parsed
+        uint32_t next_sibling;
+        uint32_t line;
+        uint32_t deferred;  // 1-based index of deferred content, or 0
+    };
+
+    struct deferred_t {
+        size_t from;
+        size_t to;
+        unsigned line;
+    };
+
+    struct level_t {
+        uint32_t node;
+        uint32_t last_child;
+    };
+
+    string_pool own_names_;
+    string_pool* names_;
+    std::string own_buf_;
+    std::string_view buf_;
+    arena arena_;
+    std::vector<node_t*> node_pages_;
+    uint32_t node_count_ = 0;
+    std::vector<deferred_t> deferred_;
+    std::vector<level_t> levels_;
+    bool has_errors_ = false;
+
+    node_t& node(uint32_t index) { return node_pages_[index / kNodePageSize][index % kNodePageSize]; }
+    uint32_t new_node(const node_t& node);
+    bool parse(uint32_t parent, size_t from, size_t to, unsigned line, unsigned eager_depth);
+    void materialize(uint32_t index);
+};
+
+// Light-weight handle of a document node: an element or a text; handles stay valid while the document is not
+// reloaded or destroyed. Visiting children of an element with deferred content modifies the document, so
+// such documents must not be shared between threads
+class xml_node {
+ public:
+    xml_node() = default;
+
+    bool valid() const { return doc_ != nullptr; }
+    explicit operator bool() const { return doc_ != nullptr; }
+    bool operator==(const xml_node& other) const { return doc_ == other.doc_ && index_ == other.index_; }
+    bool operator!=(const xml_node& other) const { return !(*this == other); }
+
+    bool is_element() const { return !node().is_text; }
+    bool is_text() const { return node().is_text; }
+    bool is_materialized() const { return !node().deferred; }
+    unsigned line() const { return node().line; }
+
+    // Empty for text nodes
+    std::string_view name() const { return node().is_text ? std::string_view() : node().str; }
+
+    // Text of a text node, or of the first text child of an element
+    std::string_view text() const {
+        if (node().is_text) { return node().str; }
+        for (xml_node child = first_child(); child; child = child.next_sibling()) {
+            if (child.is_text()) { return child.node().str; }
+        }
+        return {};
+    }
+
+    variant value(variant_id type = variant_id::kString) const { return variant(type, text()); }
+    template<typename Ty>
+    Ty value() const {
+        return value(variant_type_impl<Ty>::type_id).template value<Ty>();
+    }
+
+    span<const xml_document::attribute> attributes() const {
+        return span<const xml_document::attribute>(node().attributes, node().attribute_count);
+    }
+
+    // Returns null if there is no such attribute
+    const xml_document::attribute* find_attribute(std::string_view name) const {
+        for (const auto& attr : attributes()) {
+            if (attr.first == name) { return &attr; }
+        }
+        return nullptr;
+    }
+
+    std::string_view attribute(std::string_view name, std::string_view def = {}) const {
+        const auto* attr = find_attribute(name);
+        return attr ? attr->second : def;
+    }
+
+    variant attribute_value(std::string_view name, variant_id type = variant_id::kString) const {
+        const auto* attr = find_attribute(name);
+        return attr ? variant(type, attr->second) : variant();
+    }
+    template<typename Ty>
+    Ty attribute_value(std::string_view name) const {
+        return attribute_value(name, variant_type_impl<Ty>::type_id).template value<Ty>();
+    }
+
+    xml_node parent() const { return index_ ? xml_node(doc_, node().parent) : xml_node(); }
+    xml_node next_sibling() const { return make(node().next_sibling); }
+
+    // Parses deferred content of the element
+    xml_node first_child() const {
+        if (node().deferred) { doc_->materialize(index_); }
+        return make(node().first_child);
+    }
+
+    // The first child element with given name
+    xml_node child(std::string_view name) const {
+        xml_node child = first_child();
+        while (child && (child.is_text() || child.node().str != name)) { child = child.next_sibling(); }
+        return child;
+    }
+
+    // The next sibling element with given name
+    xml_node next_sibling(std::string_view name) const {
+        xml_node sibling = next_sibling();
+        while (sibling && (sibling.is_text() || sibling.node().str != name)) { sibling = sibling.next_sibling(); }
+        return sibling;
+    }
+
+ private:
+    friend class xml_document;
+
+    xml_document* doc_ = nullptr;
+    uint32_t index_ = 0;
+
+    xml_node(xml_document* doc, uint32_t index) : doc_(doc), index_(index) {}
+    xml_node make(uint32_t index) const { return index ? xml_node(doc_, index) : xml_node(); }
+    const xml_document::node_t& node() const {
+        assert(doc_);
+        return doc_->node(index_);
+    }
+};
+
+inline xml_node xml_document::document_node() { return xml_node(this, 0); }
+
+inline xml_node xml_document::root() {
+    xml_node node = document_node().first_child();
+    while (node && node.is_text()) { node = node.next_sibling(); }
+    return node;
+}
+
+}  // namespace util
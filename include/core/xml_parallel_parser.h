@@ -0,0 +1,59 @@
+#pragma once
+
+#include "util_span.h"
+#include "xml_parser.h"
+
+#include <vector>
+
+namespace util {
+
+// Parses a document held in memory (e.g. mapped with `mapped_file`) by several threads: the document is split
+// speculatively before element tags, the chunks are parsed by independent `xml_parser` instances, and the
+// token streams are stitched in document order. A split point is accepted only if the chunk before it is
+// parsed without errors up to its very end, otherwise the two chunks are parsed again as one
+class CORE_EXPORT xml_parallel_parser {
+ public:
+    enum : size_t { kMinChunkSize = 65536 };
+
+    using attribute = std::pair<std::string_view, std::string_view>;
+
+    // Names are views of strings interned into `names()` pool, so equal names have equal data pointers
+    struct token {
+        xml_parser_token type;
+        unsigned line;
+        std::string_view value;  // text for plain text, or name for other tokens
+        size_t first_attribute;
+        size_t attribute_count;
+    };
+
+    // Zero `thread_count` means hardware concurrency
+    explicit xml_parallel_parser(unsigned thread_count = 0);
+    xml_parallel_parser(const xml_parallel_parser&) = delete;
+    xml_parallel_parser& operator=(const xml_parallel_parser&) = delete;
+
+    // Parses the whole buffer, which must outlive the parsed tokens; returns `false` if the document is
+    // malformed: then the last token is `kParsingError`
+    bool parse(std::string_view buf);
+
+    const std::vector<token>& tokens() const { return tokens_; }
+    span<const attribute> attributes(const token& tok) const {
+        return span<const attribute>(attributes_.data() + tok.first_attribute, tok.attribute_count);
+    }
+    concurrent_string_pool& names() { return names_; }
+    size_t chunk_count() const { return chunk_count_; }
+
+ private:
+    struct chunk_t;
+
+    unsigned thread_count_;
+    size_t chunk_count_ = 0;
+    concurrent_string_pool names_;
+    std::vector<token> tokens_;
+    std::vector<attribute> attributes_;
+    std::vector<arena> strings_;  // decoded text and attribute values
+
+    void parse_chunk(std::string_view buf, chunk_t& chunk, bool report_errors);
+    void stitch_chunk(chunk_t& chunk);
+};
+
+}  // namespace util
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "stream.h"
+#include "string_pool.h"
+#include "unordered_map.h"
 
 #include <array>
-#include <unordered_map>
+#include <vector>
 
 namespace util {
 
@@ -14,22 +16,81 @@ enum class xml_parser_token : int {
     kEndOfSection,
     kDeclaration,
     kDoctype,
+    kNeedMoreData,
     kParsingError = -1
 };
 
+// Text and attribute values are views into the input buffer, or into parser's own storage if they contain
+// character references; the views stay valid until the next token is read
 class xml_parser {
  public:
-    explicit xml_parser(std::istream& ins);
+    // Attributes in order of appearance: a flat vector reused from tag to tag; lookup is linear for a few
+    // attributes, and by hash index, which is built only for tags having more than `kMaxLinearLookup` attributes
+    class attribute_map {
+     public:
+        enum : size_t { kMaxLinearLookup = 8 };
+        using value_type = std::pair<hashed_string_view, std::string_view>;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        size_t size() const { return items_.size(); }
+        bool empty() const { return items_.empty(); }
+        const_iterator begin() const { return items_.begin(); }
+        const_iterator end() const { return items_.end(); }
+
+        const_iterator find(hashed_string_view name) const {
+            if (items_.size() > kMaxLinearLookup) {
+                auto it = index_.find(name);
+                return it != index_.end() ? items_.begin() + it->second : items_.end();
+            }
+            return std::find_if(items_.begin(), items_.end(), [&name](const value_type& v) { return v.first == name; });
+        }
+        bool contains(hashed_string_view name) const { return find(name) != end(); }
+
+        void clear() {
+            if (!index_.empty()) { index_.clear(); }  // the index can be built for a rejected duplicate
+            items_.clear();
+        }
+
+        // The first of duplicate attributes is kept
+        bool emplace(hashed_string_view name, std::string_view value);
+
+     private:
+        std::vector<value_type> items_;
+        unordered_map<hashed_string_view, size_t, string_hash, string_equal_to> index_;
+    };
+
+    // Tag and attribute names are interned into `names` pool if given, or into parser's own pool
+    explicit xml_parser(std::istream& ins, string_pool* names = nullptr);
+    // Parses contiguous buffer in place: the buffer must outlive the parser
+    explicit xml_parser(std::string_view buf, string_pool* names = nullptr);
+    // Push mode: input is given in chunks with `feed`, `next_token` returns `kNeedMoreData` if the buffered
+    // input ends inside of a token; only the incomplete token is kept between chunks, scanning of incomplete
+    // text is resumed where it stopped, other tokens are parsed again only after their closing `>` or `-->`
+    // is received, so errors inside of incomplete markup can be reported only then
+    explicit xml_parser(string_pool* names = nullptr);
+    xml_parser(const xml_parser&) = delete;
+    xml_parser& operator=(const xml_parser&) = delete;
+
+    // Push mode: appends the next chunk of input; invalidates text and attributes of the last token
+    void feed(std::string_view chunk);
+    // Push mode: marks the end of input
+    void finish() { finished_ = true; }
+
     xml_parser_token next_token();
 
+    unsigned token_line() const { return token_line_; }
+    hashed_string_view name() const { return name_; }
+    std::string_view text() const { return text_; }
+    const attribute_map& attributes() const { return attributes_; }
+    string_pool& names() { return *names_; }
+
  private:
     struct symb_table_t : public std::array<bool, 256> {
-        struct add0_t {};
         explicit symb_table_t(std::string_view symbols) {
             fill(false);
             uint8_t prev_ch = '\0';
             for (auto it = symbols.begin(); it != symbols.end(); ++it) {
-                if (*it != '-') {
+                if (*it != '-' || it == symbols.begin()) {
                     prev_ch = static_cast<uint8_t>(*it);
                     (*this)[prev_ch] = true;
                 } else if (++it != symbols.end()) {
@@ -37,22 +98,63 @@ class xml_parser {
                 }
             }
         }
-        explicit symb_table_t(std::string_view symbols, add0_t) : symb_table_t(symbols) { (*this)['\0'] = true; }
     };
 
+    enum : size_t { kReadSize = 65536 };
+
+    // State of incomplete text token: positions are offsets from the token start
+    struct pending_text_t {
+        bool is_valid = false;
+        bool decoded = false;
+        unsigned line = 1;  // line at `scanned` position
+        size_t text_start = 0;
+        size_t text_from = 0;
+        size_t scanned = 0;
+    };
+
+    // State of incomplete markup: positions are offsets from the token start
+    struct pending_markup_t {
+        bool is_valid = false;
+        bool in_string = false;  // inside of attribute value at `scanned` position
+        size_t start = 0;        // position of `<`
+        size_t scanned = 0;
+    };
+
+    char get() { return p_ < end_ ? *p_++ : '\0'; }
+
+    friend class xml_document;
+    friend class xml_parallel_parser;
+
+    xml_parser_token parse_token();
+    bool scan_pending_markup();
     void error(unsigned line, std::string_view description);
     char skip_spaces();
     bool skip_up_to(std::string_view sub);
-    bool try_parse_name(char first, std::string& name);
+    bool skip_section_content();
+    bool try_parse_name(char first, std::string_view& name);
     bool parse_special_character(uint32_t& code);
-    bool parse_string(std::string& str);
+    bool parse_string(std::string_view& str);
 
-    std::istream& input_;
+    std::istream* input_ = nullptr;
+    bool finished_ = true;  // no more input will be fed
+    bool need_more_data_ = false;
+    pending_text_t pending_text_;
+    pending_markup_t pending_markup_;
+    bool report_errors_ = true;
+    std::string own_buf_;
+    const char* p_ = nullptr;
+    const char* end_ = nullptr;
+    string_pool own_names_;
+    string_pool* names_;
     unsigned token_line_ = 1;
     unsigned current_line_ = 1;
     bool is_empty_section_ = false;
-    std::string text_;
-    std::unordered_map<std::string, std::string> attributes_;
+    std::string_view text_;
+    std::string text_buf_;    // decoded text
+    std::string string_buf_;  // decoded attribute value
+    arena strings_;           // decoded attribute values of the current token
+    hashed_string_view name_;
+    attribute_map attributes_;
 };
 
 }  // namespace util
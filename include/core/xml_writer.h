@@ -0,0 +1,226 @@
+#pragma once
+
+#include "util_string.h"
+
+#include <vector>
+
+namespace util {
+
+namespace impl {
+// Returns pointer to the first character which must be escaped in text (`&<>`) or in attribute value (also
+// `"'` and `\n`), or `last`
+inline const char* find_xml_escaped(const char* first, const char* last, bool is_attribute) NOEXCEPT {
+#ifdef USE_SSE2
+    const __m128i amp = _mm_set1_epi8('&'), lt = _mm_set1_epi8('<'), gt = _mm_set1_epi8('>');
+    const __m128i quot = _mm_set1_epi8(is_attribute ? '\"' : '&'), apos = _mm_set1_epi8(is_attribute ? '\'' : '&');
+    const __m128i newline = _mm_set1_epi8(is_attribute ? '\n' : '&');
+    for (; last - first >= 16; first += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const __m128i eq = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, amp), _mm_cmpeq_epi8(v, lt)), _mm_cmpeq_epi8(v, gt)),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quot), _mm_cmpeq_epi8(v, apos)), _mm_cmpeq_epi8(v, newline)));
+        const int mask = _mm_movemask_epi8(eq);
+        if (mask) { return first + count_trailing_zeros(static_cast<std::uint32_t>(mask)); }
+    }
+#endif  // USE_SSE2
+    for (; first < last; ++first) {
+        switch (*first) {
+            case '&':
+            case '<':
+            case '>': return first;
+            case '\"':
+            case '\'':
+            case '\n': {
+                if (is_attribute) { return first; }
+            } break;
+            default: break;
+        }
+    }
+    return last;
+}
+}  // namespace impl
+
+//-----------------------------------------------------------------------------
+// XML writer: streams sections, attributes and text into a string buffer or a sink; the output is read back
+// by `xml_parser` into the same tokens, except for whitespace text added by pretty-printing
+
+template<typename StrTy>
+class xml_writer {
+ public:
+    // Nonzero `indent` enables pretty-printing: nested sections start on new lines and are indented by
+    // `indent` spaces per level, unless the parent section contains text
+    explicit xml_writer(StrTy& out, unsigned indent = 0) : out_(out), indent_(indent) {}
+    xml_writer(const xml_writer&) = delete;
+    xml_writer& operator=(const xml_writer&) = delete;
+
+    size_t depth() const { return levels_.size(); }
+
+    xml_writer& declaration(std::string_view version = "1.0", std::string_view encoding = "UTF-8") {
+        close_start_tag();
+        put("<?xml version=\"").put(version);
+        if (!encoding.empty()) { put("\" encoding=\"").put(encoding); }
+        put("\"?>");
+        is_empty_ = false;
+        return *this;
+    }
+
+    xml_writer& begin_section(std::string_view name) {
+        close_start_tag();
+        new_item_line();
+        put('<').put(name);
+        levels_.push_back(level_t{names_.size(), false, false});
+        names_.append(name.data(), name.size());
+        is_start_tag_open_ = true, is_empty_ = false;
+        return *this;
+    }
+
+    // Adds attribute to the section just begun
+    xml_writer& attribute(std::string_view name, std::string_view value) {
+        assert(is_start_tag_open_);
+        put(' ').put(name).put("=\"");
+        put_escaped(value, true);
+        put('\"');
+        return *this;
+    }
+
+    template<typename Ty, typename... Args>
+    std::enable_if_t<has_string_converter<Ty>::value && !std::is_convertible<Ty, std::string_view>::value,
+                     xml_writer&>
+    attribute(std::string_view name, const Ty& value, Args&&... args) {
+        assert(is_start_tag_open_);
+        put(' ').put(name).put("=\"");
+        put_converted(value, std::forward<Args>(args)...);
+        put('\"');
+        return *this;
+    }
+
+    xml_writer& text(std::string_view s) {
+        if (s.empty()) { return *this; }
+        close_start_tag();
+        if (!levels_.empty()) { levels_.back().has_text = true; }
+        put_escaped(s, false);
+        is_empty_ = false;
+        return *this;
+    }
+
+    template<typename Ty, typename... Args>
+    std::enable_if_t<has_string_converter<Ty>::value && !std::is_convertible<Ty, std::string_view>::value,
+                     xml_writer&>
+    text(const Ty& value, Args&&... args) {
+        close_start_tag();
+        if (!levels_.empty()) { levels_.back().has_text = true; }
+        put_converted(value, std::forward<Args>(args)...);
+        is_empty_ = false;
+        return *this;
+    }
+
+    // Comment text must not contain `--`
+    xml_writer& comment(std::string_view s) {
+        assert(s.find("--") == std::string_view::npos);
+        close_start_tag();
+        new_item_line();
+        put("<!--").put(s).put("-->");
+        is_empty_ = false;
+        return *this;
+    }
+
+    // Sections without content are closed with `/>`
+    xml_writer& end_section() {
+        assert(!levels_.empty());
+        const level_t level = levels_.back();
+        levels_.pop_back();
+        if (is_start_tag_open_) {
+            put("/>");
+            is_start_tag_open_ = false;
+        } else {
+            if (level.has_sections && !level.has_text) { new_line(levels_.size()); }
+            put("</").put(std::string_view(names_).substr(level.name_offset)).put('>');
+        }
+        names_.resize(level.name_offset);
+        return *this;
+    }
+
+    // Closes all open sections
+    xml_writer& finish() {
+        while (!levels_.empty()) { end_section(); }
+        if (indent_ && !is_empty_) { put('\n'); }
+        return *this;
+    }
+
+ private:
+    struct level_t {
+        size_t name_offset;  // in `names_`
+        bool has_sections;   // sections or comments
+        bool has_text;
+    };
+
+    StrTy& out_;
+    unsigned indent_;
+    bool is_start_tag_open_ = false;
+    bool is_empty_ = true;
+    std::string names_;  // names of open sections
+    std::vector<level_t> levels_;
+
+    xml_writer& put(char ch) {
+        out_.append(&ch, 1);
+        return *this;
+    }
+
+    xml_writer& put(std::string_view s) {
+        out_.append(s.data(), s.size());
+        return *this;
+    }
+
+    void put_escaped(std::string_view s, bool is_attribute) {
+        const char *p = s.data(), *last = s.data() + s.size();
+        while (true) {
+            const char* p_escaped = impl::find_xml_escaped(p, last, is_attribute);
+            if (p_escaped != p) { out_.append(p, p_escaped - p); }
+            if (p_escaped == last) { break; }
+            switch (*p_escaped) {
+                case '&': put("&amp;"); break;
+                case '<': put("&lt;"); break;
+                case '>': put("&gt;"); break;
+                case '\"': put("&quot;"); break;
+                case '\'': put("&apos;"); break;
+                default: put("&#10;"); break;
+            }
+            p = p_escaped + 1;
+        }
+    }
+
+    template<typename Ty, typename... Args>
+    void put_converted(const Ty& value, Args&&... args) {
+        char buf[string_converter<Ty>::kMaxChars];
+        const char* last = string_converter<Ty>::to_chars(buf, buf + sizeof(buf), value, std::forward<Args>(args)...);
+        put_escaped(std::string_view(buf, last - buf), true);  // converted value can be a string
+    }
+
+    void close_start_tag() {
+        if (!is_start_tag_open_) { return; }
+        put('>');
+        is_start_tag_open_ = false;
+    }
+
+    // Sections and comments start on new lines, unless they are mixed with text
+    void new_item_line() {
+        if (!levels_.empty()) {
+            if (levels_.back().has_text) { return; }
+            levels_.back().has_sections = true;
+        }
+        new_line(levels_.size());
+    }
+
+    void new_line(size_t level) {
+        if (!indent_ || is_empty_) { return; }
+        static const std::string_view spaces = "                                ";
+        put('\n');
+        for (size_t n = level * indent_; n > 0;) {
+            const size_t count = std::min(n, spaces.size());
+            put(spaces.substr(0, count));
+            n -= count;
+        }
+    }
+};
+
+}  // namespace util
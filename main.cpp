@@ -2,9 +2,23 @@
 
 #include "tests.h"
 
+#include <cstdlib>
+#include <new>
+
 /*static*/ std::int64_t T::cnt = 0;
 /*static*/ std::int64_t T::inst_cnt = 0;
 /*static*/ std::int64_t T::comp_cnt = 0;
+/*static*/ std::atomic<std::int64_t> new_counter::cnt{0};
+/*static*/ std::atomic<std::int64_t> new_counter::fail_at{-1};
+
+void* operator new(size_t size) {
+    if (++new_counter::cnt == new_counter::fail_at) { throw std::bad_alloc(); }
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) NOEXCEPT { std::free(p); }
+void operator delete(void* p, size_t) NOEXCEPT { std::free(p); }
 
 void dump_and_destroy_global_pools() {
     for (auto item = util::pool_base::global_pool_list(); item; item = item->next) {
@@ -60,6 +74,8 @@ std::pair<std::pair<size_t, void (*)()>*, size_t> get_string_tests();
 std::pair<std::pair<size_t, void (*)()>*, size_t> get_vector_tests();
 std::pair<std::pair<size_t, void (*)()>*, size_t> get_list_tests();
 std::pair<std::pair<size_t, void (*)()>*, size_t> get_rbtree_tests();
+std::pair<std::pair<size_t, void (*)()>*, size_t> get_hashtbl_tests();
+std::pair<std::pair<size_t, void (*)()>*, size_t> get_xml_tests();
 
 int main(int argc, char* argv[]) {
 #if _ITERATOR_DEBUG_LEVEL != 0
@@ -76,6 +92,10 @@ int main(int argc, char* argv[]) {
     if (perform_tests(get_list_tests()) != 0) { return -1; }
     std::cout << std::endl << "--------------- Red-black tree tests ---------------" << std::endl;
     if (perform_tests(get_rbtree_tests()) != 0) { return -1; }
+    std::cout << std::endl << "--------------- Hash table tests ---------------" << std::endl;
+    if (perform_tests(get_hashtbl_tests()) != 0) { return -1; }
+    std::cout << std::endl << "--------------- XML parser tests ---------------" << std::endl;
+    if (perform_tests(get_xml_tests()) != 0) { return -1; }
 
     std::cout << std::endl;
     std::cout << "T::cnt = " << T::cnt << std::endl;
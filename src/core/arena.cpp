@@ -0,0 +1,52 @@
+#include "core/arena.h"
+
+#include <new>
+
+using namespace util;
+
+//---------------------------------------------------------------------------------
+// Arena allocator implementation
+
+void arena::clear() {
+    if (!head_) { return; }
+    auto block = head_->next;
+    while (block) {
+        auto next = block->next;
+        allocated_size_ -= block->size;
+        ::operator delete(block);
+        block = next;
+    }
+    head_->next = nullptr;
+    cur_ = head_->data(), end_ = cur_ + head_->size;
+}
+
+void arena::release() {
+    auto block = head_;
+    while (block) {
+        auto next = block->next;
+        ::operator delete(block);
+        block = next;
+    }
+    allocated_size_ = 0, head_ = nullptr;
+    cur_ = end_ = nullptr;
+}
+
+void* arena::allocate_slow(size_t size, size_t alignment) {
+    const size_t block_size = size + alignment;
+    if (head_ && block_size > block_size_ / 4) {
+        // dedicated block: keep on using the current one
+        auto block = static_cast<block_hdr_t*>(::operator new(sizeof(block_hdr_t) + block_size));
+        block->size = block_size;
+        block->next = head_->next, head_->next = block;
+        allocated_size_ += block_size;
+        auto p = reinterpret_cast<uintptr_t>(block->data());
+        return reinterpret_cast<void*>((p + alignment - 1) & ~(alignment - 1));
+    }
+    auto block_sz = std::max(block_size, block_size_);
+    auto block = static_cast<block_hdr_t*>(::operator new(sizeof(block_hdr_t) + block_sz));
+    block->size = block_sz;
+    block->next = head_, head_ = block;
+    allocated_size_ += block_sz;
+    cur_ = block->data(), end_ = cur_ + block_sz;
+    return allocate(size, alignment);
+}
@@ -0,0 +1,248 @@
+#include "core/rope.h"
+
+#include <cstring>
+#include <new>
+
+using namespace util;
+
+//---------------------------------------------------------------------------------
+// Rope implementation
+
+const size_t rope::npos;
+
+rope& rope::append(rope&& other) {
+    if (&other == this) { return append(rope(other)); }
+    root_ = join(root_, other.root_);
+    other.root_ = nullptr;
+    return *this;
+}
+
+rope& rope::insert(size_t pos, std::string_view s) {
+    assert(pos <= size());
+    if (s.empty()) { return *this; }
+
+    if (root_) {
+        // fast path: the text fits into the chunk at the insertion point
+        node_t* node = root_;
+        size_t offset = pos;
+        while (true) {
+            const size_t left_size = subtree_size(node->left);
+            if (offset < left_size) {
+                node = node->left;
+                continue;
+            }
+            offset -= left_size;
+            if (offset <= node->len) { break; }
+            offset -= node->len, node = node->right;
+        }
+        if (node->len + s.size() <= kChunkSize) {
+            char* p = node->data() + offset;
+            std::memmove(p + s.size(), p, node->len - offset);
+            std::memcpy(p, s.data(), s.size());
+            node->len += s.size();
+            for (; node; node = node->parent) { node->size += s.size(); }
+            return *this;
+        }
+    }
+
+    node_t* middle = build(s);  // allocate before the tree is split
+    std::pair<node_t*, node_t*> parts;
+    try {
+        parts = split(root_, pos);
+    } catch (...) {
+        free_tree(middle);
+        throw;
+    }
+    root_ = join(join(parts.first, middle), parts.second);
+    return *this;
+}
+
+rope& rope::erase(size_t pos, size_t n) {
+    assert(pos <= size());
+    n = std::min(n, size() - pos);
+    if (!n) { return *this; }
+
+    size_t offset = pos;
+    node_t* node = const_cast<node_t*>(find_node(offset));
+    if (n < node->len && offset + n <= node->len) {
+        // fast path: erasing within one chunk which does not become empty
+        char* p = node->data() + offset;
+        std::memmove(p, p + n, node->len - offset - n);
+        node->len -= n;
+        for (; node; node = node->parent) { node->size -= n; }
+        return *this;
+    }
+
+    auto parts = split(root_, pos);
+    std::pair<node_t*, node_t*> tail;
+    try {
+        tail = split(parts.second, n);
+    } catch (...) {
+        root_ = join(parts.first, parts.second);
+        throw;
+    }
+    free_tree(tail.first);
+    root_ = join(parts.first, tail.second);
+    return *this;
+}
+
+rope rope::split_off(size_t pos) {
+    assert(pos <= size());
+    auto parts = split(root_, pos);
+    root_ = parts.first;
+    rope result;
+    result.root_ = parts.second;
+    return result;
+}
+
+size_t rope::find(std::string_view s, size_t pos) const {
+    if (pos > size()) { return npos; }
+    if (s.empty()) { return pos; }
+    std::string carry;  // last `s.size() - 1` characters before current piece
+    size_t offset = pos;
+    for (std::string_view piece : pieces(pos)) {
+        if (!carry.empty()) {
+            std::string window = carry;
+            window.append(piece.data(), std::min(piece.size(), s.size() - 1));
+            const size_t n = window.find(s.data(), 0, s.size());
+            if (n != std::string::npos) { return offset - carry.size() + n; }
+        }
+        const size_t n = piece.find(s);
+        if (n != std::string_view::npos) { return offset + n; }
+        carry.append(piece.data(), piece.size());
+        if (carry.size() >= s.size()) { carry.erase(0, carry.size() - s.size() + 1); }
+        offset += piece.size();
+    }
+    return npos;
+}
+
+size_t rope::find(char ch, size_t pos) const {
+    size_t offset = pos;
+    for (std::string_view piece : pieces(pos)) {
+        const size_t n = piece.find(ch);
+        if (n != std::string_view::npos) { return offset + n; }
+        offset += piece.size();
+    }
+    return npos;
+}
+
+int rope::compare(std::string_view s) const NOEXCEPT {
+    size_t offset = 0;
+    for (std::string_view piece : pieces()) {
+        const size_t n = std::min(piece.size(), s.size() - offset);
+        const int result = piece.substr(0, n).compare(s.substr(offset, n));
+        if (result != 0) { return result; }
+        if (n < piece.size()) { return 1; }
+        offset += n;
+    }
+    return offset < s.size() ? -1 : 0;
+}
+
+rope::node_t* rope::new_node(const char* s, size_t len) {
+    assert(len && len <= kChunkSize);
+    seed_ ^= seed_ << 13, seed_ ^= seed_ >> 17, seed_ ^= seed_ << 5;
+    auto node = static_cast<node_t*>(::operator new(sizeof(node_t) + kChunkSize));
+    node->left = node->right = node->parent = nullptr;
+    node->priority = seed_;
+    node->size = node->len = len;
+    std::memcpy(node->data(), s, len);
+    return node;
+}
+
+void rope::free_tree(node_t* node) NOEXCEPT {
+    while (node) {
+        free_tree(node->left);
+        auto right = node->right;
+        ::operator delete(node);
+        node = right;
+    }
+}
+
+void rope::update(node_t* node) NOEXCEPT {
+    node->size = node->len;
+    if (node->left) { node->size += node->left->size, node->left->parent = node; }
+    if (node->right) { node->size += node->right->size, node->right->parent = node; }
+}
+
+rope::node_t* rope::merge(node_t* l, node_t* r) NOEXCEPT {
+    if (!l) { return r; }
+    if (!r) { return l; }
+    if (l->priority > r->priority) {
+        l->right = merge(l->right, r);
+        update(l);
+        l->parent = nullptr;
+        return l;
+    }
+    r->left = merge(l, r->left);
+    update(r);
+    r->parent = nullptr;
+    return r;
+}
+
+std::pair<rope::node_t*, rope::node_t*> rope::split(node_t* node, size_t pos) {
+    if (!node) { return {nullptr, nullptr}; }
+    const size_t left_size = subtree_size(node->left);
+    if (pos <= left_size) {
+        auto parts = split(node->left, pos);
+        node->left = parts.second;
+        update(node);
+        node->parent = nullptr;
+        return {parts.first, node};
+    }
+    if (pos >= left_size + node->len) {
+        auto parts = split(node->right, pos - left_size - node->len);
+        node->right = parts.first;
+        update(node);
+        node->parent = nullptr;
+        return {node, parts.second};
+    }
+
+    // split the chunk itself
+    const size_t offset = pos - left_size;
+    node_t* tail = new_node(node->data() + offset, node->len - offset);
+    node_t* right = node->right;
+    if (right) { right->parent = nullptr; }
+    node->len = offset, node->right = nullptr;
+    update(node);
+    node->parent = nullptr;
+    return {node, merge(tail, right)};
+}
+
+rope::node_t* rope::join(node_t* l, node_t* r) NOEXCEPT {
+    if (!l || !r) { return merge(l, r); }
+
+    // coalesce adjacent chunks if they fit into one
+    node_t* last = l;
+    while (last->right) { last = last->right; }
+    node_t* first = r;
+    while (first->left) { first = first->left; }
+    if (last->len + first->len <= kChunkSize) {
+        const size_t len = first->len;
+        std::memcpy(last->data() + last->len, first->data(), len);
+        last->len += len;
+        for (; last; last = last->parent) { last->size += len; }
+        if (first->right) { first->right->parent = first->parent; }
+        if (first->parent) {
+            first->parent->left = first->right;
+            for (auto node = first->parent; node; node = node->parent) { node->size -= len; }
+        } else {
+            r = first->right;
+        }
+        ::operator delete(first);
+    }
+
+    return merge(l, r);
+}
+
+rope::node_t* rope::build(std::string_view s) {
+    node_t* result = nullptr;
+    try {
+        for (size_t pos = 0; pos < s.size(); pos += kChunkSize) {
+            result = merge(result, new_node(s.data() + pos, std::min<size_t>(kChunkSize, s.size() - pos)));
+        }
+    } catch (...) {
+        free_tree(result);
+        throw;
+    }
+    return result;
+}
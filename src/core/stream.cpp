@@ -0,0 +1,116 @@
+#include "core/stream.h"
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    include <io.h>
+#    include <windows.h>
+#else   // _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif  // _WIN32
+
+#include <cerrno>
+
+using namespace util;
+
+//---------------------------------------------------------------------------------
+// File descriptor sink implementation
+
+bool fd_sink::flush() {
+    const size_t count = static_cast<size_t>(cur_ - buf_.get());
+    cur_ = buf_.get();
+    return write_all(buf_.get(), count);
+}
+
+void fd_sink::append_slow(const char* s, size_t count) {
+    if (!flush()) { return; }  // output is dropped after an error
+    if (count < static_cast<size_t>(end_ - cur_)) {
+        std::memcpy(cur_, s, count);
+        cur_ += count;
+        return;
+    }
+    write_all(s, count);  // too big to be buffered
+}
+
+bool fd_sink::write_all(const char* s, size_t count) {
+    while (count && good_) {
+#if defined(_WIN32)
+        const auto n = ::_write(fd_, s, static_cast<unsigned>(std::min<size_t>(count, 0x40000000)));
+#else   // _WIN32
+        const auto n = ::write(fd_, s, count);
+#endif  // _WIN32
+        if (n < 0) {
+            if (errno != EINTR) { good_ = false; }
+            continue;
+        }
+        if (n == 0) {  // no progress: retrying would spin forever
+            good_ = false;
+            break;
+        }
+        s += n, count -= static_cast<size_t>(n);
+    }
+    return good_;
+}
+
+//---------------------------------------------------------------------------------
+// Memory-mapped file implementation
+
+static const char g_empty_file_data = '\0';  // empty files are not mapped
+
+bool mapped_file::open(const char* path) {
+    close();
+#if defined(_WIN32)
+    HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+    LARGE_INTEGER file_size;
+    if (!::GetFileSizeEx(file, &file_size)) {
+        ::CloseHandle(file);
+        return false;
+    }
+    if (file_size.QuadPart == 0) {
+        ::CloseHandle(file);
+        data_ = &g_empty_file_data;
+        return true;
+    }
+    HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(file);
+    if (!mapping) { return false; }
+    void* p = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (!p) { return false; }
+    data_ = static_cast<const char*>(p), size_ = static_cast<size_t>(file_size.QuadPart);
+#else   // _WIN32
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) { return false; }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        data_ = &g_empty_file_data;
+        return true;
+    }
+    void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { return false; }
+    ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(p), size_ = static_cast<size_t>(st.st_size);
+#endif  // _WIN32
+    return true;
+}
+
+void mapped_file::close() NOEXCEPT {
+    if (data_ && data_ != &g_empty_file_data) {
+#if defined(_WIN32)
+        ::UnmapViewOfFile(data_);
+#else   // _WIN32
+        ::munmap(const_cast<char*>(data_), size_);
+#endif  // _WIN32
+    }
+    data_ = nullptr, size_ = 0;
+}
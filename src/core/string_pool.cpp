@@ -0,0 +1,33 @@
+#include "core/string_pool.h"
+
+#include <mutex>
+
+using namespace util;
+
+//---------------------------------------------------------------------------------
+// Concurrent string pool implementation
+
+size_t concurrent_string_pool::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return pool_.size();
+}
+
+hashed_string_view concurrent_string_pool::intern(hashed_string_view s) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto found = pool_.find(s);
+        if (found.data()) { return found; }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return pool_.intern(s);
+}
+
+hashed_string_view concurrent_string_pool::find(hashed_string_view s) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return pool_.find(s);
+}
+
+void concurrent_string_pool::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    pool_.clear();
+}
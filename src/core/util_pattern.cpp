@@ -0,0 +1,538 @@
+#include "core/util_pattern.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+using namespace util;
+
+//---------------------------------------------------------------------------------
+// Pattern compiler: parses the pattern into a syntax tree, then emits the program for the forward
+// and the reversed matching
+
+class pattern::compiler {
+ public:
+    using charset = std::array<uint64_t, 4>;
+
+    enum class node_type : uint8_t { kChar = 0, kAny, kClass, kAssertion, kConcat, kAlternation, kRepeat };
+
+    enum : unsigned { kInfinite = ~0u, kMaxRepeatCount = 1000, kMaxDepth = 256 };
+    enum : size_t { kMaxProgramSize = 100000 };
+
+    struct node {
+        explicit node(node_type in_type) : type(in_type) {}
+        node_type type;
+        opcode assertion = opcode::kAssertBegin;
+        unsigned char ch = 0;
+        uint32_t cls = 0;
+        unsigned min = 0;
+        unsigned max = 0;
+        bool is_greedy = true;
+        std::vector<node> children;
+    };
+
+    compiler(std::string_view re, std::vector<charset>& classes) : re_(re), classes_(classes) {}
+
+    node parse() {
+        node root = parse_alternation();
+        if (pos_ != re_.size()) { error("unmatched `)`"); }
+        return root;
+    }
+
+    void compile(const node& root, bool is_reversed, program& prog) {
+        emit(root, is_reversed, prog.code);
+        push(prog.code, instruction{opcode::kMatch, 0, 0, 0});
+        if (!add_first_bytes(root, is_reversed, prog.first_bytes)) {
+            for (unsigned ch = 0; ch < 256; ++ch) {
+                if (!prog.first_bytes[ch]) { continue; }
+                if (prog.first_byte_count < 2) { prog.first_byte_pair[prog.first_byte_count] = static_cast<char>(ch); }
+                ++prog.first_byte_count;
+            }
+            if (prog.first_byte_count == 1) { prog.first_byte_pair[1] = prog.first_byte_pair[0]; }
+        }
+        if (!is_reversed) { prog.prefix = literal_prefix(root); }
+        prog.is_anchored = is_anchored(root, is_reversed ? opcode::kAssertEnd : opcode::kAssertBegin);
+    }
+
+ private:
+    std::string_view re_;
+    size_t pos_ = 0;
+    unsigned depth_ = 0;
+    std::vector<charset>& classes_;
+
+    [[noreturn]] void error(const char* msg) const {
+        throw std::invalid_argument(std::string("invalid pattern: ") + msg);
+    }
+
+    bool is_end() const { return pos_ == re_.size(); }
+    bool is_next(char ch) const { return pos_ < re_.size() && re_[pos_] == ch; }
+
+    static void add_range(charset& set, unsigned lo, unsigned hi) {
+        for (unsigned ch = lo; ch <= hi; ++ch) { set[ch >> 6] |= uint64_t(1) << (ch & 63); }
+    }
+
+    node make_class(const charset& set) {
+        node n(node_type::kClass);
+        n.cls = static_cast<uint32_t>(classes_.size());
+        classes_.push_back(set);
+        return n;
+    }
+
+    node parse_alternation() {
+        node alt(node_type::kAlternation);
+        alt.children.push_back(parse_concat());
+        while (is_next('|')) {
+            ++pos_;
+            alt.children.push_back(parse_concat());
+        }
+        if (alt.children.size() == 1) { return std::move(alt.children[0]); }
+        return alt;
+    }
+
+    node parse_concat() {
+        node cat(node_type::kConcat);
+        while (!is_end() && re_[pos_] != '|' && re_[pos_] != ')') { cat.children.push_back(parse_repeat()); }
+        return cat;
+    }
+
+    unsigned parse_count() {
+        unsigned count = 0;
+        const size_t from = pos_;
+        for (; !is_end() && re_[pos_] >= '0' && re_[pos_] <= '9'; ++pos_) {
+            count = 10 * count + re_[pos_] - '0';
+            if (count > kMaxRepeatCount) { error("too large repetition count"); }
+        }
+        if (pos_ == from) { error("invalid repetition count"); }
+        return count;
+    }
+
+    node parse_repeat() {
+        node atom = parse_atom();
+        if (is_end()) { return atom; }
+        unsigned min = 0, max = kInfinite;
+        switch (re_[pos_]) {
+            case '*': break;
+            case '+': min = 1; break;
+            case '?': max = 1; break;
+            case '{': {
+                ++pos_;
+                max = min = parse_count();
+                if (is_next(',')) {
+                    ++pos_;
+                    max = is_next('}') ? kInfinite : parse_count();
+                }
+                if (!is_next('}')) { error("missing `}`"); }
+                if (max < min) { error("invalid repetition range"); }
+            } break;
+            default: return atom;
+        }
+        ++pos_;
+        if (atom.type == node_type::kAssertion) { error("nothing to repeat"); }
+        node rep(node_type::kRepeat);
+        rep.min = min, rep.max = max;
+        if (is_next('?')) { rep.is_greedy = false, ++pos_; }
+        if (!is_end() && std::string_view("*+?{").find(re_[pos_]) != std::string_view::npos) {
+            error("nothing to repeat");
+        }
+        rep.children.push_back(std::move(atom));
+        return rep;
+    }
+
+    node parse_atom() {
+        const char ch = re_[pos_++];
+        switch (ch) {
+            case '(': {
+                if (++depth_ > kMaxDepth) { error("too deep nesting"); }
+                if (is_next('?')) {
+                    if (re_.substr(pos_, 2) != "?:") { error("unsupported group"); }
+                    pos_ += 2;
+                }
+                node n = parse_alternation();
+                if (!is_next(')')) { error("missing `)`"); }
+                ++pos_, --depth_;
+                return n;
+            }
+            case '[': return parse_class();
+            case '.': return node(node_type::kAny);
+            case '^':
+            case '$': {
+                node n(node_type::kAssertion);
+                n.assertion = ch == '^' ? opcode::kAssertBegin : opcode::kAssertEnd;
+                return n;
+            }
+            case '\\': {
+                if (is_end()) { error("trailing `\\`"); }
+                const char escaped = re_[pos_++];
+                if (escaped == 'b' || escaped == 'B') {
+                    node n(node_type::kAssertion);
+                    n.assertion = escaped == 'b' ? opcode::kAssertWordBoundary : opcode::kAssertNotWordBoundary;
+                    return n;
+                }
+                charset set{};
+                if (add_class_escape(escaped, set)) { return make_class(set); }
+                node n(node_type::kChar);
+                n.ch = parse_escaped_char(escaped);
+                return n;
+            }
+            case '*':
+            case '+':
+            case '?':
+            case '{': error("nothing to repeat");
+            default: {
+                node n(node_type::kChar);
+                n.ch = static_cast<unsigned char>(ch);
+                return n;
+            }
+        }
+    }
+
+    // Adds `\d`, `\w`, `\s` and negated sets
+    static bool add_class_escape(char escaped, charset& set) {
+        charset cls{};
+        switch (escaped) {
+            case 'd':
+            case 'D': add_range(cls, '0', '9'); break;
+            case 'w':
+            case 'W': {
+                add_range(cls, '0', '9'), add_range(cls, 'A', 'Z'), add_range(cls, 'a', 'z');
+                add_range(cls, '_', '_');
+            } break;
+            case 's':
+            case 'S': add_range(cls, '\t', '\r'), add_range(cls, ' ', ' '); break;
+            default: return false;
+        }
+        const uint64_t inv = escaped >= 'a' ? 0 : ~uint64_t(0);
+        for (size_t i = 0; i < cls.size(); ++i) { set[i] |= cls[i] ^ inv; }
+        return true;
+    }
+
+    unsigned char parse_escaped_char(char escaped) {
+        switch (escaped) {
+            case 'n': return '\n';
+            case 'r': return '\r';
+            case 't': return '\t';
+            case 'f': return '\f';
+            case 'v': return '\v';
+            case '0': return '\0';
+            case 'x': {
+                bool ok = false;
+                const unsigned code = re_.size() - pos_ >= 2 ? from_hex(re_.begin() + pos_, 2, &ok) : 0;
+                if (!ok) { error("invalid `\\x` escape"); }
+                pos_ += 2;
+                return static_cast<unsigned char>(code);
+            }
+            default: {
+                // backreferences and other letter escapes are not supported
+                if (std::isalnum(static_cast<unsigned char>(escaped))) { error("unsupported escape"); }
+                return static_cast<unsigned char>(escaped);
+            }
+        }
+    }
+
+    // Parses a character of a class, returns `false` if it is a set escape added to `set`
+    bool parse_class_char(charset& set, unsigned char& ch) {
+        if (is_end()) { error("missing `]`"); }
+        ch = static_cast<unsigned char>(re_[pos_++]);
+        if (ch != '\\') { return true; }
+        if (is_end()) { error("trailing `\\`"); }
+        const char escaped = re_[pos_++];
+        if (add_class_escape(escaped, set)) { return false; }
+        ch = escaped == 'b' ? '\b' : parse_escaped_char(escaped);
+        return true;
+    }
+
+    node parse_class() {
+        charset set{};
+        const bool is_negated = is_next('^');
+        if (is_negated) { ++pos_; }
+        while (!is_next(']')) {
+            unsigned char lo = 0, hi = 0;
+            if (!parse_class_char(set, lo)) { continue; }
+            if (pos_ + 1 < re_.size() && re_[pos_] == '-' && re_[pos_ + 1] != ']') {
+                ++pos_;
+                if (!parse_class_char(set, hi) || hi < lo) { error("invalid range"); }
+            } else {
+                hi = lo;
+            }
+            add_range(set, lo, hi);
+        }
+        ++pos_;
+        if (is_negated) {
+            for (auto& bits : set) { bits = ~bits; }
+        }
+        return make_class(set);
+    }
+
+    void push(std::vector<instruction>& code, const instruction& in) {
+        if (code.size() >= kMaxProgramSize) { error("too large pattern"); }
+        code.push_back(in);
+    }
+
+    void emit(const node& n, bool is_reversed, std::vector<instruction>& code) {
+        const auto pc = [&code]() { return static_cast<uint32_t>(code.size()); };
+        switch (n.type) {
+            case node_type::kChar: push(code, instruction{opcode::kChar, n.ch, 0, 0}); break;
+            case node_type::kAny: push(code, instruction{opcode::kAny, 0, 0, 0}); break;
+            case node_type::kClass: push(code, instruction{opcode::kClass, 0, n.cls, 0}); break;
+            case node_type::kAssertion: push(code, instruction{n.assertion, 0, 0, 0}); break;
+            case node_type::kConcat: {
+                if (is_reversed) {
+                    for (auto it = n.children.rbegin(); it != n.children.rend(); ++it) { emit(*it, true, code); }
+                } else {
+                    for (const auto& child : n.children) { emit(child, false, code); }
+                }
+            } break;
+            case node_type::kAlternation: {
+                // split L1, L2; L1: e1; jump L; L2: split ... Ln: en; L:
+                std::vector<uint32_t> jumps;
+                for (size_t i = 0; i + 1 < n.children.size(); ++i) {
+                    const uint32_t split = pc();
+                    push(code, instruction{opcode::kSplit, 0, split + 1, 0});
+                    emit(n.children[i], is_reversed, code);
+                    jumps.push_back(pc());
+                    push(code, instruction{opcode::kJump, 0, 0, 0});
+                    code[split].y = pc();
+                }
+                emit(n.children.back(), is_reversed, code);
+                for (uint32_t jump : jumps) { code[jump].x = pc(); }
+            } break;
+            case node_type::kRepeat: {
+                const node& body = n.children[0];
+                const unsigned count = n.max == kInfinite && n.min > 0 ? n.min - 1 : n.min;
+                for (unsigned i = 0; i < count; ++i) { emit(body, is_reversed, code); }
+                const auto make_split = [&n](uint32_t x, uint32_t y) {
+                    return n.is_greedy ? instruction{opcode::kSplit, 0, x, y} : instruction{opcode::kSplit, 0, y, x};
+                };
+                if (n.max == kInfinite) {
+                    const uint32_t loop = pc();
+                    if (n.min > 0) {  // loop: e; split loop, L; L:
+                        emit(body, is_reversed, code);
+                        push(code, make_split(loop, pc() + 1));
+                    } else {  // loop: split L1, L; L1: e; jump loop; L:
+                        push(code, instruction{});
+                        emit(body, is_reversed, code);
+                        push(code, instruction{opcode::kJump, 0, loop, 0});
+                        code[loop] = make_split(loop + 1, pc());
+                    }
+                } else {  // split L1, L; L1: e; split L2, L; L2: e; ... L:
+                    std::vector<uint32_t> splits;
+                    for (unsigned i = n.min; i < n.max; ++i) {
+                        splits.push_back(pc());
+                        push(code, instruction{});
+                        emit(body, is_reversed, code);
+                    }
+                    for (uint32_t split : splits) { code[split] = make_split(split + 1, pc()); }
+                }
+            } break;
+        }
+    }
+
+    // Adds bytes the node can start with, returns `true` if the node can match empty string
+    bool add_first_bytes(const node& n, bool is_reversed, std::array<bool, 256>& bytes) const {
+        switch (n.type) {
+            case node_type::kChar: bytes[n.ch] = true; return false;
+            case node_type::kAny: {
+                for (unsigned ch = 0; ch < 256; ++ch) { bytes[ch] = bytes[ch] || (ch != '\n' && ch != '\r'); }
+                return false;
+            }
+            case node_type::kClass: {
+                const charset& set = classes_[n.cls];
+                for (unsigned ch = 0; ch < 256; ++ch) { bytes[ch] = bytes[ch] || ((set[ch >> 6] >> (ch & 63)) & 1); }
+                return false;
+            }
+            case node_type::kAssertion: return true;
+            case node_type::kConcat: {
+                for (size_t i = 0; i < n.children.size(); ++i) {
+                    const node& child = n.children[is_reversed ? n.children.size() - i - 1 : i];
+                    if (!add_first_bytes(child, is_reversed, bytes)) { return false; }
+                }
+                return true;
+            }
+            case node_type::kAlternation: {
+                bool can_be_empty = false;
+                for (const auto& child : n.children) { can_be_empty |= add_first_bytes(child, is_reversed, bytes); }
+                return can_be_empty;
+            }
+            case node_type::kRepeat: return add_first_bytes(n.children[0], is_reversed, bytes) || n.min == 0;
+        }
+        return true;
+    }
+
+    static std::string literal_prefix(const node& n) {
+        if (n.type == node_type::kChar) { return std::string(1, static_cast<char>(n.ch)); }
+        std::string prefix;
+        if (n.type == node_type::kConcat) {
+            for (const auto& child : n.children) {
+                if (child.type != node_type::kChar) { break; }
+                prefix += static_cast<char>(child.ch);
+            }
+        }
+        return prefix;
+    }
+
+    static bool is_anchored(const node& n, opcode anchor) {
+        switch (n.type) {
+            case node_type::kAssertion: return n.assertion == anchor;
+            case node_type::kConcat: {
+                if (n.children.empty()) { return false; }
+                return is_anchored(anchor == opcode::kAssertBegin ? n.children.front() : n.children.back(), anchor);
+            }
+            case node_type::kAlternation: {
+                return std::all_of(n.children.begin(), n.children.end(),
+                                   [anchor](const node& child) { return is_anchored(child, anchor); });
+            }
+            default: return false;
+        }
+    }
+};
+
+pattern::pattern(std::string_view re) {
+    compiler comp(re, classes_);
+    const compiler::node root = comp.parse();
+    comp.compile(root, false, forward_);
+    comp.compile(root, true, reversed_);
+}
+
+//---------------------------------------------------------------------------------
+// Pike VM: all threads advance over the input in lock step, a thread is a program counter and the position
+// where the match started; threads are kept in priority order, so when a thread matches, threads of lower
+// priority are dropped, and threads reaching the same instruction at the same position are merged
+
+namespace {
+
+struct vm_thread {
+    uint32_t pc;
+    const char* start;
+};
+
+struct vm_state {
+    std::vector<vm_thread> current;
+    std::vector<vm_thread> next;
+    std::vector<uint32_t> stack;
+    std::vector<uint32_t> marks;  // generation when the instruction was reached last time
+    uint32_t generation = 0;
+
+    void next_generation() {
+        if (++generation != 0) { return; }
+        std::fill(marks.begin(), marks.end(), 0);
+        generation = 1;
+    }
+};
+
+thread_local vm_state g_vm;
+
+bool is_word_char(char ch) {
+    return (ch >= '0' && ch <= '9') || (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || ch == '_';
+}
+
+}  // namespace
+
+template<bool Reversed>
+bool pattern::run(const program& prog, const char* first, const char* last, bool whole,
+                  std::pair<const char*, const char*>& m) const {
+    vm_state& vm = g_vm;
+    const instruction* code = prog.code.data();
+    if (vm.marks.size() < prog.code.size()) { vm.marks.resize(prog.code.size(), 0); }
+
+    // Adds the thread and threads reachable from it by empty transitions in priority order
+    const auto add_thread = [&vm, code, first, last](std::vector<vm_thread>& list, uint32_t pc, const char* start,
+                                                      const char* p) {
+        vm.stack.push_back(pc);
+        do {
+            pc = vm.stack.back();
+            vm.stack.pop_back();
+            while (vm.marks[pc] != vm.generation) {
+                vm.marks[pc] = vm.generation;
+                const instruction& in = code[pc];
+                switch (in.op) {
+                    case opcode::kJump: pc = in.x; continue;
+                    case opcode::kSplit: vm.stack.push_back(in.y), pc = in.x; continue;
+                    case opcode::kAssertBegin: {
+                        if (p == first) { ++pc; continue; }
+                    } break;
+                    case opcode::kAssertEnd: {
+                        if (p == last) { ++pc; continue; }
+                    } break;
+                    case opcode::kAssertWordBoundary:
+                    case opcode::kAssertNotWordBoundary: {
+                        const bool is_boundary = (p != first && is_word_char(p[-1])) != (p != last && is_word_char(*p));
+                        if (is_boundary == (in.op == opcode::kAssertWordBoundary)) { ++pc; continue; }
+                    } break;
+                    default: list.push_back(vm_thread{pc, start}); break;
+                }
+                break;
+            }
+        } while (!vm.stack.empty());
+    };
+
+    // Skips positions where a match can't start
+    const auto skip = [&prog, first, last](const char* p) {
+        if (Reversed) {
+            while (p != first && !prog.first_bytes[static_cast<unsigned char>(p[-1])]) { --p; }
+        } else if (prog.prefix.size() > 1) {
+            p = impl::find_substring(p, last, prog.prefix.data(), prog.prefix.size());
+        } else if (prog.first_byte_count <= 2) {
+            p = impl::find_first_of2(p, last, prog.first_byte_pair[0], prog.first_byte_pair[1]);
+        } else {
+            while (p != last && !prog.first_bytes[static_cast<unsigned char>(*p)]) { ++p; }
+        }
+        return p;
+    };
+
+    const char* const origin = Reversed ? last : first;
+    const char* const stop = Reversed ? first : last;
+    const bool is_anchored = whole || prog.is_anchored;
+    bool is_matched = false;
+    vm.current.clear();
+    vm.next_generation();
+    for (const char* p = origin;;) {
+        if (!is_matched && (p == origin || !is_anchored)) {
+            if (vm.current.empty() && prog.first_byte_count && !is_anchored) {
+                if (p != stop) { p = skip(p); }
+                if (p == stop) { break; }  // a match can't be empty
+            }
+            add_thread(vm.current, 0, p, p);
+        }
+        if (vm.current.empty() && (is_matched || is_anchored)) { break; }
+
+        const bool is_stop = p == stop;
+        const unsigned char ch = is_stop ? 0 : static_cast<unsigned char>(Reversed ? p[-1] : *p);
+        const char* const p_next = is_stop ? p : (Reversed ? p - 1 : p + 1);
+        vm.next.clear();
+        vm.next_generation();
+        for (const vm_thread& thread : vm.current) {
+            const instruction& in = code[thread.pc];
+            bool is_passed = false;
+            switch (in.op) {
+                case opcode::kChar: is_passed = ch == in.ch; break;
+                case opcode::kAny: is_passed = ch != '\n' && ch != '\r'; break;
+                case opcode::kClass: is_passed = in_class(in.x, ch); break;
+                default: break;
+            }
+            if (in.op == opcode::kMatch) {
+                if (whole && !is_stop) { continue; }
+                is_matched = true;
+                m = Reversed ? std::make_pair(p, thread.start) : std::make_pair(thread.start, p);
+                break;  // drop threads of lower priority
+            }
+            if (is_passed && !is_stop) { add_thread(vm.next, thread.pc + 1, thread.start, p_next); }
+        }
+        if (is_stop) { break; }
+        std::swap(vm.current, vm.next);
+        p = p_next;
+    }
+    return is_matched;
+}
+
+bool pattern::search(const char* first, const char* last, std::pair<const char*, const char*>& m) const {
+    return run<false>(forward_, first, last, false, m);
+}
+
+bool pattern::reversed_search(const char* first, const char* last, std::pair<const char*, const char*>& m) const {
+    return run<true>(reversed_, first, last, false, m);
+}
+
+bool pattern::match(std::string_view s) const {
+    std::pair<const char*, const char*> m;
+    return run<false>(forward_, s.data(), s.data() + s.size(), true, m);
+}
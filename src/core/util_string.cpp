@@ -2,24 +2,269 @@
 
 #include <array>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 using namespace util;
 
+//---------------------------------------------------------------------------------
+// UTF validation and transcoding
+
+namespace {
+
+// Skips ASCII characters
+const char* skip_ascii(const char* p, const char* end) NOEXCEPT {
+#ifdef USE_SSE2
+    for (; end - p >= 16; p += 16) {
+        const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        if (mask) { return p + count_trailing_zeros(static_cast<uint32_t>(mask)); }
+    }
+#else   // USE_SSE2
+    for (; end - p >= 8; p += 8) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if (v & 0x8080808080808080ull) { break; }
+    }
+#endif  // USE_SSE2
+    while ((p < end) && !(*p & 0x80)) { ++p; }
+    return p;
+}
+
+// Copies ASCII characters widening them to output units
+template<typename CharT>
+void copy_ascii(const char*& p, const char* end, CharT*& out) NOEXCEPT {
+#ifdef USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16, out += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        if (_mm_movemask_epi8(v)) { break; }
+        const __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+        if (sizeof(CharT) == 2) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), hi);
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#endif  // USE_SSE2
+    for (; (p < end) && !(*p & 0x80); ++p) { *out++ = static_cast<CharT>(*p); }
+}
+
+// Decodes non-ASCII UTF-8 sequence, returns `nullptr` if it is ill-formed
+const char* decode_utf8_seq(const char* p, const char* end, uint32_t& code) NOEXCEPT {
+    const auto c = static_cast<uint8_t>(*p);
+    if (c < 0xC2) { return nullptr; }  // continuation byte or overlong 2-byte sequence
+    const auto b1 = end - p > 1 ? static_cast<uint8_t>(p[1]) : 0;
+    if ((b1 & 0xC0) != 0x80) { return nullptr; }
+    if (c < 0xE0) {
+        code = ((c & 0x1F) << 6) | (b1 & 0x3F);
+        return p + 2;
+    }
+    const auto b2 = end - p > 2 ? static_cast<uint8_t>(p[2]) : 0;
+    if ((b2 & 0xC0) != 0x80) { return nullptr; }
+    if (c < 0xF0) {
+        if ((c == 0xE0 && b1 < 0xA0) || (c == 0xED && b1 >= 0xA0)) { return nullptr; }  // overlong or surrogate
+        code = ((c & 0xF) << 12) | ((b1 & 0x3F) << 6) | (b2 & 0x3F);
+        return p + 3;
+    }
+    const auto b3 = end - p > 3 ? static_cast<uint8_t>(p[3]) : 0;
+    if ((b3 & 0xC0) != 0x80 || c > 0xF4) { return nullptr; }
+    if ((c == 0xF0 && b1 < 0x90) || (c == 0xF4 && b1 >= 0x90)) { return nullptr; }  // overlong or > 0x10FFFF
+    code = ((c & 0x7) << 18) | ((b1 & 0x3F) << 12) | ((b2 & 0x3F) << 6) | (b3 & 0x3F);
+    return p + 4;
+}
+
+char* encode_utf8(uint32_t code, char* out) NOEXCEPT {
+    if (code < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (code >> 6));
+        out[1] = static_cast<char>(0x80 | (code & 0x3F));
+        return out + 2;
+    } else if (code < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (code >> 12));
+        out[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (code & 0x3F));
+        return out + 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (code >> 18));
+    out[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (code & 0x3F));
+    return out + 4;
+}
+
+template<typename CharT>
+utf_result utf8_to_utf16_impl(std::string_view s, CharT* out) NOEXCEPT {
+    const char *p = s.data(), *end = p + s.size();
+    CharT* const out0 = out;
+    while (p < end) {
+        copy_ascii(p, end, out);
+        if (p == end) { break; }
+        do {  // decode non-ASCII characters till the next ASCII one
+            uint32_t code = 0;
+            const char* next = decode_utf8_seq(p, end, code);
+            if (!next) { return utf_result{false, static_cast<size_t>(p - s.data()), static_cast<size_t>(out - out0)}; }
+            if (code >= 0x10000) {
+                code -= 0x10000;
+                *out++ = static_cast<CharT>(0xD800 | (code >> 10));
+                *out++ = static_cast<CharT>(0xDC00 | (code & 0x3FF));
+            } else {
+                *out++ = static_cast<CharT>(code);
+            }
+            p = next;
+        } while ((p < end) && (*p & 0x80));
+    }
+    return utf_result{true, s.size(), static_cast<size_t>(out - out0)};
+}
+
+template<typename CharT>
+utf_result utf8_to_utf32_impl(std::string_view s, CharT* out) NOEXCEPT {
+    const char *p = s.data(), *end = p + s.size();
+    CharT* const out0 = out;
+    while (p < end) {
+        copy_ascii(p, end, out);
+        if (p == end) { break; }
+        do {  // decode non-ASCII characters till the next ASCII one
+            uint32_t code = 0;
+            const char* next = decode_utf8_seq(p, end, code);
+            if (!next) { return utf_result{false, static_cast<size_t>(p - s.data()), static_cast<size_t>(out - out0)}; }
+            *out++ = static_cast<CharT>(code);
+            p = next;
+        } while ((p < end) && (*p & 0x80));
+    }
+    return utf_result{true, s.size(), static_cast<size_t>(out - out0)};
+}
+
+// 4-byte units are accepted too: units above 0xFFFF are taken as whole code points
+template<typename CharT>
+utf_result utf16_to_utf8_impl(const CharT* first, size_t size, char* out) NOEXCEPT {
+    const CharT *p = first, *end = p + size;
+    char* const out0 = out;
+    while (p < end) {
+#ifdef USE_SSE2
+        const __m128i zero = _mm_setzero_si128(), non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+        for (; sizeof(CharT) == 2 && end - p >= 8; p += 8, out += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, non_ascii), zero)) != 0xFFFF) { break; }
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(v, v));
+        }
+        if (p == end) { break; }
+#endif  // USE_SSE2
+        auto code = static_cast<uint32_t>(*p);
+        if (code < 0x80) {
+            *out++ = static_cast<char>(code), ++p;
+            continue;
+        }
+        if ((code & 0xFFFFF800) == 0xD800) {
+            if ((code & 0xDC00) != 0xD800 || end - p < 2 || (static_cast<uint32_t>(p[1]) & 0xFFFFFC00) != 0xDC00) {
+                return utf_result{false, static_cast<size_t>(p - first), static_cast<size_t>(out - out0)};
+            }
+            code = 0x10000 + (((code & 0x3FF) << 10) | (static_cast<uint32_t>(p[1]) & 0x3FF));
+            ++p;
+        } else if (code > 0x10FFFF) {
+            return utf_result{false, static_cast<size_t>(p - first), static_cast<size_t>(out - out0)};
+        }
+        out = encode_utf8(code, out), ++p;
+    }
+    return utf_result{true, size, static_cast<size_t>(out - out0)};
+}
+
+// Returns the length of UTF-8 encoding of valid UTF-16 string, or its upper bound for invalid one
+template<typename CharT>
+size_t utf16_to_utf8_length(const CharT* p, const CharT* end) NOEXCEPT {
+    size_t len = 0;
+    for (; p < end; ++p) {
+        const auto code = static_cast<uint32_t>(*p);
+        if (code < 0x80) {
+            ++len;
+        } else if (code < 0x800) {
+            len += 2;
+        } else if ((code & 0xFFFFFC00) == 0xD800 && end - p >= 2 &&
+                   (static_cast<uint32_t>(p[1]) & 0xFFFFFC00) == 0xDC00) {
+            len += 4, ++p;
+        } else {
+            len += code < 0x10000 ? 3 : 4;
+        }
+    }
+    return len;
+}
+
+template<typename CharT>
+utf_result utf32_to_utf8_impl(const CharT* first, size_t size, char* out) NOEXCEPT {
+    const CharT *p = first, *end = p + size;
+    char* const out0 = out;
+    for (; p < end; ++p) {
+        const auto code = static_cast<uint32_t>(*p);
+        if (code < 0x80) {
+            *out++ = static_cast<char>(code);
+        } else if (code > 0x10FFFF || (code & 0xFFFFF800) == 0xD800) {
+            return utf_result{false, static_cast<size_t>(p - first), static_cast<size_t>(out - out0)};
+        } else {
+            out = encode_utf8(code, out);
+        }
+    }
+    return utf_result{true, size, static_cast<size_t>(out - out0)};
+}
+
+}  // namespace
+
+size_t util::find_invalid_utf8(std::string_view s) NOEXCEPT {
+    const char *p = s.data(), *end = p + s.size();
+    uint32_t code = 0;
+    while ((p = skip_ascii(p, end)) != end) {
+        const char* next = decode_utf8_seq(p, end, code);
+        if (!next) { return p - s.data(); }
+        p = next;
+    }
+    return s.size();
+}
+
+size_t util::find_invalid_utf16(std::u16string_view s) NOEXCEPT {
+    for (auto p = s.begin(); p != s.end(); ++p) {
+        if ((*p & 0xF800) != 0xD800) { continue; }
+        if ((*p & 0xDC00) != 0xD800 || s.end() - p < 2 || (p[1] & 0xFC00) != 0xDC00) { return p - s.begin(); }
+        ++p;
+    }
+    return s.size();
+}
+
+utf_result util::utf8_to_utf16(std::string_view s, char16_t* out) NOEXCEPT { return utf8_to_utf16_impl(s, out); }
+utf_result util::utf8_to_utf32(std::string_view s, char32_t* out) NOEXCEPT { return utf8_to_utf32_impl(s, out); }
+
+utf_result util::utf16_to_utf8(std::u16string_view s, char* out) NOEXCEPT {
+    return utf16_to_utf8_impl(s.data(), s.size(), out);
+}
+
+utf_result util::utf32_to_utf8(std::u32string_view s, char* out) NOEXCEPT {
+    return utf32_to_utf8_impl(s.data(), s.size(), out);
+}
+
 std::wstring util::from_utf8_to_wide(std::string_view s) {
-    uint32_t code;
-    std::wstring result;
-    result.reserve(s.size());
-    for (auto p = s.begin(), p1 = p; (p1 = from_utf8(p, s.end(), &code)) > p; p = p1) {
+    std::wstring result(s.size(), L'\0');
+    const utf_result res = utf8_to_utf16_impl(s, &result[0]);
+    result.resize(res.out_count);
+    if (res.ok) { return result; }
+    uint32_t code;  // decode the rest of invalid string leniently
+    for (auto p = s.begin() + res.in_count, p1 = p; (p1 = from_utf8(p, s.end(), &code)) > p; p = p1) {
         to_utf16(code, std::back_inserter(result));
     }
     return result;
 }
 
 std::string util::from_wide_to_utf8(std::wstring_view s) {
-    uint32_t code;
-    std::string result;
-    result.reserve(s.size());
-    for (auto p = s.begin(), p1 = p; (p1 = from_utf16(p, s.end(), &code)) > p; p = p1) {
+    std::string result(utf16_to_utf8_length(s.data(), s.data() + s.size()), '\0');
+    const utf_result res = utf16_to_utf8_impl(s.data(), s.size(), &result[0]);
+    result.resize(res.out_count);
+    if (res.ok) { return result; }
+    uint32_t code;  // encode the rest of invalid string leniently
+    for (auto p = s.begin() + res.in_count, p1 = p; p != s.end(); p = p1) {
+        if (static_cast<uint32_t>(*p) > 0xFFFF) {  // only with 4-byte `wchar_t`
+            code = static_cast<uint32_t>(*p), p1 = p + 1;
+        } else if ((p1 = from_utf16(p, s.end(), &code)) == p) {
+            break;
+        }
         to_utf8(code, std::back_inserter(result));
     }
     return result;
@@ -40,37 +285,190 @@ std::vector<std::string> util::unpack_strings(std::string_view s, char sep) {
 
 std::string util::encode_escapes(std::string_view s, std::string_view symb, std::string_view code) {
     std::string result;
-    result.reserve(s.size());
-    auto p = s.begin(), p0 = p;
-    for (; p < s.end(); ++p) {
-        auto pos = symb.find(*p);
-        if (pos != std::string_view::npos) {
-            result.append(p0, p);
-            result += '\\';
-            result += code[pos];
-            p0 = p + 1;
-        }
-    }
-    result.append(p0, p);
+    encode_escapes(s, symb, code, result);
     return result;
 }
 
 std::string util::decode_escapes(std::string_view s, std::string_view symb, std::string_view code) {
     std::string result;
-    result.reserve(s.size());
-    auto p = s.begin(), p0 = p;
-    for (; p < s.end(); ++p) {
-        if (*p != '\\') { continue; }
-        result.append(p0, p);
-        p0 = p + 1;
-        if (++p == s.end()) { break; }
-        auto pos = code.find(*p);
-        if (pos != std::string_view::npos) {
-            result += symb[pos];
-            p0 = p + 1;
-        }
-    }
-    result.append(p0, p);
+    decode_escapes(s, symb, code, result);
+    return result;
+}
+
+//---------------------------------------------------------------------------------
+// Escape table
+
+escape_table::escape_table(std::string_view symb, std::string_view code) {
+    assert(symb.size() == code.size());
+    std::array<bool, 256> is_code{};
+    is_escaped_.fill(false), code_.fill('\0');
+    for (unsigned ch = 0; ch < 256; ++ch) { symb_[ch] = static_cast<char>(ch); }
+    for (size_t n = 0; n < symb.size(); ++n) {  // the first match is used as by `encode_escapes`
+        const auto ch = static_cast<uint8_t>(symb[n]), ch_code = static_cast<uint8_t>(code[n]);
+        if (!is_escaped_[ch]) {
+            is_escaped_[ch] = true, code_[ch] = code[n];
+            symbols_ += symb[n];
+        }
+        if (!is_code[ch_code]) { is_code[ch_code] = true, symb_[ch_code] = symb[n]; }
+    }
+}
+
+#ifdef USE_SSE2
+namespace {
+// Matches bytes of 16-byte blocks against a few characters
+class block_matcher {
+ public:
+    enum : size_t { kMaxCharCount = 8 };
+    explicit block_matcher(std::string_view chars) : count_(chars.size()) {
+        assert(count_ <= kMaxCharCount);
+        for (size_t n = 0; n < count_; ++n) { chars_[n] = _mm_set1_epi8(chars[n]); }
+    }
+    int match(__m128i v) const {
+        __m128i eq = _mm_setzero_si128();
+        for (size_t n = 0; n < count_; ++n) { eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v, chars_[n])); }
+        return _mm_movemask_epi8(eq);
+    }
+
+ private:
+    __m128i chars_[kMaxCharCount];
+    size_t count_;
+};
+}  // namespace
+#endif  // USE_SSE2
+
+const char* escape_table::find_escaped(const char* first, const char* last) const NOEXCEPT {
+#ifdef USE_SSE2
+    if (symbols_.size() <= kMaxVectorSymbols) {
+        const block_matcher matcher(symbols_);
+        for (; last - first >= 16; first += 16) {
+            const int mask = matcher.match(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first)));
+            if (mask) { return first + count_trailing_zeros(static_cast<uint32_t>(mask)); }
+        }
+    }
+#endif  // USE_SSE2
+    for (; first < last; ++first) {
+        if (is_escaped_[static_cast<uint8_t>(*first)]) { return first; }
+    }
+    return last;
+}
+
+size_t escape_table::encoded_size(std::string_view s) const NOEXCEPT {
+    size_t size = s.size();
+    const char *p = s.data(), *last = s.data() + s.size();
+#ifdef USE_SSE2
+    if (symbols_.size() <= kMaxVectorSymbols) {
+        const block_matcher matcher(symbols_);
+        for (; last - p >= 16; p += 16) {
+            const int mask = matcher.match(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            if (mask) { size += count_ones(static_cast<uint64_t>(mask)); }
+        }
+    }
+#endif  // USE_SSE2
+    for (; p < last; ++p) { size += is_escaped_[static_cast<uint8_t>(*p)] ? 1 : 0; }
+    return size;
+}
+
+size_t escape_table::decoded_size(std::string_view s) const NOEXCEPT {
+    // two characters are decoded as one, trailing `\\` is dropped
+    size_t size = s.size();
+    const char *p = s.data(), *last = s.data() + s.size();
+#ifdef USE_SSE2
+    const __m128i backslash = _mm_set1_epi8('\\');
+    uint32_t carry = 0;  // the first character of the block is escaped
+    for (; last - p >= 16; p += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash))) & ~carry;
+        carry = 0;
+        while (mask) {
+            const unsigned n = count_trailing_zeros(mask);
+            --size;
+            if (n == 15) {
+                carry = 1;
+                break;
+            }
+            mask &= ~(3u << n);
+        }
+    }
+    if (carry && p < last) { ++p; }
+#endif  // USE_SSE2
+    for (; p < last; ++p) {
+        if (*p == '\\') { --size, ++p; }
+    }
+    return size;
+}
+
+char* escape_table::encode(std::string_view s, char* out) const NOEXCEPT {
+    const char *p = s.data(), *last = s.data() + s.size();
+#ifdef USE_SSE2
+    if (symbols_.size() <= kMaxVectorSymbols) {
+        // output is never shorter than the rest of input, so the whole block can be stored
+        const block_matcher matcher(symbols_);
+        while (last - p >= 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+            const int mask = matcher.match(v);
+            if (!mask) {
+                p += 16, out += 16;
+                continue;
+            }
+            const unsigned n = count_trailing_zeros(static_cast<uint32_t>(mask));
+            p += n, out += n;
+            *out++ = '\\';
+            *out++ = code_[static_cast<uint8_t>(*p++)];
+        }
+    }
+#endif  // USE_SSE2
+    for (; p < last; ++p) {
+        if (is_escaped_[static_cast<uint8_t>(*p)]) {
+            *out++ = '\\';
+            *out++ = code_[static_cast<uint8_t>(*p)];
+        } else {
+            *out++ = *p;
+        }
+    }
+    return out;
+}
+
+char* escape_table::decode(std::string_view s, char* out) const NOEXCEPT {
+    const char *p = s.data(), *last = s.data() + s.size();
+#ifdef USE_SSE2
+    // output never outruns input, so in-place storing overwrites only the input which is already read
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while (last - p >= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash));
+        if (!mask) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+            p += 16, out += 16;
+            continue;
+        }
+        const unsigned n = count_trailing_zeros(static_cast<uint32_t>(mask));
+        if (out != p) { std::memmove(out, p, n); }
+        p += n, out += n;
+        if (last - p < 2) { break; }
+        *out++ = symb_[static_cast<uint8_t>(p[1])];
+        p += 2;
+    }
+#endif  // USE_SSE2
+    for (; p < last; ++p) {
+        if (*p != '\\') {
+            *out++ = *p;
+        } else if (last - p >= 2) {
+            *out++ = symb_[static_cast<uint8_t>(*++p)];
+        }
+    }
+    return out;
+}
+
+std::string escape_table::encode(std::string_view s) const {
+    std::string result(encoded_size(s), '\0');
+    encode(s, &result[0]);
+    return result;
+}
+
+std::string escape_table::decode(std::string_view s) const {
+    std::string result(decoded_size(s), '\0');
+    decode(s, &result[0]);
     return result;
 }
 
@@ -92,16 +490,38 @@ std::pair<unsigned, unsigned> util::parse_flag_string(
     return flags;
 }
 
+#ifdef USE_SSE2
+namespace {
+// Toggles case of ASCII letters from range [`first`, `first` + 26)
+inline __m128i toggle_case_ascii(__m128i v, char first) {
+    const __m128i t = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - first)));
+    const __m128i is_letter = _mm_cmplt_epi8(t, _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+    return _mm_xor_si128(v, _mm_and_si128(is_letter, _mm_set1_epi8(0x20)));
+}
+}  // namespace
+#endif  // USE_SSE2
+
 int util::compare_strings_nocase(std::string_view lhs, std::string_view rhs) {
-    auto p1_end = lhs.begin() + std::min(lhs.size(), rhs.size());
-    for (auto p1 = lhs.begin(), p2 = rhs.begin(); p1 < p1_end; ++p1, ++p2) {
-        auto ch1 = std::toupper(*p1), ch2 = std::toupper(*p2);
-        if (std::string_view::traits_type::lt(ch1, ch2)) {
-            return -1;
-        } else if (std::string_view::traits_type::lt(ch2, ch1)) {
-            return 1;
+    const char *p1 = lhs.data(), *p2 = rhs.data();
+    const size_t count = std::min(lhs.size(), rhs.size());
+    size_t n = 0;
+#ifdef USE_SSE2
+    for (; count - n >= 16; n += 16) {
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1 + n));
+        const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p2 + n));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2)) == 0xffff) { continue; }  // no mapping is needed
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(toggle_case_ascii(v1, 'a'), toggle_case_ascii(v2, 'a')));
+        if (mask != 0xffff) {
+            n += count_trailing_zeros(static_cast<uint32_t>(~mask));
+            break;
         }
     }
+#endif  // USE_SSE2
+    for (; n < count; ++n) {
+        const auto ch1 = static_cast<unsigned char>(impl::to_upper_ascii(p1[n]));
+        const auto ch2 = static_cast<unsigned char>(impl::to_upper_ascii(p2[n]));
+        if (ch1 != ch2) { return ch1 < ch2 ? -1 : 1; }
+    }
     if (lhs.size() < rhs.size()) {
         return -1;
     } else if (rhs.size() < lhs.size()) {
@@ -110,11 +530,57 @@ int util::compare_strings_nocase(std::string_view lhs, std::string_view rhs) {
     return 0;
 }
 
+void util::impl::to_lower_ascii(const char* first, const char* last, char* out) NOEXCEPT {
+#ifdef USE_SSE2
+    for (; last - first >= 16; first += 16, out += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), toggle_case_ascii(v, 'A'));
+    }
+#endif  // USE_SSE2
+    for (; first < last; ++first) { *out++ = to_lower_ascii(*first); }
+}
+
+void util::impl::to_upper_ascii(const char* first, const char* last, char* out) NOEXCEPT {
+#ifdef USE_SSE2
+    for (; last - first >= 16; first += 16, out += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), toggle_case_ascii(v, 'a'));
+    }
+#endif  // USE_SSE2
+    for (; first < last; ++first) { *out++ = to_upper_ascii(*first); }
+}
+
 std::string util::to_lower(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    impl::to_lower_ascii(s.data(), s.data() + s.size(), &s[0]);
+    return s;
+}
+
+std::string util::to_upper(std::string s) {
+    impl::to_upper_ascii(s.data(), s.data() + s.size(), &s[0]);
     return s;
 }
 
+std::uint64_t util::hash_bytes(const void* data, size_t size) {
+    // MurmurHash64A
+    const uint64_t m = 0xc6a4a7935bd1e995ull;
+    const int r = 47;
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t h = 0x8445d61a4e774912ull ^ (size * m);
+    for (const auto* p_end = p + (size & ~size_t(7)); p != p_end; p += 8) {
+        uint64_t k;
+        std::memcpy(&k, p, sizeof(k));
+        k *= m, k ^= k >> r, k *= m;
+        h ^= k, h *= m;
+    }
+    if (size & 7) {
+        uint64_t k = 0;
+        std::memcpy(&k, p, size & 7);
+        h ^= k, h *= m;
+    }
+    h ^= h >> r, h *= m;
+    return h ^ (h >> r);
+}
+
 //---------------------------------------------------------------------------------
 // String converter implementation
 
@@ -210,19 +676,28 @@ inline uint64_t mul64x32_hi64(uint64_t x, uint32_t y, uint32_t bias = 0) {
 }
 
 inline uint128_t mul64x64(uint64_t x, uint64_t y, uint64_t bias = 0) {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 mul = static_cast<unsigned __int128>(x) * y + bias;
+    return uint128_t{static_cast<uint64_t>(mul >> 64), static_cast<uint64_t>(mul)};
+#else   // __SIZEOF_INT128__
     uint64_t lower = lo32(x) * lo32(y) + lo32(bias), higher = hi32(x) * hi32(y);
     uint64_t mid = lo32(x) * hi32(y) + hi32(bias), mid0 = mid;
     mid += hi32(x) * lo32(y) + hi32(lower);
     if (mid < mid0) { higher += 0x100000000; }
     return uint128_t{higher + hi32(mid), make64(lo32(mid), lo32(lower))};
+#endif  // __SIZEOF_INT128__
 }
 
 inline uint64_t mul64x64_hi64(uint64_t x, uint64_t y, uint64_t bias = 0) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(x) * y + bias) >> 64);
+#else   // __SIZEOF_INT128__
     uint64_t lower = lo32(x) * lo32(y) + lo32(bias), higher = hi32(x) * hi32(y);
     uint64_t mid = lo32(x) * hi32(y) + hi32(bias), mid0 = mid;
     mid += hi32(x) * lo32(y) + hi32(lower);
     if (mid < mid0) { higher += 0x100000000; }
     return higher + hi32(mid);
+#endif  // __SIZEOF_INT128__
 }
 
 struct fp_m96_t {
@@ -383,20 +858,154 @@ static struct pow_table_t {
 } g_pow_tbl;
 
 struct fp_exp10_format {
-    enum { kNeg = 1, kInf = 2, kNan = 4 };
+    enum { kNeg = 1, kInf = 2, kNan = 4, kInexact = 8 };
     char flags = 0;
     int exp = 0;
     uint64_t mantissa = 0;
+    int dropped_count = 0;  // count of parsed digits which don't fit into `mantissa`
 };
 
+// floor(e * log10(2)), floor(e * log10(3/4 * 2)), floor(e * log2(10))
+inline int flog10pow2(int e) { return static_cast<int>((e * 661971961083ll) >> 41); }
+inline int flog10threequarterspow2(int e) { return static_cast<int>((e * 661971961083ll - 274743187321ll) >> 41); }
+inline int flog2pow10(int e) { return static_cast<int>((e * 913124641741ll) >> 38); }
+
+// ---- arbitrary length integer helpers used to generate power tables
+
+static void big_multiply(std::vector<uint32_t>& big, uint32_t mul) {
+    uint64_t carry = 0;
+    for (auto& w : big) {
+        carry += static_cast<uint64_t>(w) * mul;
+        w = static_cast<uint32_t>(lo32(carry)), carry = hi32(carry);
+    }
+    if (carry) { big.push_back(static_cast<uint32_t>(carry)); }
+}
+
+static void big_add(std::vector<uint32_t>& big, uint32_t add) {
+    for (auto& w : big) {
+        if ((w += add) >= add) { return; }
+        add = 1;  // carry
+    }
+    if (add) { big.push_back(add); }
+}
+
+// returns the remainder
+static uint32_t big_divide(std::vector<uint32_t>& big, uint32_t div) {
+    uint64_t rem = 0;
+    for (auto it = big.rbegin(); it != big.rend(); ++it) {
+        rem = make64(rem, static_cast<uint64_t>(*it));
+        *it = static_cast<uint32_t>(rem / div), rem %= div;
+    }
+    while (!big.empty() && !big.back()) { big.pop_back(); }
+    return static_cast<uint32_t>(rem);
+}
+
+// returns `false` if the division is not exact
+static bool big_divide_pow5(std::vector<uint32_t>& big, int n) {
+    bool is_exact = true;
+    for (; n >= 13; n -= 13) { is_exact &= big_divide(big, 1220703125) == 0; }  // 5^13
+    for (; n > 0; --n) { is_exact &= big_divide(big, 5) == 0; }
+    return is_exact;
+}
+
+static void big_multiply_pow2(std::vector<uint32_t>& big, int n) {
+    for (; n >= 31; n -= 31) { big_multiply(big, 1u << 31); }
+    big_multiply(big, 1u << n);
+}
+
+static void big_assign_pow2(std::vector<uint32_t>& big, int n) {
+    big.assign(1 + n / 32, 0);
+    big.back() = 1u << (n % 32);
+}
+
+static int big_bit_length(const std::vector<uint32_t>& big) {
+    return big.empty() ? 0 : 32 * static_cast<int>(big.size() - 1) + 1 + ulog2(big.back());
+}
+
+// returns `true` if any of bits below `bit` is not zero
+static bool big_has_bits_below(const std::vector<uint32_t>& big, int bit) {
+    if (bit <= 0) { return false; }
+    const size_t n_words = std::min(static_cast<size_t>(bit / 32), big.size());
+    for (size_t n = 0; n < n_words; ++n) {
+        if (big[n]) { return true; }
+    }
+    return n_words < big.size() && (big[n_words] & ((1u << (bit % 32)) - 1)) != 0;
+}
+
+// returns 128 bits of `big * 2^shift`
+static uint128_t big_get_bits128(const std::vector<uint32_t>& big, int shift) {
+    uint128_t result;
+    for (int n = 0; n < 128; ++n) {
+        const int bit = n - shift;
+        if (bit < 0 || bit >= 32 * static_cast<int>(big.size()) || !((big[bit / 32] >> (bit % 32)) & 1)) {
+            continue;
+        }
+        if (n < 64) {
+            result.lo |= 1ull << n;
+        } else {
+            result.hi |= 1ull << (n - 64);
+        }
+    }
+    return result;
+}
+
+static struct shortest_pow_table_t {
+    enum : int { kMinK = -324, kMaxK = 292 };
+    // g(k) = floor(10^-k * 2^(125 - floor(log2(10^-k)))) + 1, 2^125 <= g(k) < 2^126
+    std::array<uint128_t, kMaxK - kMinK + 1> g;
+    shortest_pow_table_t() {
+        std::vector<uint32_t> big{1};
+        for (int n = 0; n <= -kMinK; ++n) {  // 10^n, n >= 0
+            if (n > 0) { big_multiply(big, 10); }
+            g[-n - kMinK] = get_rounded_up(big, 125 - flog2pow10(n));
+        }
+        for (int n = 1; n <= kMaxK; ++n) {  // 10^-n = 2^-n / 5^n
+            big_assign_pow2(big, 125 - flog2pow10(-n) - n);
+            big_divide_pow5(big, n);
+            g[n - kMinK] = get_rounded_up(big, 0);
+        }
+    }
+    static uint128_t get_rounded_up(const std::vector<uint32_t>& big, int shift) {
+        uint128_t result = big_get_bits128(big, shift);
+        if (++result.lo == 0) { ++result.hi; }
+        assert((result.hi >> 61) == 1);
+        return result;
+    }
+} g_shortest_pow_tbl;
+
+static struct eisel_lemire_pow_table_t {
+    enum : int { kMinQ = -342, kMaxQ = 308 };
+    // 5^q normalized to [2^127, 2^128): truncated for q >= 0, rounded up and then truncated for q < 0
+    std::array<uint128_t, kMaxQ - kMinQ + 1> pow5;
+    eisel_lemire_pow_table_t() {
+        std::vector<uint32_t> big{1}, div{1};
+        for (int n = 0; n <= kMaxQ; ++n) {
+            if (n > 0) { big_multiply(big, 5); }
+            pow5[n - kMinQ] = big_get_bits128(big, 128 - big_bit_length(big));
+        }
+        for (int n = 1; n <= -kMinQ; ++n) {  // 2^b / 5^n, 5^n < 2^z
+            big_multiply(div, 5);
+            const int z = big_bit_length(div);
+            big_assign_pow2(big, n <= 27 ? z + 127 : 2 * z + 128);
+            big_divide_pow5(big, n);
+            for (auto& w : big) {
+                if (++w != 0) { break; }
+            }
+            pow5[-n - kMinQ] = big_get_bits128(big, 128 - big_bit_length(big));
+        }
+    }
+} g_eisel_lemire_pow_tbl;
+
 static const char* starts_with(const char* p, const char* end, std::string_view s) {
     if (static_cast<size_t>(end - p) < s.size()) { return p; }
     for (const char *p1 = p, *p2 = s.data(); p1 < end; ++p1, ++p2) {
-        if (std::toupper(*p1) != std::toupper(*p2)) { return p; }
+        if (impl::to_upper_ascii(*p1) != impl::to_upper_ascii(*p2)) { return p; }
     }
     return p + s.size();
 }
 
+inline bool is_digit(char ch) { return static_cast<unsigned>(ch - '0') < 10; }
+
 inline const char* skip_spaces(const char* p, const char* end) {
     while ((p < end) && std::isspace(*p)) { ++p; }
     return p;
@@ -409,13 +1018,85 @@ char get_dig_and_div(Ty& v) {
     return '0' + static_cast<int>(t - 10 * v);
 }
 
+static const char g_digit_pairs[] =
+    "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+    "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+template<typename Ty>
+char* put_two_digs_and_div(char* p, Ty& v) {
+    Ty t = v / 100;
+    std::memcpy(p - 2, &g_digit_pairs[2 * static_cast<unsigned>(v - 100 * t)], 2);
+    v = t;
+    return p - 2;
+}
+
+inline char* put_decimal(char* p, uint32_t v) {
+    while (v >= 100) { p = put_two_digs_and_div(p, v); }
+    if (v >= 10) { return put_two_digs_and_div(p, v); }
+    *--p = '0' + static_cast<int>(v);
+    return p;
+}
+
+inline char* put_decimal(char* p, uint64_t v) {
+    while (v > 0xffffffff) {  // 8 digits at a time using 32-bit arithmetic
+        const uint64_t t = v / 100000000;
+        auto lo = static_cast<uint32_t>(v - 100000000 * t);
+        for (int n = 0; n < 4; ++n) { p = put_two_digs_and_div(p, lo); }
+        v = t;
+    }
+    return put_decimal(p, static_cast<uint32_t>(v));
+}
+
+// ---- 8 digits at a time parsing (SWAR), little-endian byte order is assumed
+
+inline uint64_t load_u64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// returns the number of leading decimal digits in 8-byte chunk
+inline unsigned count_chunk_digits(uint64_t v) {
+    const uint64_t non_digits = ((v & 0xf0f0f0f0f0f0f0f0ull) |
+                                 (((v + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4)) ^
+                                0x3333333333333333ull;
+    return non_digits ? count_trailing_zeros(non_digits) >> 3 : 8;
+}
+
+// converts 8-byte chunk of decimal digits to value
+inline uint32_t parse_chunk_digits(uint64_t v) {
+    v -= 0x3030303030303030ull;
+    v = 10 * v + (v >> 8);  // pairs of digits
+    v = (((v & 0x000000ff000000ffull) * (100 + (1000000ull << 32))) +
+         (((v >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32)))) >> 32;
+    return static_cast<uint32_t>(v);
+}
+
 // ---- from string to value
 
 template<typename Ty>
 const char* to_unsigned(const char* p, const char* end, Ty& val) {
-    if ((p == end) || !std::isdigit(*p)) { return p; }
-    val = static_cast<Ty>(*p++ - '0');
-    while ((p < end) && std::isdigit(*p)) { val = 10 * val + static_cast<Ty>(*p++ - '0'); }
+    static const uint32_t dec_mul[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    using UTy = typename std::make_unsigned<Ty>::type;
+    if ((p == end) || !is_digit(*p)) { return p; }
+    UTy v = 0;
+    while (end - p >= 8) {
+        uint64_t chunk = load_u64(p);
+        const unsigned n_digs = count_chunk_digits(chunk);
+        if (n_digs < 8) {
+            if (n_digs > 0) {  // move digits to the upper bytes and pad with leading zeroes
+                const unsigned shift = 8 * (8 - n_digs);
+                chunk = (chunk << shift) | (0x3030303030303030ull >> (64 - shift));
+                v = static_cast<UTy>(v * static_cast<UTy>(dec_mul[n_digs]) + parse_chunk_digits(chunk));
+            }
+            val = static_cast<Ty>(v);
+            return p + n_digs;
+        }
+        v = static_cast<UTy>(v * static_cast<UTy>(dec_mul[8]) + parse_chunk_digits(chunk));
+        p += 8;
+    }
+    for (; (p < end) && is_digit(*p); ++p) { v = static_cast<UTy>(10 * v + static_cast<UTy>(*p - '0')); }
+    val = static_cast<Ty>(v);
     return p;
 }
 
@@ -431,17 +1112,25 @@ const char* to_signed(const char* p, const char* end, Ty& val) {
         neg = true;  // negative sign
         ++p;
     }
-    if ((p1 = to_unsigned(p, end, val)) == p) { return p0; }
-    if (neg) { val = -val; }  // apply sign
+    typename std::make_unsigned<Ty>::type v = 0;
+    if ((p1 = to_unsigned(p, end, v)) == p) { return p0; }
+    val = static_cast<Ty>(neg ? 0 - v : v);  // apply sign
     return p1;
 }
 
-static const char* accum_mantissa(const char* p, const char* end, uint64_t& m, int& exp) {
-    for (; (p < end) && std::isdigit(*p); ++p) {
-        if (m < (pow_table_t::kMaxMantissa10 / 10)) {  // decimal mantissa can hold up to 18 digits
-            m = 10 * m + static_cast<uint64_t>(*p - '0');
+static const char* accum_mantissa(const char* p, const char* end, fp_exp10_format& fp10) {
+    while ((end - p >= 8) && (fp10.mantissa < pow_table_t::kMaxMantissa10 / 100000000)) {  // 8 digits at a time
+        const uint64_t chunk = load_u64(p);
+        if (count_chunk_digits(chunk) < 8) { break; }
+        fp10.mantissa = 100000000 * fp10.mantissa + parse_chunk_digits(chunk);
+        p += 8;
+    }
+    for (; (p < end) && is_digit(*p); ++p) {
+        if (fp10.mantissa < (pow_table_t::kMaxMantissa10 / 10)) {  // decimal mantissa can hold up to 18 digits
+            fp10.mantissa = 10 * fp10.mantissa + static_cast<uint64_t>(*p - '0');
         } else {
-            ++exp;
+            if (*p != '0') { fp10.flags |= fp_exp10_format::kInexact; }
+            ++fp10.exp, ++fp10.dropped_count;
         }
     }
     return p;
@@ -459,11 +1148,11 @@ static const char* to_exp10_float(const char* p, const char* end, fp_exp10_forma
     }
     if (p == end) {
         return p0;
-    } else if (std::isdigit(*p)) {  // integer part
+    } else if (is_digit(*p)) {  // integer part
         fp10.mantissa = static_cast<uint64_t>(*p++ - '0');
-        p = accum_mantissa(p, end, fp10.mantissa, fp10.exp);
+        p = accum_mantissa(p, end, fp10);
         if ((p < end) && (*p == '.')) { ++p; }  // skip decimal point
-    } else if ((*p == '.') && ((p + 1) < end) && std::isdigit(*(p + 1))) {
+    } else if ((*p == '.') && ((p + 1) < end) && is_digit(*(p + 1))) {
         fp10.mantissa = static_cast<uint64_t>(*(p + 1) - '0');  // tenth
         fp10.exp = -1;
         p += 2;
@@ -476,7 +1165,7 @@ static const char* to_exp10_float(const char* p, const char* end, fp_exp10_forma
     } else {
         return p0;
     }
-    p1 = accum_mantissa(p, end, fp10.mantissa, fp10.exp);  // fractional part
+    p1 = accum_mantissa(p, end, fp10);  // fractional part
     fp10.exp -= static_cast<int>(p1 - p);
     if ((p1 < end) && ((*p1 == 'e') || (*p1 == 'E'))) {  // optional exponent
         int exp_optional = 0;
@@ -488,6 +1177,149 @@ static const char* to_exp10_float(const char* p, const char* end, fp_exp10_forma
     return p1;
 }
 
+// ---- fast decimal to binary conversion (Eisel-Lemire algorithm)
+
+template<typename Ty>
+struct eisel_lemire_traits;
+
+template<>
+struct eisel_lemire_traits<double> {
+    enum : int { kMinQ = -342, kMaxQ = 308, kMinRoundToEvenQ = -4, kMaxRoundToEvenQ = 23 };
+};
+
+template<>
+struct eisel_lemire_traits<float> {
+    enum : int { kMinQ = -65, kMaxQ = 38, kMinRoundToEvenQ = -17, kMaxRoundToEvenQ = 10 };
+};
+
+// finds binary `mantissa2 * 2^exp` nearest to `w * 10^q`, w != 0; returns false if it can't be decided
+template<typename Ty>
+bool eisel_lemire_to_binary(uint64_t w, int q, int& exp, uint64_t& mantissa2) {
+    using Traits = fp_format_traits<Ty>;
+    using ELTraits = eisel_lemire_traits<Ty>;
+    if (q < ELTraits::kMinQ) {
+        exp = 0, mantissa2 = 0;  // convert to zero
+        return true;
+    } else if (q > ELTraits::kMaxQ) {
+        exp = Traits::kExpMax, mantissa2 = 0;  // convert to infinity
+        return true;
+    }
+
+    const int lz = 63 - ulog2(w);
+    w <<= lz;
+    const uint128_t& pow5 = g_eisel_lemire_pow_tbl.pow5[q - eisel_lemire_pow_table_t::kMinQ];
+    const uint64_t precision_mask = ~0ull >> (Traits::kBitsPerMantissa + 3);
+    uint128_t product = mul64x64(w, pow5.hi);
+    if ((product.hi & precision_mask) == precision_mask) {  // take lower part of 5^q into account
+        const uint64_t lower = mul64x64_hi64(w, pow5.lo);
+        if ((product.lo += lower) < lower) { ++product.hi; }
+    }
+    if (product.lo == ~0ull && (q < -27 || q > 55)) { return false; }
+
+    const int upper_bit = static_cast<int>(product.hi >> 63);
+    const int shift = upper_bit + 64 - Traits::kBitsPerMantissa - 3;
+    uint64_t m = product.hi >> shift;
+    int e = ((217706 * q) >> 16) + 63 + upper_bit - lz + Traits::kExpBias;  // floor(q * log2(10)) + ...
+    if (e <= 0) {  // denormalized value
+        if (-e + 1 >= 64) {
+            exp = 0, mantissa2 = 0;  // convert to zero
+            return true;
+        }
+        m >>= -e + 1;
+        m = (m + (m & 1)) >> 1;
+        exp = m < (1ull << Traits::kBitsPerMantissa) ? 0 : 1;
+        mantissa2 = m;
+        return true;
+    }
+
+    if (product.lo <= 1 && q >= ELTraits::kMinRoundToEvenQ && q <= ELTraits::kMaxRoundToEvenQ && (m & 3) == 1 &&
+        (m << shift) == product.hi) {
+        m &= ~1ull;  // exactly halfway between two values: round to even
+    }
+    m = (m + (m & 1)) >> 1;
+    if (m >= (2ull << Traits::kBitsPerMantissa)) { m = 1ull << Traits::kBitsPerMantissa, ++e; }
+    if (e >= Traits::kExpMax) { e = Traits::kExpMax, m = 0; }  // convert to infinity
+    exp = e, mantissa2 = m;
+    return true;
+}
+
+template<typename Ty>
+bool eisel_lemire_to_binary(const fp_exp10_format& fp10, int& exp, uint64_t& mantissa2) {
+    if (!eisel_lemire_to_binary<Ty>(fp10.mantissa, fp10.exp, exp, mantissa2)) { return false; }
+    if (!(fp10.flags & fp_exp10_format::kInexact)) { return true; }
+    // some digits are dropped: the result is exact only if `mantissa + 1` gives the same value
+    int exp_up = 0;
+    uint64_t mantissa2_up = 0;
+    return eisel_lemire_to_binary<Ty>(fp10.mantissa + 1, fp10.exp, exp_up, mantissa2_up) && exp_up == exp &&
+           mantissa2_up == mantissa2;
+}
+
+// ---- exact decimal to binary conversion with arbitrary length integers: the slow path for the values which
+// can't be decided by Eisel-Lemire algorithm
+
+// finds binary `mantissa2 * 2^exp` nearest to decimal number given by its digits (with optional decimal point)
+// in [p, end) and the exponent of the last digit; only the first `kMaxDigits` significant digits are taken
+// exactly, the rest is taken into account as nonzero or zero tail: any value halfway between two adjacent
+// binary values has fewer significant digits, so the result is always correctly rounded
+template<typename Ty>
+void big_decimal_to_binary(const char* p, const char* end, int exp10, int& exp, uint64_t& mantissa2) {
+    using Traits = fp_format_traits<Ty>;
+    enum : int { kMaxDigits = 800 };
+    std::vector<uint32_t> big;
+    big.reserve(64);
+    int count = 0;
+    uint32_t chunk = 0;
+    int chunk_len = 0;
+    bool is_tail_nonzero = false;
+    for (; p < end && (is_digit(*p) || *p == '.'); ++p) {
+        if (*p == '.' || (count == 0 && *p == '0')) { continue; }  // skip decimal point and leading zeroes
+        if (count == kMaxDigits) {
+            if (*p != '0') { is_tail_nonzero = true; }
+            ++exp10;
+            continue;
+        }
+        ++count, chunk = 10 * chunk + static_cast<uint32_t>(*p - '0');
+        if (++chunk_len == 9) {
+            big_multiply(big, 1000000000), big_add(big, chunk);
+            chunk = 0, chunk_len = 0;
+        }
+    }
+    if (chunk_len > 0) {
+        big_multiply(big, static_cast<uint32_t>(g_pow_tbl.decimal_mul[chunk_len - 1]));
+        big_add(big, chunk);
+    }
+    if (is_tail_nonzero) { big_multiply(big, 10), big_add(big, 1), --exp10; }
+
+    // the value is `big * 2^exp2` with the remainder given by `is_tail_nonzero`
+    int exp2 = 0;
+    if (exp10 >= 0) {
+        for (; exp10 >= 9; exp10 -= 9) { big_multiply(big, 1000000000); }
+        if (exp10 > 0) { big_multiply(big, static_cast<uint32_t>(g_pow_tbl.decimal_mul[exp10 - 1])); }
+    } else {  // big / 10^n = (big * 2^s / 5^n) * 2^(-s - n), s is chosen to obtain enough quotient bits
+        const int n = -exp10, pow5_bits = ((n * 2378) >> 10) + 1;  // log2(5) < 2378 / 1024
+        const int s = std::max<int>(Traits::kBitsPerMantissa + 4 + pow5_bits - big_bit_length(big), 0);
+        big_multiply_pow2(big, s);
+        if (!big_divide_pow5(big, n)) { is_tail_nonzero = true; }
+        exp2 = -s - n;
+    }
+
+    // round to nearest even
+    const int bit_length = big_bit_length(big);
+    int e = bit_length - 1 + exp2 + Traits::kExpBias;
+    int shift = bit_length - 1 - Traits::kBitsPerMantissa;
+    if (e <= 0) { shift += 1 - e; }  // denormalized value
+    uint64_t m = big_get_bits128(big, -shift).lo;
+    const bool is_round_bit = (big_get_bits128(big, 1 - shift).lo & 1) != 0;
+    if (is_round_bit && (is_tail_nonzero || (m & 1) || big_has_bits_below(big, shift - 1))) { ++m; }
+    if (e <= 0) {
+        e = m < (1ull << Traits::kBitsPerMantissa) ? 0 : 1;
+    } else if (m >= (2ull << Traits::kBitsPerMantissa)) {
+        m >>= 1, ++e;
+    }
+    if (e >= Traits::kExpMax) { e = Traits::kExpMax, m = 0; }  // convert to infinity
+    exp = e, mantissa2 = m;
+}
+
 template<typename Ty>
 const char* to_float(const char* p, const char* end, Ty& val) {
     fp_exp10_format fp10;
@@ -501,31 +1333,9 @@ const char* to_float(const char* p, const char* end, Ty& val) {
     } else if ((fp10.mantissa == 0) || (fp10.exp < -pow_table_t::kPow10Max)) {  // zero
     } else if (fp10.exp > pow_table_t::kPow10Max) {
         exp = fp_format_traits<Ty>::kExpMax;  // convert to infinity
-    } else {
-        // convert decimal mantissa to binary
-        const auto& coef = g_pow_tbl.coef10to2[pow_table_t::kPow10Max + fp10.exp];
-        auto res128 = mul64x64(fp10.mantissa, coef.m);
-        res128.hi += fp10.mantissa;  // apply implicit 1 term of normalized coefficient
-        int shift = ulog2(res128.hi);
-        exp = fp_format_traits<Ty>::kExpBias + shift + coef.exp;
-        if (exp >= fp_format_traits<Ty>::kExpMax) {
-            exp = fp_format_traits<Ty>::kExpMax;  // convert to infinity
-        } else {
-            // obtain +1 mantissa bits for rounding
-            mantissa2 = shr_lo64(res128, shift + 63 - fp_format_traits<Ty>::kBitsPerMantissa);
-            if (~mantissa2 & ((1ull << (fp_format_traits<Ty>::kBitsPerMantissa + 1)) - 1)) {
-                mantissa2 = (mantissa2 + 1) >> 1;  // round mantissa
-            } else {                               // overflow while rounding, the value can become infinity
-                ++exp, mantissa2 = 0;
-            }
-
-            if (exp <= 0) {  // denormalize value or the value will be converted to zero
-                if (exp > -static_cast<int>(fp_format_traits<Ty>::kBitsPerMantissa)) {  // denormalize
-                    mantissa2 = (mantissa2 | (1ull << fp_format_traits<Ty>::kBitsPerMantissa)) >> (1 - exp);
-                }
-                exp = 0;
-            }
-        }
+    } else if (!eisel_lemire_to_binary<Ty>(fp10, exp, mantissa2)) {
+        const char* digits = p + ((*p == '+' || *p == '-') ? 1 : 0);
+        big_decimal_to_binary<Ty>(digits, p1, fp10.exp - fp10.dropped_count, exp, mantissa2);
     }
 
     // compose floating point value
@@ -547,9 +1357,7 @@ std::string_view from_unsigned(char* p, Ty val, scvt_base base) {
                 val >>= 3;
             } while (val != 0);
             break;
-        case scvt_base::kBase10:  //
-            do { *--p = get_dig_and_div(val); } while (val != 0);
-            break;
+        case scvt_base::kBase10: p = put_decimal(p, static_cast<uint64_t>(val)); break;
         case scvt_base::kBase16:
             do {
                 *--p = "0123456789abcdef"[val & 0xf];
@@ -562,14 +1370,11 @@ std::string_view from_unsigned(char* p, Ty val, scvt_base base) {
 
 template<typename Ty>
 std::string_view from_signed(char* p, Ty val, scvt_base base) {
+    using UTy = typename std::make_unsigned<Ty>::type;
+    if ((base != scvt_base::kBase10) || (val >= 0)) { return from_unsigned(p, static_cast<UTy>(val), base); }
     char* end = p;
-    bool neg = false;
-    if ((base == scvt_base::kBase10) && (val < 0)) {
-        val = -val;  // negative value
-        neg = true;
-    }
-    do { *--p = get_dig_and_div(val); } while (val != 0);
-    if (neg) { *--p = '-'; }  // add negative sign
+    p = put_decimal(p, static_cast<uint64_t>(static_cast<UTy>(0 - static_cast<UTy>(val))));
+    *--p = '-';  // add negative sign
     return std::string_view(p, end - p);
 }
 
@@ -622,14 +1427,16 @@ static std::string_view from_exp10_float(char* p, const fp_exp10_format& fp10, s
         if (n_zeroes < prec) {
             prec -= n_zeroes;
             n_zeroes = 0;
-            for (; prec > 0; --prec) { *--p = get_dig_and_div(m); }
+            for (; prec > 1; prec -= 2) { p = put_two_digs_and_div(p, m); }
+            if (prec > 0) { *--p = get_dig_and_div(m); }
         } else {
             n_zeroes -= prec;
         }
     } else if (n_zeroes < prec) {
         prec -= n_zeroes;
         for (; n_zeroes; --n_zeroes) { *--p = '0'; }
-        for (; prec > 0; --prec) { *--p = get_dig_and_div(m); }
+        for (; prec > 1; prec -= 2) { p = put_two_digs_and_div(p, m); }
+        if (prec > 0) { *--p = get_dig_and_div(m); }
     } else {
         n_zeroes -= prec;
         for (; prec > 0; --prec) { *--p = '0'; }
@@ -638,14 +1445,138 @@ static std::string_view from_exp10_float(char* p, const fp_exp10_format& fp10, s
     // integer part
     if (p < p0) { *--p = '.'; }
     for (; n_zeroes; --n_zeroes) { *--p = '0'; }
-    do { *--p = get_dig_and_div(m); } while (m != 0);
+    p = put_decimal(p, m);
 
     if (fp10.flags & fp_exp10_format::kNeg) { *--p = '-'; }  // add negative sign
     return std::string_view(p, end - p);
 }
 
+// ---- shortest round-trip representation (Schubfach algorithm by Raffaello Giulietti)
+
+template<typename Ty>
+struct shortest_fp_traits;
+
+template<>
+struct shortest_fp_traits<double> {
+    enum : int { kMinQ = -1074, kShiftBias = 2 };
+    // (g * cp) / 2^127 rounded to odd
+    static uint64_t round_to_odd(const uint128_t& g, uint64_t cp) {
+        const uint64_t mask63 = (1ull << 63) - 1;
+        const uint64_t g1 = (g.hi << 1) | (g.lo >> 63), g0 = g.lo & mask63;
+        const uint128_t y = mul64x64(g1, cp);
+        const uint64_t z = (y.lo >> 1) + mul64x64_hi64(g0, cp);
+        return (y.hi + (z >> 63)) | (((z & mask63) + mask63) >> 63);
+    }
+};
+
+template<>
+struct shortest_fp_traits<float> {
+    enum : int { kMinQ = -149, kShiftBias = 33 };
+    // (g * cp) / 2^95 rounded to odd, only upper 63 bits of g are used
+    static uint64_t round_to_odd(const uint128_t& g, uint64_t cp) {
+        const uint64_t x1 = mul64x64_hi64(((g.hi << 1) | (g.lo >> 63)) + 1, cp);
+        return (x1 >> 31) | ((lo32(x1) + 0xffffffff) >> 32);
+    }
+};
+
+// returns decimal mantissa `f` of the shortest decimal `f * 10^exp` which rounds to `c * 2^q`
+template<typename Ty>
+uint64_t to_shortest_exp10(int q, uint64_t c, int& exp) {
+    using Traits = shortest_fp_traits<Ty>;
+    const uint64_t out = c & 1, cb = c << 2, cbr = cb + 2;
+    uint64_t cbl = cb - 2;
+    int k = 0;
+    if ((c != (1ull << fp_format_traits<Ty>::kBitsPerMantissa)) || (q == Traits::kMinQ)) {
+        k = flog10pow2(q);
+    } else {  // the lower neighbour is closer
+        cbl = cb - 1;
+        k = flog10threequarterspow2(q);
+    }
+
+    const int h = q + flog2pow10(-k) + Traits::kShiftBias;
+    const auto& g = g_shortest_pow_tbl.g[k - shortest_pow_table_t::kMinK];
+    const uint64_t vb = Traits::round_to_odd(g, cb << h);
+    const uint64_t vbl = Traits::round_to_odd(g, cbl << h);
+    const uint64_t vbr = Traits::round_to_odd(g, cbr << h);
+
+    const uint64_t s = vb >> 2;
+    uint64_t f = 0;
+    for (uint64_t pow = 10; s >= pow; pow *= 10) {  // try to remove digits
+        const uint64_t sp = pow * (s / pow), tp = sp + pow;
+        const bool upin = vbl + out <= (sp << 2), wpin = (tp << 2) + out <= vbr;
+        if (!upin && !wpin) { break; }
+        if (upin != wpin) {
+            f = upin ? sp : tp;
+        } else {  // both candidates are inside the rounding interval (subnormal values only), take the closest
+            const int64_t cmp = static_cast<int64_t>(vb - ((sp + tp) << 1));
+            f = ((cmp < 0) || ((cmp == 0) && !((sp / pow) & 1))) ? sp : tp;
+        }
+    }
+    exp = k;
+    if (f) { return f; }
+
+    const uint64_t t = s + 1;
+    const bool uin = vbl + out <= (s << 2), win = (t << 2) + out <= vbr;
+    exp = k;
+    if (uin != win) { return uin ? s : t; }
+    const int64_t cmp = static_cast<int64_t>(vb - ((s + t) << 1));
+    return ((cmp < 0) || ((cmp == 0) && !(s & 1))) ? s : t;
+}
+
+template<typename Ty>
+std::string_view from_float_shortest(char* p, Ty val, scvt_fp fmt) {
+    using Traits = fp_format_traits<Ty>;
+    fp_exp10_format fp10;
+    uint64_t c = Traits::to_u64(val);
+    if (c & Traits::kSignBit) { fp10.flags |= fp_exp10_format::kNeg; }
+    const int bexp = static_cast<int>((c & Traits::kExpMask) >> Traits::kBitsPerMantissa);
+    c &= Traits::kMantissaMask;
+    fmt = static_cast<scvt_fp>(static_cast<int>(fmt) & static_cast<int>(scvt_fp::kGeneral));
+    if (fmt != scvt_fp::kScientific && fmt != scvt_fp::kFixed) { fmt = scvt_fp::kGeneral; }
+
+    if (bexp == Traits::kExpMax) {
+        fp10.flags = c == 0 ? fp10.flags | fp_exp10_format::kInf : fp_exp10_format::kNan;
+        return from_exp10_float(p, fp10, fmt, 0);
+    } else if ((bexp == 0) && (c == 0)) {
+        return from_exp10_float(p, fp10, fmt, 0);
+    }
+
+    uint64_t f = 0;
+    int exp = 0;
+    if (bexp != 0) {
+        const int q = shortest_fp_traits<Ty>::kMinQ - 1 + bexp;
+        c |= 1ull << Traits::kBitsPerMantissa;
+        if ((q < 0) && (q > -Traits::kBitsPerMantissa - 1) && !(c & ((1ull << -q) - 1))) {
+            f = c >> -q;  // integer value
+        } else {
+            f = to_shortest_exp10<Ty>(q, c, exp);
+        }
+    } else {  // denormalized
+        f = to_shortest_exp10<Ty>(shortest_fp_traits<Ty>::kMinQ, c, exp);
+    }
+
+    // remove trailing zeroes and count digits
+    for (uint64_t t = f / 10; f == 10 * t; t = f / 10) { f = t, ++exp; }
+    int n_digs = ((ulog2(f) + 1) * 1233) >> 12;  // 1233 / 4096 ~ log10(2)
+    if (n_digs == 0 || f >= g_pow_tbl.decimal_mul[n_digs - 1]) { ++n_digs; }
+    fp10.exp = exp + n_digs - 1;
+
+    // pad decimal mantissa with zeroes up to the number of digits `from_exp10_float` expects
+    int prec = n_digs - 1, n_total = n_digs;
+    if (fmt == scvt_fp::kFixed) {
+        prec = std::max(n_digs - 1 - fp10.exp, 0);
+        n_total = std::min(1 + prec + fp10.exp, static_cast<int>(pow_table_t::kPrecLimit));
+    } else if (fmt == scvt_fp::kGeneral) {
+        if (fp10.exp < pow_table_t::kPrecLimit - 1) { n_total = std::max(n_digs, fp10.exp + 1); }
+        prec = n_total;
+    }
+    fp10.mantissa = n_total > n_digs ? f * g_pow_tbl.decimal_mul[n_total - n_digs - 1] : f;
+    return from_exp10_float(p, fp10, fmt, prec);
+}
+
 template<typename Ty>
 std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
+    if (static_cast<int>(fmt) & static_cast<int>(scvt_fp::kShortest)) { return from_float_shortest(p, val, fmt); }
     fp_exp10_format fp10;
     if (prec < 0) { prec = 6; }
     uint64_t mantissa = fp_format_traits<Ty>::to_u64(val);
@@ -715,6 +1646,55 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
     return from_exp10_float(p, fp10, fmt, prec);
 }
 
+inline char* copy_chars(char* first, char* last, std::string_view s) {
+    if (static_cast<size_t>(last - first) < s.size()) { return first; }
+    std::memcpy(first, s.data(), s.size());
+    return first + s.size();
+}
+
+// ---- batch conversions
+
+template<typename Ty, typename Func>
+size_t from_strings(span<const std::string_view> s, span<Ty> val, span<uint64_t> error_mask, Func func) {
+    assert(val.size() >= s.size() && (error_mask.empty() || 64 * error_mask.size() >= s.size()));
+    if (!error_mask.empty()) { std::fill_n(error_mask.data(), (s.size() + 63) / 64, 0); }
+    size_t n_errors = 0;
+    Ty* v = val.data();
+    for (size_t n = 0; n < s.size(); ++n) {
+        const char *end = s.data()[n].data() + s.data()[n].size(), *p = skip_spaces(s.data()[n].data(), end);
+        const char* p1 = func(p, end, v[n]);
+        if ((p1 == p) || (skip_spaces(p1, end) != end)) {
+            v[n] = string_converter<Ty>::default_value(), ++n_errors;
+            if (!error_mask.empty()) { error_mask.data()[n >> 6] |= 1ull << (n & 63); }
+        }
+    }
+    return n_errors;
+}
+
+template<size_t BufSize, typename Ty, typename Func>
+void to_strings(span<const Ty> val, std::string& out, std::string_view sep, Func func) {
+    // for short representations whole buffer is copied: it's faster than copying of variable length
+    const bool copy_whole = BufSize <= 32;
+    std::array<char, copy_whole ? 2 * BufSize : BufSize> buf;
+    const size_t max_len = BufSize + sep.size();
+    size_t pos = out.size();
+    for (size_t n = 0; n < val.size(); ++n) {
+        if (out.size() - pos < max_len) { out.resize(std::max(2 * out.size(), pos + max_len)); }
+        char* p = &out[pos];
+        if (n > 0) {
+            if (sep.size() == 1) {
+                *p++ = sep[0];
+            } else {
+                std::memcpy(p, sep.data(), sep.size()), p += sep.size();
+            }
+        }
+        std::string_view s = func(buf.data() + BufSize, val.data()[n]);
+        std::memcpy(p, s.data(), copy_whole ? BufSize : s.size());
+        pos = p + s.size() - out.data();
+    }
+    out.resize(pos);
+}
+
 }  // namespace scvt
 
 /*static*/ const char* string_converter<int16_t>::from_string(std::string_view s, int16_t& val, bool* ok) {
@@ -725,10 +1705,27 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 }
 
 /*static*/ std::string string_converter<int16_t>::to_string(int16_t val, scvt_base base) {
-    std::array<char, 32> s;
+    std::array<char, kMaxChars> s;
     return static_cast<std::string>(scvt::from_signed(s.data() + s.size(), val, base));
 }
 
+/*static*/ char* string_converter<int16_t>::to_chars(char* first, char* last, int16_t val, scvt_base base) {
+    std::array<char, kMaxChars> s;
+    return scvt::copy_chars(first, last, scvt::from_signed(s.data() + s.size(), val, base));
+}
+
+/*static*/ size_t string_converter<int16_t>::from_strings(span<const std::string_view> s, span<int16_t> val,
+                                                          span<uint64_t> error_mask) {
+    return scvt::from_strings(s, val, error_mask, [](const char* p, const char* end, int16_t& v) {
+        return scvt::to_signed(p, end, v);
+    });
+}
+
+/*static*/ void string_converter<int16_t>::to_strings(span<const int16_t> val, std::string& out, std::string_view sep,
+                                                      scvt_base base) {
+    scvt::to_strings<kMaxChars>(val, out, sep, [base](char* p, int16_t v) { return scvt::from_signed(p, v, base); });
+}
+
 /*static*/ const char* string_converter<int32_t>::from_string(std::string_view s, int32_t& val, bool* ok) {
     const char *end = s.data() + s.size(), *p = scvt::skip_spaces(s.data(), end);
     const char* p1 = scvt::to_signed(p, end, val);
@@ -737,10 +1734,27 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 }
 
 /*static*/ std::string string_converter<int32_t>::to_string(int32_t val, scvt_base base) {
-    std::array<char, 32> s;
+    std::array<char, kMaxChars> s;
     return static_cast<std::string>(scvt::from_signed(s.data() + s.size(), val, base));
 }
 
+/*static*/ char* string_converter<int32_t>::to_chars(char* first, char* last, int32_t val, scvt_base base) {
+    std::array<char, kMaxChars> s;
+    return scvt::copy_chars(first, last, scvt::from_signed(s.data() + s.size(), val, base));
+}
+
+/*static*/ size_t string_converter<int32_t>::from_strings(span<const std::string_view> s, span<int32_t> val,
+                                                          span<uint64_t> error_mask) {
+    return scvt::from_strings(s, val, error_mask, [](const char* p, const char* end, int32_t& v) {
+        return scvt::to_signed(p, end, v);
+    });
+}
+
+/*static*/ void string_converter<int32_t>::to_strings(span<const int32_t> val, std::string& out, std::string_view sep,
+                                                      scvt_base base) {
+    scvt::to_strings<kMaxChars>(val, out, sep, [base](char* p, int32_t v) { return scvt::from_signed(p, v, base); });
+}
+
 /*static*/ const char* string_converter<int64_t>::from_string(std::string_view s, int64_t& val, bool* ok) {
     const char *end = s.data() + s.size(), *p = scvt::skip_spaces(s.data(), end);
     const char* p1 = scvt::to_signed(p, end, val);
@@ -749,10 +1763,27 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 }
 
 /*static*/ std::string string_converter<int64_t>::to_string(int64_t val, scvt_base base) {
-    std::array<char, 32> s;
+    std::array<char, kMaxChars> s;
     return static_cast<std::string>(scvt::from_signed(s.data() + s.size(), val, base));
 }
 
+/*static*/ char* string_converter<int64_t>::to_chars(char* first, char* last, int64_t val, scvt_base base) {
+    std::array<char, kMaxChars> s;
+    return scvt::copy_chars(first, last, scvt::from_signed(s.data() + s.size(), val, base));
+}
+
+/*static*/ size_t string_converter<int64_t>::from_strings(span<const std::string_view> s, span<int64_t> val,
+                                                          span<uint64_t> error_mask) {
+    return scvt::from_strings(s, val, error_mask, [](const char* p, const char* end, int64_t& v) {
+        return scvt::to_signed(p, end, v);
+    });
+}
+
+/*static*/ void string_converter<int64_t>::to_strings(span<const int64_t> val, std::string& out, std::string_view sep,
+                                                      scvt_base base) {
+    scvt::to_strings<kMaxChars>(val, out, sep, [base](char* p, int64_t v) { return scvt::from_signed(p, v, base); });
+}
+
 /*static*/ const char* string_converter<uint16_t>::from_string(std::string_view s, uint16_t& val, bool* ok) {
     const char *end = s.data() + s.size(), *p = scvt::skip_spaces(s.data(), end);
     const char* p1 = scvt::to_unsigned(p, end, val);
@@ -761,10 +1792,27 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 }
 
 /*static*/ std::string string_converter<uint16_t>::to_string(uint16_t val, scvt_base base) {
-    std::array<char, 32> s;
+    std::array<char, kMaxChars> s;
     return static_cast<std::string>(scvt::from_unsigned(s.data() + s.size(), val, base));
 }
 
+/*static*/ char* string_converter<uint16_t>::to_chars(char* first, char* last, uint16_t val, scvt_base base) {
+    std::array<char, kMaxChars> s;
+    return scvt::copy_chars(first, last, scvt::from_unsigned(s.data() + s.size(), val, base));
+}
+
+/*static*/ size_t string_converter<uint16_t>::from_strings(span<const std::string_view> s, span<uint16_t> val,
+                                                           span<uint64_t> error_mask) {
+    return scvt::from_strings(s, val, error_mask, [](const char* p, const char* end, uint16_t& v) {
+        return scvt::to_unsigned(p, end, v);
+    });
+}
+
+/*static*/ void string_converter<uint16_t>::to_strings(span<const uint16_t> val, std::string& out, std::string_view sep,
+                                                       scvt_base base) {
+    scvt::to_strings<kMaxChars>(val, out, sep, [base](char* p, uint16_t v) { return scvt::from_unsigned(p, v, base); });
+}
+
 /*static*/ const char* string_converter<uint32_t>::from_string(std::string_view s, uint32_t& val, bool* ok) {
     const char *end = s.data() + s.size(), *p = scvt::skip_spaces(s.data(), end);
     const char* p1 = scvt::to_unsigned(p, end, val);
@@ -773,10 +1821,27 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 }
 
 /*static*/ std::string string_converter<uint32_t>::to_string(uint32_t val, scvt_base base) {
-    std::array<char, 32> s;
+    std::array<char, kMaxChars> s;
     return static_cast<std::string>(scvt::from_unsigned(s.data() + s.size(), val, base));
 }
 
+/*static*/ char* string_converter<uint32_t>::to_chars(char* first, char* last, uint32_t val, scvt_base base) {
+    std::array<char, kMaxChars> s;
+    return scvt::copy_chars(first, last, scvt::from_unsigned(s.data() + s.size(), val, base));
+}
+
+/*static*/ size_t string_converter<uint32_t>::from_strings(span<const std::string_view> s, span<uint32_t> val,
+                                                           span<uint64_t> error_mask) {
+    return scvt::from_strings(s, val, error_mask, [](const char* p, const char* end, uint32_t& v) {
+        return scvt::to_unsigned(p, end, v);
+    });
+}
+
+/*static*/ void string_converter<uint32_t>::to_strings(span<const uint32_t> val, std::string& out, std::string_view sep,
+                                                       scvt_base base) {
+    scvt::to_strings<kMaxChars>(val, out, sep, [base](char* p, uint32_t v) { return scvt::from_unsigned(p, v, base); });
+}
+
 /*static*/ const char* string_converter<uint64_t>::from_string(std::string_view s, uint64_t& val, bool* ok) {
     const char *end = s.data() + s.size(), *p = scvt::skip_spaces(s.data(), end);
     const char* p1 = scvt::to_unsigned(p, end, val);
@@ -785,10 +1850,27 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 }
 
 /*static*/ std::string string_converter<uint64_t>::to_string(uint64_t val, scvt_base base) {
-    std::array<char, 32> s;
+    std::array<char, kMaxChars> s;
     return static_cast<std::string>(scvt::from_unsigned(s.data() + s.size(), val, base));
 }
 
+/*static*/ char* string_converter<uint64_t>::to_chars(char* first, char* last, uint64_t val, scvt_base base) {
+    std::array<char, kMaxChars> s;
+    return scvt::copy_chars(first, last, scvt::from_unsigned(s.data() + s.size(), val, base));
+}
+
+/*static*/ size_t string_converter<uint64_t>::from_strings(span<const std::string_view> s, span<uint64_t> val,
+                                                           span<uint64_t> error_mask) {
+    return scvt::from_strings(s, val, error_mask, [](const char* p, const char* end, uint64_t& v) {
+        return scvt::to_unsigned(p, end, v);
+    });
+}
+
+/*static*/ void string_converter<uint64_t>::to_strings(span<const uint64_t> val, std::string& out, std::string_view sep,
+                                                       scvt_base base) {
+    scvt::to_strings<kMaxChars>(val, out, sep, [base](char* p, uint64_t v) { return scvt::from_unsigned(p, v, base); });
+}
+
 /*static*/ const char* string_converter<float>::from_string(std::string_view s, float& val, bool* ok) {
     const char *end = s.data() + s.size(), *p = scvt::skip_spaces(s.data(), end);
     const char* p1 = scvt::to_float(p, end, val);
@@ -797,10 +1879,28 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 }
 
 /*static*/ std::string string_converter<float>::to_string(float val, scvt_fp fmt, int prec) {
-    std::array<char, 128> s;
+    std::array<char, kMaxChars> s;
     return static_cast<std::string>(scvt::from_float(s.data() + s.size(), val, fmt, prec));
 }
 
+/*static*/ char* string_converter<float>::to_chars(char* first, char* last, float val, scvt_fp fmt, int prec) {
+    std::array<char, kMaxChars> s;
+    return scvt::copy_chars(first, last, scvt::from_float(s.data() + s.size(), val, fmt, prec));
+}
+
+/*static*/ size_t string_converter<float>::from_strings(span<const std::string_view> s, span<float> val,
+                                                        span<uint64_t> error_mask) {
+    return scvt::from_strings(s, val, error_mask, [](const char* p, const char* end, float& v) {
+        return scvt::to_float(p, end, v);
+    });
+}
+
+/*static*/ void string_converter<float>::to_strings(span<const float> val, std::string& out, std::string_view sep,
+                                                    scvt_fp fmt, int prec) {
+    scvt::to_strings<kMaxChars>(val, out, sep,
+                                [fmt, prec](char* p, float v) { return scvt::from_float(p, v, fmt, prec); });
+}
+
 /*static*/ const char* string_converter<double>::from_string(std::string_view s, double& val, bool* ok) {
     const char *end = s.data() + s.size(), *p = scvt::skip_spaces(s.data(), end);
     const char* p1 = scvt::to_float(p, end, val);
@@ -809,10 +1909,28 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 }
 
 /*static*/ std::string string_converter<double>::to_string(double val, scvt_fp fmt, int prec) {
-    std::array<char, 512> s;
+    std::array<char, kMaxChars> s;
     return static_cast<std::string>(scvt::from_float(s.data() + s.size(), val, fmt, prec));
 }
 
+/*static*/ char* string_converter<double>::to_chars(char* first, char* last, double val, scvt_fp fmt, int prec) {
+    std::array<char, kMaxChars> s;
+    return scvt::copy_chars(first, last, scvt::from_float(s.data() + s.size(), val, fmt, prec));
+}
+
+/*static*/ size_t string_converter<double>::from_strings(span<const std::string_view> s, span<double> val,
+                                                         span<uint64_t> error_mask) {
+    return scvt::from_strings(s, val, error_mask, [](const char* p, const char* end, double& v) {
+        return scvt::to_float(p, end, v);
+    });
+}
+
+/*static*/ void string_converter<double>::to_strings(span<const double> val, std::string& out, std::string_view sep,
+                                                     scvt_fp fmt, int prec) {
+    scvt::to_strings<kMaxChars>(val, out, sep,
+                                [fmt, prec](char* p, double v) { return scvt::from_float(p, v, fmt, prec); });
+}
+
 /*static*/ const char* string_converter<bool>::from_string(std::string_view s, bool& val, bool* ok) {
     const char *end = s.data() + s.size(), *p = scvt::skip_spaces(s.data(), end), *p1 = p;
     if ((p1 = scvt::starts_with(p, end, "true")) > p) {
@@ -838,24 +1956,7 @@ std::string_view from_float(char* p, Ty val, scvt_fp fmt, int prec) {
 
 std::string sformat::str() const {
     std::string result;
-    auto p = fmt_.begin(), p0 = p;
-    while (p < fmt_.end()) {
-        if (*p != '%') {
-            ++p;
-            continue;
-        }
-        result.append(p0, p++);
-        if (p == fmt_.end()) {
-            return result;
-        } else if (std::isdigit(*p)) {
-            size_t n = static_cast<size_t>(*p++ - '0');
-            while ((p < fmt_.end()) && std::isdigit(*p)) { n = 10 * n + static_cast<size_t>(*p++ - '0'); }
-            if ((n > 0) && (n <= args_.size())) { result.append(args_[n - 1]); }
-            p0 = p;
-        } else {
-            p0 = p++;
-        }
-    }
-    result.append(p0, p);
+    result.reserve(fmt_.size() + buf_.size());
+    str(result);
     return result;
 }
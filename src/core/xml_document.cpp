@@ -0,0 +1,119 @@
+#include "core/xml_document.h"
+
+#include <cstring>
+#include <iterator>
+#include <new>
+
+using namespace util;
+
+bool xml_document::load(std::string_view buf, unsigned eager_depth) {
+    node_pages_.clear(), deferred_.clear();
+    arena_.clear();
+    node_count_ = 0;
+    if (names_ == &own_names_) { own_names_.clear(); }
+    if (buf.data() != own_buf_.data()) { std::string().swap(own_buf_); }
+    buf_ = buf;
+    new_node(node_t{std::string_view(), nullptr, 0, 0, 0, 0, 0, 1, 0});
+    has_errors_ = !parse(0, 0, buf.size(), 1, eager_depth);
+    return !has_errors_;
+}
+
+bool xml_document::load(std::istream& is, unsigned eager_depth) {
+    own_buf_.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    return load(own_buf_, eager_depth);
+}
+
+size_t xml_document::memory_usage() const {
+    return own_buf_.capacity() + arena_.allocated_size() + node_pages_.capacity() * sizeof(node_t*) +
+           deferred_.capacity() * sizeof(deferred_t);
+}
+
+uint32_t xml_document::new_node(const node_t& node) {
+    if (node_count_ % kNodePageSize == 0) { node_pages_.push_back(arena_.allocate<node_t>(kNodePageSize)); }
+    new (&this->node(node_count_)) node_t(node);
+    return node_count_++;
+}
+
+bool xml_document::parse(uint32_t parent, size_t from, size_t to, unsigned line, unsigned eager_depth) {
+    const std::string_view s = buf_.substr(from, to - from);
+    const auto store_string = [this](std::string_view v) {
+        if (v.data() >= buf_.data() && v.data() + v.size() <= buf_.data() + buf_.size()) { return v; }
+        return arena_.copy_string(v);  // decoded
+    };
+
+    const auto append_node = [this](node_t node) {
+        level_t& level = levels_.back();
+        node.parent = level.node;
+        const uint32_t index = new_node(node);
+        if (level.last_child) {
+            this->node(level.last_child).next_sibling = index;
+        } else {
+            this->node(level.node).first_child = index;
+        }
+        level.last_child = index;
+        return index;
+    };
+
+    xml_parser parser(s, names_);
+    parser.current_line_ = line;
+    levels_.clear();
+    levels_.push_back(level_t{parent, 0});
+    while (true) {
+        switch (parser.next_token()) {
+            case xml_parser_token::kEof: {
+                if (levels_.size() > 1) {
+                    parser.error(parser.token_line(), "unexpected end of file");
+                    return false;
+                }
+                return true;
+            } break;
+
+            case xml_parser_token::kPlainText: {
+                const std::string_view text = parser.text();
+                if (text.find_first_not_of(" \t\r\n") == std::string_view::npos) { break; }
+                append_node(node_t{store_string(text), nullptr, 0, 1, 0, 0, 0, parser.token_line(), 0});
+            } break;
+
+            case xml_parser_token::kSection: {
+                const auto attribute_count = static_cast<uint32_t>(parser.attributes().size());
+                attribute* attributes = attribute_count ? arena_.allocate<attribute>(attribute_count) : nullptr;
+                for (const auto& attr : parser.attributes()) {
+                    new (attributes++) attribute(attr.first.view(), store_string(attr.second));
+                }
+                const uint32_t index = append_node(node_t{parser.name().view(), attributes - attribute_count,
+                                                          attribute_count, 0, 0, 0, 0, parser.token_line(), 0});
+                if (levels_.size() >= eager_depth && !parser.is_empty_section_) {
+                    // defer the content if it contains markup
+                    const char* content = parser.p_;
+                    const unsigned content_line = parser.current_line_;
+                    if (!parser.skip_section_content()) { return false; }
+                    if (std::memchr(content, '<', parser.p_ - content)) {
+                        deferred_.push_back(deferred_t{from + (content - s.data()), from + (parser.p_ - s.data()),
+                                                       content_line});
+                        node(index).deferred = static_cast<uint32_t>(deferred_.size());
+                    } else {
+                        parser.p_ = content, parser.current_line_ = content_line;
+                    }
+                }
+                levels_.push_back(level_t{index, 0});
+            } break;
+
+            case xml_parser_token::kEndOfSection: {
+                if (levels_.size() == 1 || parser.name().data() != node(levels_.back().node).str.data()) {
+                    parser.error(parser.token_line(), "unexpected end of section");
+                    return false;
+                }
+                levels_.pop_back();
+            } break;
+
+            case xml_parser_token::kParsingError: return false;
+            default: break;
+        }
+    }
+}
+
+void xml_document::materialize(uint32_t index) {
+    const deferred_t deferred = deferred_[node(index).deferred - 1];
+    node(index).deferred = 0;
+    if (!parse(index, deferred.from, deferred.to, deferred.line, 1)) { has_errors_ = true; }
+}
@@ -0,0 +1,159 @@
+#include "core/xml_parallel_parser.h"
+
+#include <thread>
+
+using namespace util;
+
+namespace {
+
+// Returns position of the first element tag at or after `pos`, or the end of buffer
+size_t find_split_point(std::string_view buf, size_t pos) {
+    for (; (pos = buf.find('<', pos)) != std::string_view::npos; ++pos) {
+        if (pos + 1 == buf.size()) { break; }
+        const char ch = buf[pos + 1];
+        if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_' || ch == ':') { return pos; }
+    }
+    return buf.size();
+}
+
+}  // namespace
+
+struct xml_parallel_parser::chunk_t {
+    size_t from;
+    size_t to;
+    unsigned first_line = 1;  // lines are counted from the chunk start until the chunk is validated
+    unsigned line_count = 0;
+    unsigned line_offset = 0;  // is added to token lines when stitched
+    size_t first_token = 0;
+    size_t first_attribute = 0;
+    bool failed = false;
+    bool truncated = false;  // failed at the very end: the split point can be inside of markup
+    std::vector<token> tokens;
+    std::vector<attribute> attributes;
+    arena strings;
+    chunk_t(size_t in_from, size_t in_to) : from(in_from), to(in_to) {}
+};
+
+xml_parallel_parser::xml_parallel_parser(unsigned thread_count)
+    : thread_count_(thread_count ? thread_count : std::max(std::thread::hardware_concurrency(), 1u)) {}
+
+bool xml_parallel_parser::parse(std::string_view buf) {
+    tokens_.clear(), attributes_.clear(), strings_.clear();
+    names_.clear();
+
+    // split speculatively before element tags
+    const size_t max_chunk_count = std::max<size_t>(std::min<size_t>(thread_count_, buf.size() / kMinChunkSize), 1);
+    std::vector<chunk_t> chunks;
+    size_t from = 0;
+    for (size_t n = 1; n < max_chunk_count; ++n) {
+        const size_t pos = find_split_point(buf, std::max(n * (buf.size() / max_chunk_count), from + 1));
+        if (pos == buf.size()) { break; }
+        chunks.emplace_back(from, pos);
+        from = pos;
+    }
+    chunks.emplace_back(from, buf.size());
+
+    const auto for_each_chunk = [&chunks](const auto& fn) {
+        std::vector<std::thread> threads;
+        threads.reserve(chunks.size() - 1);
+        for (size_t n = 1; n < chunks.size(); ++n) { threads.emplace_back(fn, std::ref(chunks[n])); }
+        fn(chunks[0]);
+        for (auto& thread : threads) { thread.join(); }
+    };
+
+    for_each_chunk([this, buf](chunk_t& chunk) { parse_chunk(buf, chunk, false); });
+
+    // validate split points
+    bool success = true;
+    unsigned line_offset = 0;
+    size_t token_count = 0, attribute_count = 0;
+    for (size_t n = 0; n < chunks.size(); ++n) {
+        auto& chunk = chunks[n];
+        while (chunk.truncated && n + 1 < chunks.size()) {
+            chunk.to = chunks[n + 1].to;
+            chunks.erase(chunks.begin() + n + 1);
+            parse_chunk(buf, chunk, false);
+        }
+        if (chunk.failed) {  // the error is real: report it with actual line number
+            chunk.first_line = line_offset + 1;
+            parse_chunk(buf, chunk, true);
+            chunks.erase(chunks.begin() + n + 1, chunks.end());
+            success = false;
+        }
+        chunk.line_offset = line_offset + 1 - chunk.first_line;
+        chunk.first_token = token_count, chunk.first_attribute = attribute_count;
+        line_offset += chunk.line_count;
+        token_count += chunk.tokens.size(), attribute_count += chunk.attributes.size();
+    }
+
+    // stitch token streams
+    chunk_count_ = chunks.size();
+    if (chunks.size() == 1 && !chunks[0].line_offset) {
+        tokens_ = std::move(chunks[0].tokens), attributes_ = std::move(chunks[0].attributes);
+    } else {
+        tokens_.resize(token_count), attributes_.resize(attribute_count);
+        for_each_chunk([this](chunk_t& chunk) { stitch_chunk(chunk); });
+    }
+    for (auto& chunk : chunks) { strings_.emplace_back(std::move(chunk.strings)); }
+    return success;
+}
+
+void xml_parallel_parser::parse_chunk(std::string_view buf, chunk_t& chunk, bool report_errors) {
+    chunk.tokens.clear(), chunk.attributes.clear(), chunk.strings.clear();
+    chunk.line_count = 0, chunk.failed = chunk.truncated = false;
+
+    const std::string_view s = buf.substr(chunk.from, chunk.to - chunk.from);
+    const auto store_string = [&chunk, s](std::string_view v) {
+        if (v.data() >= s.data() && v.data() + v.size() <= s.data() + s.size()) { return v; }
+        return chunk.strings.copy_string(v);  // decoded
+    };
+
+    // names are interned into chunk's own pool, and then into the shared pool once per distinct name
+    string_pool chunk_names;
+    unordered_map<hashed_string_view, std::string_view, string_hash, string_equal_to> shared_names;
+    const auto intern = [this, &shared_names](hashed_string_view name) {
+        auto result = shared_names.emplace(name, std::string_view());
+        if (result.second) { result.first->second = names_.intern(name); }
+        return result.first->second;
+    };
+
+    xml_parser parser(s, &chunk_names);
+    parser.report_errors_ = report_errors, parser.current_line_ = chunk.first_line;
+    chunk.tokens.reserve(s.size() / 16);
+    while (true) {
+        const auto tt = parser.next_token();
+        if (tt == xml_parser_token::kEof) {
+            chunk.line_count = parser.token_line() - chunk.first_line;
+            return;
+        }
+
+        token tok{tt, parser.token_line(), std::string_view(), chunk.attributes.size(), 0};
+        if (tt == xml_parser_token::kParsingError) {
+            chunk.tokens.push_back(tok);
+            chunk.failed = true, chunk.truncated = parser.p_ == parser.end_;
+            return;
+        } else if (tt == xml_parser_token::kPlainText) {
+            tok.value = store_string(parser.text());
+        } else {
+            tok.value = intern(parser.name());
+            if (tt == xml_parser_token::kSection || tt == xml_parser_token::kDeclaration) {
+                for (const auto& attr : parser.attributes()) {
+                    chunk.attributes.emplace_back(intern(attr.first), store_string(attr.second));
+                }
+                tok.attribute_count = parser.attributes().size();
+            }
+        }
+        chunk.tokens.push_back(tok);
+    }
+}
+
+void xml_parallel_parser::stitch_chunk(chunk_t& chunk) {
+    auto out = tokens_.begin() + chunk.first_token;
+    for (const token& tok : chunk.tokens) {
+        *out++ = token{tok.type, tok.line + chunk.line_offset, tok.value, tok.first_attribute + chunk.first_attribute,
+                       tok.attribute_count};
+    }
+    std::copy(chunk.attributes.begin(), chunk.attributes.end(), attributes_.begin() + chunk.first_attribute);
+    std::vector<token>().swap(chunk.tokens);
+    std::vector<attribute>().swap(chunk.attributes);
+}
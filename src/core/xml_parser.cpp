@@ -1,10 +1,147 @@
 #include "core/xml_parser.h"
 
+#ifdef USE_SSE2
+#    include <emmintrin.h>
+#endif  // USE_SSE2
+
 using namespace util;
 
-xml_parser::xml_parser(std::istream& ins) : input_(ins) {}
+namespace {
+
+#ifdef USE_SSE2
+// Block of `N` x 16 bytes: byte classification results are packed into a bit mask, one bit per byte
+template<unsigned N>
+struct block_t {
+    __m128i v[N];
+    explicit block_t(const char* p) {
+        for (unsigned i = 0; i < N; ++i) { v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i); }
+    }
+    template<typename... Chars>
+    std::uint64_t mask(Chars... chars) const {
+        std::uint64_t result = 0;
+        for (unsigned i = 0; i < N; ++i) {
+            __m128i eq = _mm_setzero_si128();
+            ((eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v[i], _mm_set1_epi8(chars)))), ...);
+            result |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(eq))) << (16 * i);
+        }
+        return result;
+    }
+};
+
+// Advances `p` to the first of `stop` characters within the block, or past the block
+template<unsigned N, typename... Chars>
+bool scan_block(const char*& p, unsigned& lines, Chars... stop) {
+    const block_t<N> block(p);
+    const std::uint64_t stop_mask = block.mask(stop...), newline_mask = block.mask('\n');
+    if (stop_mask) {
+        const std::uint64_t skipped_newlines = newline_mask & ((stop_mask & (0 - stop_mask)) - 1);
+        if (skipped_newlines) { lines += count_ones(skipped_newlines); }
+        p += count_trailing_zeros(stop_mask);
+        return true;
+    }
+    if (newline_mask) { lines += count_ones(newline_mask); }
+    p += 16 * N;
+    return false;
+}
+#endif  // USE_SSE2
+
+template<typename... Chars>
+const char* skip_to_any_scalar(const char* p, const char* end, unsigned& lines, Chars... stop) {
+    for (; p < end; ++p) {
+        const char ch = *p;
+        if (((ch == stop) || ...)) { break; }
+        if (ch == '\n') { ++lines; }
+    }
+    return p;
+}
+
+// Returns pointer to the first of `stop` characters in [p, end) or `end`; newlines before the found position
+// are added to `lines`
+template<typename... Chars>
+const char* skip_to_any(const char* p, const char* end, unsigned& lines, Chars... stop) {
+#ifdef USE_SSE2
+    // short runs are the most common: check a few characters one by one before going wide
+    const char* last = p + std::min<ptrdiff_t>(end - p, 8);
+    if ((p = skip_to_any_scalar(p, last, lines, stop...)) != last) { return p; }
+    while (end - p >= 64) {
+        if (scan_block<4>(p, lines, stop...)) { return p; }
+    }
+    while (end - p >= 16) {
+        if (scan_block<1>(p, lines, stop...)) { return p; }
+    }
+#endif  // USE_SSE2
+    return skip_to_any_scalar(p, end, lines, stop...);
+}
+
+}  // namespace
+
+bool xml_parser::attribute_map::emplace(hashed_string_view name, std::string_view value) {
+    if (items_.size() < kMaxLinearLookup) {
+        if (find(name) != end()) { return false; }
+    } else {
+        if (items_.size() == kMaxLinearLookup) {  // switch to hashed lookup
+            for (size_t n = 0; n < items_.size(); ++n) { index_.emplace(items_[n].first, n); }
+        }
+        if (!index_.emplace(name, items_.size()).second) { return false; }
+    }
+    items_.emplace_back(name, value);
+    return true;
+}
+
+xml_parser::xml_parser(std::istream& ins, string_pool* names)
+    : input_(&ins), finished_(false), p_(own_buf_.data()), end_(p_), own_names_(1024),
+      names_(names ? names : &own_names_), strings_(1024) {}
+
+xml_parser::xml_parser(std::string_view buf, string_pool* names)
+    : p_(buf.data()), end_(buf.data() + buf.size()), own_names_(1024), names_(names ? names : &own_names_),
+      strings_(1024) {}
+
+xml_parser::xml_parser(string_pool* names)
+    : finished_(false), p_(own_buf_.data()), end_(p_), own_names_(1024), names_(names ? names : &own_names_),
+      strings_(1024) {}
+
+void xml_parser::feed(std::string_view chunk) {
+    assert(!finished_);
+    // drop consumed input: only the incomplete token is kept
+    own_buf_.erase(0, p_ - own_buf_.data());
+    own_buf_.append(chunk.data(), chunk.size());
+    p_ = own_buf_.data(), end_ = p_ + own_buf_.size();
+}
 
 xml_parser_token xml_parser::next_token() {
+    size_t read_size = kReadSize;
+    while (true) {
+        // incomplete markup is not parsed again until its end is received
+        if (!pending_markup_.is_valid || finished_ || scan_pending_markup()) {
+            pending_markup_.is_valid = false;
+            const char* token_start = p_;
+            const unsigned line = current_line_;
+            const auto tt = parse_token();
+            if (!need_more_data_) { return tt; }
+
+            // incomplete token: roll back and retry when more input is available
+            need_more_data_ = false;
+            if (!pending_text_.is_valid) {  // `start` is set by `parse_token`
+                pending_markup_.is_valid = true, pending_markup_.in_string = false;
+                pending_markup_.scanned = pending_markup_.start + 1;
+            }
+            p_ = token_start, current_line_ = line;
+        }
+        if (!input_) { return xml_parser_token::kNeedMoreData; }
+
+        // read straight into the buffer; the read size grows while the token stays incomplete
+        own_buf_.erase(0, p_ - own_buf_.data());
+        const size_t size = own_buf_.size();
+        own_buf_.resize(size + read_size);
+        input_->read(&own_buf_[size], static_cast<std::streamsize>(read_size));
+        own_buf_.resize(size + static_cast<size_t>(input_->gcount()));
+        p_ = own_buf_.data(), end_ = p_ + own_buf_.size();
+        if (!input_->good()) { finish(); }
+        read_size *= 2;
+    }
+}
+
+xml_parser_token xml_parser::parse_token() {
     token_line_ = current_line_;
 
     if (is_empty_section_) {
@@ -13,78 +150,105 @@ xml_parser_token xml_parser::next_token() {
         return xml_parser_token::kEndOfSection;
     }
 
-    text_.clear();
+    text_ = std::string_view();
+    const char* const token_start = p_;
+    bool decoded = false;         // is text in `text_buf_`
+    const char* text_from = p_;   // not yet consumed plain text
+    const char* text_start = p_;  // text start in buffer if not decoded
+    if (pending_text_.is_valid) {  // resume scanning of incomplete text
+        decoded = pending_text_.decoded, current_line_ = pending_text_.line;
+        text_start = token_start + pending_text_.text_start, text_from = token_start + pending_text_.text_from;
+        p_ = token_start + pending_text_.scanned;
+        pending_text_.is_valid = false;
+    }
+
+    // text is incomplete: its scanning will be resumed from `p`
+    const auto suspend_text = [this, token_start, &decoded, &text_start, &text_from](const char* p) {
+        pending_text_ = pending_text_t{true,
+                                       decoded,
+                                       current_line_,
+                                       static_cast<size_t>(text_start - token_start),
+                                       static_cast<size_t>(text_from - token_start),
+                                       static_cast<size_t>(p - token_start)};
+    };
 
     while (true) {
-        auto ch = input_.get();
-        if (!input_.good()) {
-            if (text_.empty()) { return xml_parser_token::kEof; }
+        p_ = skip_to_any(p_, end_, current_line_, '&', '<', '>');
+        if (p_ == end_) {
+            if (!finished_) {  // text can be continued
+                suspend_text(p_);
+                need_more_data_ = true;
+                return xml_parser_token::kNeedMoreData;
+            }
+            if (p_ == text_start && !decoded) { return xml_parser_token::kEof; }
             break;
         }
 
-        switch (ch) {
+        switch (*p_) {
             case '&':  // special character
             {
+                if (!decoded) { text_buf_.clear(), decoded = true; }
+                const char* const p_amp = p_;
+                text_buf_.append(text_from, p_++);
+                text_from = p_amp;
                 uint32_t code = 0;
                 if (!parse_special_character(code)) {
                     error(current_line_, "invalid special character");
+                    if (need_more_data_) { suspend_text(p_amp); }
                     return xml_parser_token::kParsingError;
                 }
-                to_utf8(code, std::back_inserter(text_));
+                to_utf8(code, std::back_inserter(text_buf_));
+                text_from = p_;
                 continue;
             }
 
-            case '\n':
-                ++current_line_;
-                text_.push_back(ch);
-                continue;
-
             case '<':  // tag opening
             {
-                if (!text_.empty()) {
-                    // return plain text first
-                    input_.unget();
-                    break;
-                }
+                if (p_ != text_start || decoded) { break; }  // return plain text first
 
+                pending_markup_.start = static_cast<size_t>(p_ - token_start);
+                ++p_;
                 auto type = xml_parser_token::kSection;
 
-                ch = input_.get();
+                std::string_view name;
+                char ch = get();
                 if (!ch) {
                     error(current_line_, "unexpected end of file");
                     return xml_parser_token::kParsingError;
-                } else if (try_parse_name(ch, text_)) {  // do nothing
+                } else if (try_parse_name(ch, name)) {  // do nothing
                 } else if ((ch == '/') || (ch == '?') || (ch == '!')) {
-                    auto next = input_.get();
-                    if (try_parse_name(next, text_)) {
+                    auto next = get();
+                    if (try_parse_name(next, name)) {
                         if (ch == '/') {
-                            if (input_.get() != '>') {
+                            if (get() != '>') {
                                 error(current_line_, "expected '/>' here");
                                 return xml_parser_token::kParsingError;
                             }
                             // end of not empty section
+                            name_ = names_->intern(name);
                             return xml_parser_token::kEndOfSection;
                         } else if (ch == '?') {
                             type = xml_parser_token::kDeclaration;
                         } else {
-                            if (text_ == "DOCTYPE") {
-                                text_.clear();
-                                if (!try_parse_name(ch = skip_spaces(), text_)) {
+                            if (name == "DOCTYPE") {
+                                if (!try_parse_name(ch = skip_spaces(), name)) {
                                     error(current_line_, "expected DOCTYPE name here");
                                     return xml_parser_token::kParsingError;
                                 }
                             }
 
                             if (!skip_up_to(">")) { return xml_parser_token::kParsingError; }
+                            name_ = names_->intern(name);
                             attributes_.clear();
                             return xml_parser_token::kDoctype;
                         }
                     } else if ((ch == '!') && (next == '-')) {
-                        if (input_.get() != '-') {
+                        if (get() != '-') {
                             error(current_line_, "expected '<!--' here");
                             return xml_parser_token::kParsingError;
                         }
                         if (!skip_up_to("-->")) { return xml_parser_token::kParsingError; }
+                        text_from = text_start = p_;
                         continue;  // read next token
                     } else {
                         error(current_line_, "expected tag name or '<!--' here");
@@ -95,11 +259,12 @@ xml_parser_token xml_parser::next_token() {
                     return xml_parser_token::kParsingError;
                 }
 
+                const std::string_view tag_name = name;  // is interned when the tag is complete
                 attributes_.clear();
+                strings_.clear();
 
                 // read attributes
                 while (true) {
-                    std::string name;
                     if (try_parse_name(ch = skip_spaces(), name)) {
                         // attribute found
                         if ((ch = skip_spaces()) != '=') {
@@ -110,18 +275,18 @@ xml_parser_token xml_parser::next_token() {
                             error(current_line_, "expected string here");
                             return xml_parser_token::kParsingError;
                         }
-                        std::string value;
+                        std::string_view value;
                         if (!parse_string(value)) { return xml_parser_token::kParsingError; }
-                        attributes_.emplace(std::move(name), std::move(value));
+                        attributes_.emplace(names_->intern(name), value);
                     } else if (type == xml_parser_token::kDeclaration) {
                         // end of declaration
-                        if ((ch != '?') || (input_.get() != '>')) {
+                        if ((ch != '?') || (get() != '>')) {
                             error(current_line_, "expected '?>' here");
                             return xml_parser_token::kParsingError;
                         }
                         break;
                     } else if (ch == '/') {
-                        if (input_.get() != '>') {
+                        if (get() != '>') {
                             error(current_line_, "expected '/>' here");
                             return xml_parser_token::kParsingError;
                         }
@@ -135,145 +300,178 @@ xml_parser_token xml_parser::next_token() {
                     }
                 }
 
+                name_ = names_->intern(tag_name);
                 return type;  // section header or declaration
             }
 
-            case '>':  // tag clocing
+            default:  // tag closing
                 error(current_line_, "not expected '>' here");
                 return xml_parser_token::kParsingError;
-
-            default: text_.push_back(ch); continue;
         }
 
         break;
     }
 
     // plain text token
+    if (decoded) {
+        text_buf_.append(text_from, p_);
+        text_ = text_buf_;
+    } else {
+        text_ = std::string_view(text_start, p_ - text_start);
+    }
     return xml_parser_token::kPlainText;
 }
 
+// Continues scanning of incomplete markup in the received input; returns `true` if its end is found: `-->` for
+// comments, the first `>` for `<!` declarations, the first `>` outside of attribute values for other tags
+bool xml_parser::scan_pending_markup() {
+    const char* const start = p_ + pending_markup_.start;
+    const std::string_view comment_open("<!--");
+    const size_t prefix_len = std::min<size_t>(end_ - start, comment_open.size());
+    if (std::string_view(start, prefix_len) == comment_open.substr(0, prefix_len)) {
+        if (prefix_len < comment_open.size()) { return false; }  // can be a comment yet
+        // the closing `-->` can begin in the previously scanned input
+        const size_t from = std::max(pending_markup_.start + comment_open.size() + 2, pending_markup_.scanned) - 2;
+        if (impl::find_substring(p_ + from, end_, "-->", 3) != end_) { return true; }
+    } else if (start[1] == '!') {
+        if (impl::find_first_of2(p_ + pending_markup_.scanned, end_, '>', '>') != end_) { return true; }
+    } else {
+        for (const char* p = p_ + pending_markup_.scanned;; ++p) {
+            const char stop = pending_markup_.in_string ? '\"' : '>';
+            if ((p = impl::find_first_of2(p, end_, stop, '\"')) == end_) { break; }
+            if (*p == '>') { return true; }
+            pending_markup_.in_string = !pending_markup_.in_string;
+        }
+    }
+    pending_markup_.scanned = static_cast<size_t>(end_ - p_);
+    return false;
+}
+
 void xml_parser::error(unsigned line, std::string_view description) {
+    if (!finished_ && p_ == end_) {  // not an error yet: the rest of the token is not received
+        need_more_data_ = true;
+        return;
+    }
+    if (!report_errors_) { return; }
     std::cout << description << " (" << line << ')' << std::endl;
 }
 
 char xml_parser::skip_spaces() {
-    while (true) {
-        static symb_table_t _is_blank{" \t\r"};
-        auto ch = input_.get();
-        while (_is_blank[ch]) { ch = input_.get(); }
-        if (!input_.good()) {  // eof found
-            return '\0';
-        } else if (ch != '\n') {
-            return ch;
+    static symb_table_t _is_blank{" \t\r"};
+    for (; p_ < end_; ++p_) {
+        if (*p_ == '\n') {
+            ++current_line_;
+        } else if (!_is_blank[static_cast<uint8_t>(*p_)]) {
+            return *p_++;  // significant character found
         }
-        // significant character found
-        ++current_line_;
     }
+    return '\0';  // eof found
 }
 
 bool xml_parser::skip_up_to(std::string_view sub) {
-    auto it = sub.begin();
-    while (it != sub.end()) {
-        auto ch = input_.get();
-        if (!input_.good()) {
+    assert(!sub.empty());
+    const char* found = sub.size() > 1 ? impl::find_substring(p_, end_, sub.data(), sub.size()) :
+                                         impl::find_first_of2(p_, end_, sub[0], sub[0]);
+    p_ = skip_to_any(p_, found, current_line_);  // count lines
+    if (found == end_) {
+        error(current_line_, "unexpected end of file");
+        return false;
+    }
+    p_ += sub.size();
+    return true;
+}
+
+// Skips content of the section which start tag is just read without validating it; `p_` is left at the end tag
+bool xml_parser::skip_section_content() {
+    for (unsigned depth = 0;;) {
+        p_ = skip_to_any(p_, end_, current_line_, '<');
+        if (end_ - p_ < 2) {
             error(current_line_, "unexpected end of file");
             return false;
-        } else if (ch == '\n') {
-            ++current_line_;
-        } else if (ch == *it) {
-            ++it;
+        }
+        const char ch = p_[1];
+        p_ += 2;
+        if (ch == '/') {
+            if (!depth) {
+                p_ -= 2;
+                return true;
+            }
+            --depth;
+            if (!skip_up_to(">")) { return false; }
+        } else if (ch == '!') {
+            if (!skip_up_to(end_ - p_ >= 2 && p_[0] == '-' && p_[1] == '-' ? "-->" : ">")) { return false; }
+        } else if (ch == '?') {
+            if (!skip_up_to("?>")) { return false; }
+        } else {  // start tag: attribute values can contain '>'
+            char stop = '\0';
+            while (stop != '>') {
+                p_ = skip_to_any(p_, end_, current_line_, '>', '\"');
+                if (p_ != end_ && (stop = *p_++) == '\"') { p_ = skip_to_any(p_, end_, current_line_, '\"'); }
+                if (p_ == end_) {
+                    error(current_line_, "unexpected end of file");
+                    return false;
+                }
+                if (stop == '\"') { ++p_; }
+            }
+            if (p_[-2] != '/') { ++depth; }
         }
     }
-    return true;
 }
 
-bool xml_parser::try_parse_name(char first, std::string& name) {
+bool xml_parser::try_parse_name(char first, std::string_view& name) {
     static symb_table_t _is_name_first_char{":_a-zA-Z"};
     if (!_is_name_first_char[static_cast<uint8_t>(first)]) { return false; }
-    name.push_back(first);
-    while (true) {
-        static symb_table_t _is_name_char{"---.:_0-9a-zA-Z"};
-        auto ch = input_.get();
-        if (!input_.good()) {  // eof found
-            break;
-        } else if (!_is_name_char[static_cast<uint8_t>(ch)]) {  // end of name found
-            input_.unget();
-            break;
-        }
-        name.push_back(ch);
-    }
+    static symb_table_t _is_name_char{"---.:_0-9a-zA-Z"};
+    const char* from = p_ - 1;  // `first` is already read
+    while ((p_ < end_) && _is_name_char[static_cast<uint8_t>(*p_)]) { ++p_; }
+    name = std::string_view(from, p_ - from);
     return true;
 }
 
 bool xml_parser::parse_special_character(uint32_t& code) {
-    auto ch = input_.get();
-    if (!input_.good()) {
-        return false;
-    } else if (ch == '#') {
-        int count = 0;
+    auto ch = get();
+    if (ch == '#') {
         code = 0;
-
-        ch = input_.get();
-        if ((ch == 'x') || (ch == 'X')) {
-            // hex code
-            while (true) {
-                code <<= 4;
-                ch = input_.get();
-                if ((ch >= '0') && (ch <= '9')) {
-                    code |= ch - '0';
-                } else if ((ch >= 'A') && (ch <= 'F')) {
-                    code |= ch - 'A' + 10;
-                } else if ((ch >= 'a') && (ch <= 'f')) {
-                    code |= ch - 'a' + 10;
-                } else if (ch == ';') {
-                    break;
-                } else {
-                    return false;
-                }
-                ++count;
-            }
+        const bool is_hex = (p_ < end_) && ((*p_ == 'x') || (*p_ == 'X'));
+        const char* from = is_hex ? ++p_ : p_;
+        while ((p_ < end_) && (*p_ != ';')) { ++p_; }
+        const auto count = static_cast<int>(std::min<ptrdiff_t>(p_ - from, 10));
+        if ((get() != ';') || (count == 0) || (count > (is_hex ? 8 : 9))) { return false; }
+        if (is_hex) {
+            bool ok = false;
+            code = from_hex(from, count, &ok);
+            return ok;
         }
-
         // decimal code
-        while (true) {
-            code *= 10;
-            ch = input_.get();
-            if ((ch >= '0') && (ch <= '9')) {
-                code += ch - '0';
-            } else if (ch == ';') {
-                break;
-            } else {
-                return false;
-            }
-            ++count;
+        for (; from != p_ - 1; ++from) {
+            if ((*from < '0') || (*from > '9')) { return false; }
+            code = 10 * code + static_cast<uint32_t>(*from - '0');
         }
-
-        return count != 0;
+        return true;
     }
 
-    std::array<char, 5> name;
-    for (size_t n = 0; n < name.size(); ch = input_.get(), ++n) {
-        if ((ch >= 'a') && (ch <= 'z')) {
-            name[n] = ch;
-        } else if (ch == ';') {
-            if (std::string_view(name.data(), n) == "lt") {
+    const char* from = p_ - 1;
+    for (size_t n = 0; n < 5; ch = get(), ++n) {
+        if (ch == ';') {
+            const std::string_view name(from, n);
+            if (name == "lt") {
                 code = '<';
                 return true;
-            } else if (std::string_view(name.data(), n) == "gt") {
+            } else if (name == "gt") {
                 code = '>';
                 return true;
-            } else if (std::string_view(name.data(), n) == "amp") {
+            } else if (name == "amp") {
                 code = '&';
                 return true;
-            } else if (std::string_view(name.data(), n) == "apos") {
+            } else if (name == "apos") {
                 code = '\'';
                 return true;
-            } else if (std::string_view(name.data(), n) == "quot") {
+            } else if (name == "quot") {
                 code = '\"';
                 return true;
             }
             break;
-        } else {
+        } else if ((ch < 'a') || (ch > 'z')) {
             break;
         }
     }
@@ -281,31 +479,39 @@ bool xml_parser::parse_special_character(uint32_t& code) {
     return false;
 }
 
-bool xml_parser::parse_string(std::string& str) {
-    auto ch = '\0';
+bool xml_parser::parse_string(std::string_view& str) {
+    const char* from = p_;
+    bool decoded = false;  // is string in `string_buf_`
     while (true) {
-        ch = input_.get();
-        if (!input_.good()) { break; }  // eof found
-        switch (ch) {
+        p_ = skip_to_any(p_, end_, current_line_, '&', '\"', '\n', '\0');
+        if (p_ == end_) { break; }  // eof found
+        switch (*p_) {
             case '&':  // special character
             {
+                if (!decoded) { string_buf_.clear(), decoded = true; }
+                string_buf_.append(from, p_++);
                 uint32_t code = 0;
                 if (!parse_special_character(code)) {
                     error(current_line_, "invalid special character");
                     return false;
                 }
-                to_utf8(code, std::back_inserter(str));
+                to_utf8(code, std::back_inserter(string_buf_));
+                from = p_;
                 continue;
             }
 
-            case '\n':
-            case '\0': break;        // enexpected end of string
-            case '\"': return true;  // end of string
-
-            default: {
-                str.push_back(ch);
-                continue;
+            case '\"': {  // end of string
+                if (decoded) {
+                    string_buf_.append(from, p_);
+                    str = strings_.copy_string(string_buf_);
+                } else {
+                    str = std::string_view(from, p_ - from);
+                }
+                ++p_;
+                return true;
             }
+
+            default: break;  // enexpected end of string
         }
 
         break;
@@ -0,0 +1,352 @@
+#include "core/map.h"
+#include "core/pool_allocator.h"
+#include "core/unordered_map.h"
+#include "core/unordered_set.h"
+#include "core/util_string.h"
+
+#include "tests.h"
+
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _DEBUG  // _DEBUG
+static const int N = 500;
+#else   // _DEBUG
+static const int N = 5000;
+#endif  // _DEBUG
+
+struct T_hash {
+    size_t operator()(const T& t) const { return std::hash<int>{}(static_cast<int>(t)); }
+    size_t operator()(int a) const { return std::hash<int>{}(a); }
+    using is_transparent = int;
+};
+
+struct T_equal_to {
+    bool operator()(const T& t1, const T& t2) const { return t1 == t2; }
+    bool operator()(int a, const T& t) const { return a == t; }
+    using is_transparent = int;
+};
+
+template<typename Set, typename RefSet>
+bool check_hashtbl(const Set& s, const RefSet& ref) {
+    if (s.size() != ref.size() || s.empty() != ref.empty()) { return false; }
+    if (static_cast<size_t>(std::distance(s.begin(), s.end())) != ref.size()) { return false; }
+    for (const auto& v : s) {
+        if (ref.count(static_cast<int>(v)) != 1) { return false; }
+    }
+    for (int v : ref) {
+        if (!s.contains(v) || s.find(v) == s.end() || static_cast<int>(*s.find(v)) != v) { return false; }
+    }
+    return true;
+}
+
+#define CHECK(...) \
+    if (!check_hashtbl(__VA_ARGS__)) { throw std::logic_error(report_error(__FILE__, __LINE__, "hashtbl mismatched")); }
+
+#define CHECK_EMPTY(...) \
+    if (((__VA_ARGS__).size() != 0) || ((__VA_ARGS__).begin() != (__VA_ARGS__).end())) { \
+        throw std::logic_error(report_error(__FILE__, __LINE__, "hashtbl is not empty")); \
+    }
+
+using set_type = util::unordered_set<T, T_hash, T_equal_to, util::pool_allocator<T>>;
+
+// --------------------------------------------
+
+static void test_0() {  // empty set
+    util::pool_allocator<void> al;
+
+    set_type s;
+    CHECK_EMPTY(s);
+    VERIFY(s.find(1) == s.end() && !s.contains(1) && s.count(1) == 0 && s.erase(1) == 0);
+
+    set_type s1(al);
+    CHECK_EMPTY(s1);
+    VERIFY(s1.get_allocator() == al);
+    s1.clear();
+    CHECK_EMPTY(s1);
+}
+
+static void test_1() {  // initialization
+    util::pool_allocator<void> al;
+
+    std::initializer_list<T> tst = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 3, 7};
+    std::set<int> ref = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+    set_type s(tst, al);
+    CHECK(s, ref);
+    VERIFY(s.get_allocator() == al);
+
+    set_type s1(tst.begin(), tst.end(), 100);
+    CHECK(s1, ref);
+    VERIFY(s1.bucket_count() >= 100);
+
+    s1 = {20, 21, 22};
+    CHECK(s1, std::set<int>{20, 21, 22});
+    s1 = std::initializer_list<T>{};
+    CHECK_EMPTY(s1);
+}
+
+static void test_2() {  // copy & move
+    util::pool_allocator<void> al1, al2;
+
+    std::initializer_list<T> tst = {1, 2, 3, 4, 5};
+    std::set<int> ref = {1, 2, 3, 4, 5};
+    set_type s(tst, al1);
+
+    set_type s1(s);
+    CHECK(s1, ref);
+    VERIFY(s1.get_allocator() == al1);
+
+    set_type s2(s, al2);
+    CHECK(s2, ref);
+    VERIFY(s2.get_allocator() == al2);
+
+    set_type s3(std::move(s1));
+    CHECK(s3, ref);
+    CHECK_EMPTY(s1);
+
+    set_type s4(std::move(s3), al2);  // different allocators -> per-element movement
+    CHECK(s4, ref);
+    VERIFY(s4.get_allocator() == al2);
+    CHECK_EMPTY(s3);
+
+    s1 = s4;
+    CHECK(s1, ref);
+    VERIFY(s1.get_allocator() == al1);  // not propagated
+    s2 = std::move(s1);
+    CHECK(s2, ref);
+    VERIFY(s2.get_allocator() == al1);  // propagated
+    CHECK_EMPTY(s1);
+
+    std::swap(s2, s3);
+    CHECK(s3, ref);
+    CHECK_EMPTY(s2);
+    VERIFY(s3.get_allocator() == al1);
+
+    unfriendly_pool_allocator<void> ual1, ual2;
+    util::unordered_set<T, T_hash, T_equal_to, unfriendly_pool_allocator<T>> u1(ual1), u2(ual2);
+    u1.insert(tst);
+    u2 = std::move(u1);  // not propagated -> per-element movement
+    CHECK(u2, ref);
+    VERIFY(u2.get_allocator() == ual2);
+}
+
+static void test_3() {  // random insertion & erasure against std::set
+    srand(0);
+    set_type s;
+    std::set<int> ref;
+    for (int iter = 0; iter < 20; ++iter) {
+        for (int i = 0; i < 500; ++i) {
+            int val = rand() % 1000;
+            auto result = s.emplace(val);
+            VERIFY(result.second == ref.insert(val).second);
+            VERIFY(static_cast<int>(*result.first) == val);
+        }
+        CHECK(s, ref);
+        for (int i = 0; i < 500; ++i) {
+            int val = rand() % 1000;
+            VERIFY(s.erase(val) == ref.erase(val));
+        }
+        CHECK(s, ref);
+        for (auto it = s.begin(); it != s.end();) {  // erase while iterating
+            if (static_cast<int>(*it) % 3 == 0) {
+                ref.erase(static_cast<int>(*it));
+                it = s.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        CHECK(s, ref);
+    }
+    s.rehash(0);
+    CHECK(s, ref);
+    s.clear();
+    CHECK_EMPTY(s);
+    VERIFY(T::cnt == 0 && T::inst_cnt == 0);
+}
+
+static void test_4() {  // map operations
+    util::unordered_map<std::string, int> m;
+    m["one"] = 1;
+    m["two"] = 2;
+    VERIFY(m.try_emplace("three", 3).second);
+    VERIFY(!m.try_emplace("three", 33).second && m.at("three") == 3);
+    VERIFY(!m.insert_or_assign("three", 33).second && m["three"] == 33);
+    VERIFY(m.insert({"four", 4}).second);
+    VERIFY(!m.emplace("four", 44).second && m["four"] == 4);
+    VERIFY(m.size() == 4 && m.count("two") == 1);
+
+    bool thrown = false;
+    try {
+        m.at("five");
+    } catch (const std::out_of_range&) { thrown = true; }
+    VERIFY(thrown);
+
+    auto m2 = m;
+    VERIFY(m2 == m);
+    m2["one"] = 11;
+    VERIFY(m2 != m);
+
+    for (int i = 0; i < 1000; ++i) { m[std::to_string(i)] = i; }
+    VERIFY(m.size() == 1004);
+    for (int i = 0; i < 1000; ++i) { VERIFY(m[std::to_string(i)] == i); }
+    VERIFY(m.load_factor() <= m.max_load_factor());
+}
+
+static void test_5() {  // node extraction
+    util::pool_allocator<void> al;
+    util::unordered_map<int, T, std::hash<int>, std::equal_to<int>, util::pool_allocator<std::pair<const int, T>>> m(al),
+        m2;
+    for (int i = 0; i < 100; ++i) { m.emplace(i, i); }
+
+    auto nh = m.extract(50);
+    VERIFY(!nh.empty() && nh.key() == 50 && static_cast<int>(nh.mapped()) == 50);
+    VERIFY(m.size() == 99 && !m.contains(50));
+    VERIFY(m.extract(50).empty());
+
+    nh.key() = 150;
+    auto result = m.insert(std::move(nh));
+    VERIFY(result.inserted && nh.empty() && result.position->first == 150);
+
+    nh = m.extract(m.find(10));
+    auto result2 = m.insert(std::move(nh));
+    VERIFY(result2.inserted);
+    nh = m.extract(m.find(10));
+    m.emplace(10, 100);
+    auto result3 = m.insert(std::move(nh));
+    VERIFY(!result3.inserted && !result3.node.empty() && static_cast<int>(result3.position->second) == 100);
+
+    m2.merge(m);
+    VERIFY(m.empty() && m2.size() == 100);
+    m.clear();
+    m2.clear();
+    VERIFY(T::cnt == 1 && T::inst_cnt == 1);  // result3.node still holds a value
+}
+
+static void test_6() {  // transparent lookup
+    util::unordered_set<T, T_hash, T_equal_to> s = {1, 2, 3};
+    auto inst_cnt = T::inst_cnt;
+    VERIFY(s.contains(2) && !s.contains(4) && s.count(3) == 1);
+    VERIFY(s.find(1) != s.end());
+    VERIFY(s.erase(2) == 1 && !s.contains(2));
+    VERIFY(T::inst_cnt == inst_cnt - 1);  // no temporary keys were constructed
+}
+
+// --------------------------------------------
+
+template<typename MapType>
+int performance(int iter_count) {
+    int result = 0;
+    MapType m;
+
+    srand(0);
+
+    auto start = std::clock();
+    for (int iter = 0; iter < 2 * iter_count; ++iter) {
+        m.clear();
+        for (int cnt = 0; cnt < 1000; ++cnt) m.emplace(rand() % 2000, cnt);
+    }
+    std::cout << " ins/clear=" << (std::clock() - start) << std::flush;
+
+    start = std::clock();
+    for (int iter = 0; iter < 100 * iter_count; ++iter)
+        for (auto it = m.begin(); it != m.end(); ++it) { result += it->second; }
+    std::cout << " iterate=" << (std::clock() - start) << std::flush;
+
+    start = std::clock();
+    for (int iter = 0; iter < 1000 * iter_count; ++iter) {
+        auto it = m.find(rand() % 2000);
+        if (it != m.end()) { result += it->second; }
+    }
+    std::cout << " find=" << (std::clock() - start) << std::flush;
+
+    start = std::clock();
+    for (int iter = 0; iter < iter_count; ++iter) {
+        m.clear();
+        for (int i = 0; i < 1000; ++i) m.emplace(rand() % 2000, i);
+        for (int i = 0; i < 1000; ++i) {
+            result += static_cast<int>(m.erase(rand() % 2000));
+            m.emplace(rand() % 2000, i);
+        }
+    }
+    std::cout << " integral=" << (std::clock() - start) << std::endl;
+
+    return result;
+}
+
+static void test_100() {
+    using value_type = std::pair<const int, int>;
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+#if defined(USE_UTIL)
+    std::cout << "---------- util::unordered_map<int, int> performance..." << std::flush;
+    performance<util::unordered_map<int, int>>(N);
+    std::cout << "---------- util::unordered_map<int, int, ..., util::pool_allocator<>> performance..." << std::flush;
+    performance<util::unordered_map<int, int, std::hash<int>, std::equal_to<int>, util::pool_allocator<value_type>>>(
+        N);
+    std::cout << "---------- util::map<int, int, ..., util::pool_allocator<>> performance..." << std::flush;
+    performance<util::map<int, int, std::less<int>, util::pool_allocator<value_type>>>(N);
+#endif
+#if defined(USE_STD)
+    std::cout << "---------- std::unordered_map<int, int> performance..." << std::flush;
+    performance<std::unordered_map<int, int>>(N);
+    std::cout << "---------- std::unordered_map<int, int, ..., util::pool_allocator<>> performance..." << std::flush;
+    performance<std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, util::pool_allocator<value_type>>>(N);
+#endif
+}
+
+static void test_101() {
+    std::cout << std::endl;
+    std::cout << "sizeof(util::unordered_set<int>) = " << sizeof(util::unordered_set<int>) << std::endl;
+    std::cout << "sizeof(util::unordered_set<int>::iterator) = " << sizeof(util::unordered_set<int>::iterator)
+              << std::endl;
+    std::cout << "sizeof(std::unordered_set<int>) = " << sizeof(std::unordered_set<int>) << std::endl;
+    std::cout << "sizeof(std::unordered_set<int>::iterator) = " << sizeof(std::unordered_set<int>::iterator)
+              << std::endl;
+}
+
+template<typename MapType, typename KeyType>
+int64_t string_key_performance(const std::vector<KeyType>& keys, int iter_count) {
+    int64_t result = 0;
+    MapType m;
+    for (size_t i = 0; i < keys.size(); ++i) { m.emplace(keys[i], static_cast<int>(i)); }
+    auto start = std::clock();
+    for (int iter = 0; iter < iter_count; ++iter) {
+        for (const auto& key : keys) { result += m.find(key)->second; }
+    }
+    std::cout << " find=" << (std::clock() - start) << std::endl;
+    return result;
+}
+
+static void test_102() {
+    std::vector<std::string> keys;
+    for (int i = 0; i < 1000; ++i) { keys.emplace_back("some/long/common/prefix/key" + std::to_string(i)); }
+    std::vector<util::hashed_string_view> hashed_keys(keys.begin(), keys.end());
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    const int64_t expected = 10 * N * int64_t(keys.size() * (keys.size() - 1) / 2);
+    std::cout << "---------- util::unordered_map<std::string, int> performance..." << std::flush;
+    VERIFY(string_key_performance<util::unordered_map<std::string, int>>(keys, 10 * N) == expected);
+    std::cout << "---------- util::unordered_map<util::hashed_string_view, int> performance..." << std::flush;
+    VERIFY(string_key_performance<
+               util::unordered_map<util::hashed_string_view, int, util::string_hash, util::string_equal_to>>(
+               hashed_keys, 10 * N) == expected);
+    std::cout << "---------- util::map<std::string, int> performance..." << std::flush;
+    VERIFY(string_key_performance<util::map<std::string, int>>(keys, 10 * N) == expected);
+    std::cout << "---------- util::map<util::hashed_string_view, int> performance..." << std::flush;
+    VERIFY(string_key_performance<util::map<util::hashed_string_view, int, util::hashed_string_less>>(
+               hashed_keys, 10 * N) == expected);
+    std::cout << "---------- util::map<util::hashed_string_view, int> performance, std::string probes..." << std::flush;
+    VERIFY(string_key_performance<util::map<util::hashed_string_view, int, util::hashed_string_less>>(
+               keys, 10 * N) == expected);
+}
+
+// --------------------------------------------
+
+std::pair<std::pair<size_t, void (*)()>*, size_t> get_hashtbl_tests() {
+    static std::pair<size_t, void (*)()> _tests[] = {
+        {0, test_0}, {1, test_1}, {2, test_2}, {3, test_3}, {4, test_4}, {5, test_5}, {6, test_6},
+        {100, test_100}, {101, test_101}, {102, test_102},
+    };
+
+    return std::make_pair(_tests, sizeof(_tests) / sizeof(_tests[0]));
+}
@@ -1,9 +1,20 @@
-﻿#include "core/math.h"
+﻿#include "core/arena.h"
+#include "core/map.h"
+#include "core/math.h"
+#include "core/rope.h"
+#include "core/stream.h"
+#include "core/string.h"
+#include "core/unordered_map.h"
+#include "core/util_pattern.h"
 #include "core/util_regex.h"
 
 #include "tests.h"
 
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
 #include <random>
+#include <unordered_set>
 
 template<typename Ty>
 static bool check_string_list(const Ty& v, std::initializer_list<std::string_view> tst) {
@@ -510,7 +521,7 @@ static void test_10() {
     }
 }
 
-#if defined(_MSC_VER) && (__cplusplus >= 201703L)
+#if __cplusplus >= 201703L
 #    include <charconv>
 #endif
 
@@ -645,12 +656,1554 @@ static void test_13() {
     VERIFY(v3.value<std::string>() == "-234.57");
 }
 
+static void test_14() {  // hashed string views as keys
+    std::string s1 = "hello", s2 = "hello", s3 = "world";
+    util::hashed_string_view h1(s1), h2(s2), h3(s3);
+    VERIFY(h1.hash() == util::hash_string(std::string_view("hello")) && h1.hash() == h2.hash());
+    VERIFY(h1 == h2 && h1 != h3 && h1.view() == "hello");
+    VERIFY(std::hash<util::hashed_string_view>{}(h1) == util::string_hash{}(std::string_view("hello")));
+    VERIFY(util::hash_string(std::string_view("")) != util::hash_string(std::string_view(std::string(1, '\0'))));
+
+    util::unordered_map<util::hashed_string_view, int, util::string_hash, util::string_equal_to> m;
+    util::map<util::hashed_string_view, int, util::hashed_string_less> tm;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; ++i) { keys.emplace_back("key" + std::to_string(i)); }
+    for (int i = 0; i < 100; ++i) {
+        VERIFY(m.emplace(keys[i], i).second);
+        VERIFY(tm.emplace(keys[i], i).second);
+    }
+    for (int i = 0; i < 100; ++i) {
+        std::string key = "key" + std::to_string(i);
+        util::hashed_string_view hkey(key);
+        VERIFY(m.find(hkey) != m.end() && m.find(hkey)->second == i);
+        VERIFY(m.find(key) != m.end() && m.find(key)->second == i);
+        VERIFY(m.find(std::string_view(key)) != m.end() && m.count(key.c_str()) == 1);
+        VERIFY(tm.find(hkey) != tm.end() && tm.find(hkey)->second == i);
+        VERIFY(tm.find(key) != tm.end() && tm.find(key)->second == i);
+        VERIFY(tm.find(std::string_view(key)) != tm.end() && tm.count(key.c_str()) == 1);
+    }
+    VERIFY(m.find("key100") == m.end() && tm.find("key100") == tm.end());
+    VERIFY(!m.emplace(util::hashed_string_view(keys[5]), 0).second && !tm.emplace(keys[5], 0).second);
+}
+
+static void test_15() {  // util::basic_string
+    util::string s;
+    VERIFY(s.empty() && s.is_inline() && s.capacity() == util::string::kInlineCapacity && *s.c_str() == '\0');
+    s = "short";
+    VERIFY(s == "short" && s.size() == 5 && s.is_inline() && s.c_str()[5] == '\0');
+    s += " string that does not fit inline";
+    VERIFY(s == "short string that does not fit inline" && !s.is_inline());
+    s.append(s.data(), 6);  // self-append with reallocation
+    VERIFY(s == "short string that does not fit inlineshort ");
+    s.insert(0, "<");
+    s.replace(1, 5, "long");
+    s.erase(s.size() - 6);
+    VERIFY(s == "<long string that does not fit inline");
+    s.replace(0, 1, s.view().substr(1, 4));  // self-replace
+    VERIFY(s == "longlong string that does not fit inline" && s.find("string") == 9 && s.rfind('n') == 38);
+    VERIFY(s.substr(4, 4) == "long" && s < "m" && s > "lonf" && "abc" < s && s != "long");
+
+    util::string s2(s), s3("abc"), s4(std::move(s2));
+    VERIFY(s2.empty() && s2.is_inline() && s4 == s && s3 == "abc");
+    s2 = std::move(s3);  // inline move
+    VERIFY(s2 == "abc" && s3.empty());
+    s2.swap(s4);  // inline <-> heap
+    VERIFY(s4 == "abc" && s2 == s);
+    s3.swap(s4);  // empty inline <-> inline
+    VERIFY(s3 == "abc" && s4.empty());
+    s2.resize(3);
+    s2.shrink_to_fit();
+    VERIFY(s2 == "lon" && s2.is_inline());
+    s2.resize(5, '!');
+    s2.push_back('?');
+    VERIFY(s2 == "lon!!?" && s2.back() == '?' && s2.front() == 'l');
+    VERIFY(s2 + "abc" == "lon!!?abc" && util::string("x") + 'y' == "xy");
+
+    util::basic_string<char, 55> s5(std::string_view("1234567890123456789012345678901234567890"));
+    VERIFY(s5.is_inline() && s5.size() == 40 && s5 == util::string(s5.view()));
+    VERIFY(std::hash<util::string>{}(util::string("abc")) == std::hash<std::string_view>{}("abc"));
+    std::unordered_set<util::string> set{util::string("a"), util::string("b")};
+    VERIFY(set.count(util::string("a")) == 1);
+}
+
+static void test_16() {  // util::basic_string with custom allocators
+    util::pool_allocator<void> al1, al2;
+    using pool_string = util::string_with_alloc<util::pool_allocator<char>>;
+    pool_string s1("a long string which is allocated from pool", al1), s2(al2);
+    s2 = s1;  // not propagated
+    VERIFY(s2 == s1 && s2.get_allocator() == al2);
+    s2 = std::move(s1);  // propagated
+    VERIFY(s2.get_allocator() == al1 && s1.empty());
+    pool_string s3(s2, al2);
+    VERIFY(s3 == s2 && s3.get_allocator() == al2);
+
+    util::arena arena(65536);
+    using arena_string = util::string_with_alloc<util::arena_allocator<char>>;
+    util::arena_allocator<char> arena_al(arena);
+    std::vector<arena_string> v;
+    auto new_cnt = new_counter::cnt.load();
+    arena_string s4(arena_al);
+    for (int i = 0; i < 100; ++i) { s4 += "some text to make the string long "; }
+    VERIFY(s4.size() == 3400 && new_counter::cnt == new_cnt + 1);  // the only arena block
+    VERIFY(arena.allocated_size() != 0);
+    arena_string s5(s4);
+    VERIFY(s5 == s4 && s5.get_allocator() == arena_al);
+}
+
+static void test_17() {  // string utilities output to custom string buffers
+    util::string buf;
+    util::replace_strings("1234***2345***678", util::sfind("***"), "abc", buf);
+    VERIFY(buf == "1234abc2345abc678");
+    buf.clear();
+    std::vector<std::string> words{"one", "two", "three"};
+    util::join_strings(words, ", ", buf);
+    VERIFY(buf == "one, two, three" && util::join_strings(words, "+") == "one+two+three");
+    buf.clear();
+    util::to_lower("MiXeD", buf);
+    VERIFY(buf == "mixed");
+    buf.clear();
+    util::encode_escapes("1234\\467;;", "\\;", "\\;", buf);
+    VERIFY(buf == "1234\\\\467\\;\\;");
+    util::basic_string<char, 31> buf2;
+    util::decode_escapes(buf, "\\;", "\\;", buf2);
+    VERIFY(buf2 == "1234\\467;;");
+}
+
+static void test_18() {  // rope against std::string
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> distribution(0, 2000);
+    std::string s;
+    util::rope r;
+    VERIFY(r.empty() && r == "" && r.find('a') == util::rope::npos);
+    for (int iter = 0; iter < 2000; ++iter) {
+        size_t pos = distribution(generator) % (s.size() + 1);
+        size_t n = distribution(generator) % 3 == 0 ? 2000 + distribution(generator) : distribution(generator) % 20;
+        std::string ins(n, static_cast<char>('a' + iter % 26));
+        switch (distribution(generator) % 4) {
+            case 0:
+            case 1: {
+                s.insert(pos, ins);
+                r.insert(pos, ins);
+            } break;
+            case 2: {
+                s.erase(pos, n);
+                r.erase(pos, n);
+            } break;
+            case 3: {
+                s.replace(pos, n / 2, ins);
+                r.replace(pos, n / 2, ins);
+            } break;
+        }
+        VERIFY(r.size() == s.size());
+        if (iter % 50 == 0) {
+            VERIFY(r == s && r.str() == s);
+            size_t sub_pos = distribution(generator) % (s.size() + 1);
+            VERIFY(r.substr(sub_pos, 3000) == std::string_view(s).substr(sub_pos, 3000));
+            VERIFY(r.str(sub_pos, 100) == s.substr(sub_pos, 100));
+            if (sub_pos < s.size()) { VERIFY(r[sub_pos] == s[sub_pos]); }
+            auto needle = s.substr(sub_pos, distribution(generator) % 6);
+            VERIFY(r.find(needle, sub_pos / 2) == s.find(needle, sub_pos / 2));
+            VERIFY(r.find('z', sub_pos) == s.find('z', sub_pos));
+        }
+    }
+
+    util::rope tail = r.split_off(s.size() / 2);
+    VERIFY(r == s.substr(0, s.size() / 2) && tail == s.substr(s.size() / 2));
+    r.append(std::move(tail));
+    VERIFY(r == s && tail.empty());
+    util::rope copy(r);
+    copy.erase(0, 1);
+    VERIFY(r == s && copy.compare(s) != 0 && copy == s.substr(1));
+
+    // failed allocation leaves the rope unchanged
+    const auto with_failed_alloc = [](const auto& fn) {
+        for (int n = 1;; ++n) {
+            new_counter::fail_at = new_counter::cnt + n;
+            try {
+                fn();
+            } catch (const std::bad_alloc&) {
+                continue;
+            }
+            new_counter::fail_at = -1;
+            return n;
+        }
+    };
+    const std::string mid(5000, '#');
+    VERIFY(with_failed_alloc([&r, &s, &mid]() {
+               try {
+                   r.insert(s.size() / 3 + 1, mid);
+               } catch (const std::bad_alloc&) {
+                   VERIFY(r == s);
+                   throw;
+               }
+           }) > 1);
+    s.insert(s.size() / 3 + 1, mid);
+    VERIFY(r == s);
+    with_failed_alloc([&r, &s]() {
+        try {
+            r.erase(s.size() / 3 + 1, s.size() / 3);
+        } catch (const std::bad_alloc&) {
+            VERIFY(r == s);
+            throw;
+        }
+    });
+    s.erase(s.size() / 3 + 1, s.size() / 3);
+    VERIFY(r == s);
+    with_failed_alloc([&r, &s]() { VERIFY(util::rope(r) == s); });
+
+    // matches spanning chunk boundaries
+    util::rope text(std::string(util::rope::kChunkSize - 2, '.') + "needle" + std::string(2000, '.'));
+    VERIFY(text.find("needle") == util::rope::kChunkSize - 2);
+    size_t offset = 0, count = 0;
+    for (std::string_view piece : text.pieces(10)) {
+        auto found = util::sfind('n')(piece.begin(), piece.end());
+        if (found.first != piece.end()) { offset = 10 + count + (found.first - piece.begin()); }
+        count += piece.size();
+    }
+    VERIFY(count == text.size() - 10 && offset == util::rope::kChunkSize - 2);
+}
+
+template<typename Ty>
+static Ty parse_exact(const std::string& s) {
+    return static_cast<Ty>(std::is_same<Ty, float>::value ? std::strtof(s.c_str(), nullptr) :
+                                                            std::strtod(s.c_str(), nullptr));
+}
+
+template<typename Ty>
+static void check_shortest(Ty val) {
+    auto s = util::to_string(val, util::scvt_fp::kShortestScientific);
+    Ty val1 = parse_exact<Ty>(s);
+    VERIFY(std::memcmp(&val, &val1, sizeof(Ty)) == 0);
+#if defined(__cpp_lib_to_chars) || defined(_MSC_VER)
+    char buf[64];
+    auto result = std::to_chars(buf, buf + sizeof(buf), val, std::chars_format::scientific);
+    VERIFY(s == std::string_view(buf, result.ptr - buf));
+#endif
+    // the current converter with the same precision differs in halfway cases only and also round-trips
+    size_t n_digs = s.find('e') - (s[0] == '-' ? 1 : 0) - (s.find('.') != std::string::npos ? 1 : 0);
+    auto s_prec = util::to_string(val, util::scvt_fp::kScientific, static_cast<int>(n_digs) - 1);
+    Ty val2 = parse_exact<Ty>(s_prec);
+    VERIFY(std::memcmp(&val, &val2, sizeof(Ty)) == 0);
+}
+
+static void test_19() {  // shortest round-trip floating point representation
+    VERIFY(util::to_string(0.1, util::scvt_fp::kShortest) == "0.1");
+    VERIFY(util::to_string(0.1f, util::scvt_fp::kShortest) == "0.1");
+    VERIFY(util::to_string(1. / 3, util::scvt_fp::kShortest) == "0.3333333333333333");
+    VERIFY(util::to_string(1.f / 3, util::scvt_fp::kShortest) == "0.33333334");
+    VERIFY(util::to_string(100000., util::scvt_fp::kShortest) == "100000");
+    VERIFY(util::to_string(1.e16, util::scvt_fp::kShortest) == "10000000000000000");
+    VERIFY(util::to_string(1.e17, util::scvt_fp::kShortest) == "1e+17");
+    VERIFY(util::to_string(1.e23, util::scvt_fp::kShortest) == "1e+23");
+    VERIFY(util::to_string(-123.456, util::scvt_fp::kShortest) == "-123.456");
+    VERIFY(util::to_string(0.0001234, util::scvt_fp::kShortest) == "0.0001234");
+    VERIFY(util::to_string(0.00001234, util::scvt_fp::kShortest) == "1.234e-05");
+    VERIFY(util::to_string(5.e-324, util::scvt_fp::kShortest) == "5e-324");
+    VERIFY(util::to_string(1.7976931348623157e308, util::scvt_fp::kShortest) == "1.7976931348623157e+308");
+    VERIFY(util::to_string(0., util::scvt_fp::kShortest) == "0");
+    VERIFY(util::to_string(-0., util::scvt_fp::kShortest) == "-0");
+    VERIFY(util::to_string(std::numeric_limits<double>::infinity(), util::scvt_fp::kShortest) == "inf");
+    VERIFY(util::to_string(-std::numeric_limits<float>::infinity(), util::scvt_fp::kShortest) == "-inf");
+    VERIFY(util::to_string(std::numeric_limits<double>::quiet_NaN(), util::scvt_fp::kShortest) == "nan");
+    VERIFY(util::to_string(123.456, util::scvt_fp::kShortestScientific) == "1.23456e+02");
+    VERIFY(util::to_string(0., util::scvt_fp::kShortestScientific) == "0e+00");
+    VERIFY(util::to_string(1.e-5, util::scvt_fp::kShortestFixed) == "0.00001");
+    VERIFY(util::to_string(1.5e20, util::scvt_fp::kShortestFixed) == "150000000000000000000");
+    VERIFY(util::to_string(123.456, util::scvt_fp::kShortestFixed, 1) == "123.456");
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution;
+    for (uint32_t n = 0; n < 1000; ++n) {  // small denormalized values
+        double d = 0;
+        float f = 0;
+        uint64_t u64 = n;
+        std::memcpy(&d, &u64, sizeof(d));
+        std::memcpy(&f, &n, sizeof(f));
+        check_shortest(d), check_shortest(f);
+    }
+    for (int iter = 0; iter < 1000000; ++iter) {
+        uint64_t u64 = distribution(generator);
+        auto u32 = static_cast<uint32_t>(u64 >> 32);
+        double d = 0;
+        float f = 0;
+        std::memcpy(&d, &u64, sizeof(d));
+        std::memcpy(&f, &u32, sizeof(f));
+        if (!std::isnan(d)) { check_shortest(d); }
+        if (!std::isnan(f)) { check_shortest(f); }
+    }
+}
+
+template<typename Ty>
+static void check_parsed(const std::string& s) {
+    Ty val = util::from_string<Ty>(s), val_exact = parse_exact<Ty>(s);
+    VERIFY(std::memcmp(&val, &val_exact, sizeof(Ty)) == 0);
+}
+
+static void test_20() {  // correctly rounded decimal to binary conversion
+    for (const char* s : {"0.1", "9007199254740993", "9007199254740992.5", "2.2250738585072011e-308",
+                          "4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324",
+                          "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308", "1e-400",
+                          "1e400", "1e23", "8.589973e9", "7.038531e-26", "3.4028235e38", "3.4028236e38",
+                          "1.1754943e-38", "1.4e-45", "7e-46", "7.1e-46", "5e-324", "123456789012345678901234567890",
+                          "1.00000000000000011102230246251565404236316680908203125", "0.000000000000000000000001",
+                          "2.1340085699250200196e274", "807508438066489698448e-28", "-0.00000000000000000000000000"
+                          "0000000000000000000000000000000000000000000000000000000000000000000000000123456789e10"}) {
+        check_parsed<double>(s), check_parsed<float>(s);
+    }
+
+    // exactly halfway with more digits than kept exactly: only nonzero tail rounds up
+    const std::string halfway = "1.00000000000000011102230246251565404236316680908203125" + std::string(1000, '0');
+    for (const std::string& s : {halfway, halfway + "1", halfway + "e0", halfway + "1e-0", "0." + halfway.substr(2)}) {
+        check_parsed<double>(s), check_parsed<float>(s);
+    }
+    VERIFY(util::from_string<double>(halfway) == 1. && util::from_string<double>(halfway + "1") > 1.);
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution;
+    char buf[64];
+    for (int iter = 0; iter < 1000000; ++iter) {
+        uint64_t u64 = distribution(generator);
+        auto u32 = static_cast<uint32_t>(u64 >> 32);
+        double d = 0;
+        float f = 0;
+        std::memcpy(&d, &u64, sizeof(d));
+        std::memcpy(&f, &u32, sizeof(f));
+        const int prec = static_cast<int>(u64 % 18);
+        if (std::isfinite(d)) {
+            snprintf(buf, sizeof(buf), "%.*e", prec, d);
+            check_parsed<double>(buf), check_parsed<float>(buf);
+        }
+        if (std::isfinite(f)) {
+            snprintf(buf, sizeof(buf), "%.*g", prec % 9 + 1, f);
+            check_parsed<float>(buf);
+            const float f_next = std::nextafter(f, f + 1.f);  // exactly halfway between two floats
+            snprintf(buf, sizeof(buf), "%.17g", 0.5 * (static_cast<double>(f) + static_cast<double>(f_next)));
+            check_parsed<float>(buf);
+        }
+    }
+
+    std::uniform_int_distribution<int> digit_distribution(0, 9), length_distribution(1, 25);
+    std::string digits;
+    for (int iter = 0; iter < 300000; ++iter) {  // up to 25 significant digits
+        digits.resize(static_cast<size_t>(length_distribution(generator)));
+        for (char& ch : digits) { ch = static_cast<char>('0' + digit_distribution(generator)); }
+        const int exp = static_cast<int>(distribution(generator) % 680) - 350;
+        check_parsed<double>(digits + 'e' + std::to_string(exp));
+        check_parsed<float>(digits.substr(0, 1) + '.' + digits.substr(1) + 'e' + std::to_string(exp % 50));
+    }
+}
+
+static void test_21() {  // integer conversions
+    VERIFY(util::to_string(std::numeric_limits<int64_t>::min()) == "-9223372036854775808");
+    VERIFY(util::to_string(std::numeric_limits<int32_t>::min()) == "-2147483648");
+    VERIFY(util::to_string(std::numeric_limits<uint64_t>::max()) == "18446744073709551615");
+    VERIFY(util::to_string(int32_t(-1), util::scvt_base::kBase16) == "ffffffff");
+    VERIFY(util::to_string(int16_t(-8), util::scvt_base::kBase8) == "177770");
+    VERIFY(util::to_string(uint32_t(0xabcdef), util::scvt_base::kBase16) == "abcdef");
+    VERIFY(util::from_string<int64_t>("-9223372036854775808") == std::numeric_limits<int64_t>::min());
+    VERIFY(util::from_string<int32_t>("-2147483648") == std::numeric_limits<int32_t>::min());
+    VERIFY(util::from_string<uint64_t>("18446744073709551615") == std::numeric_limits<uint64_t>::max());
+    VERIFY(util::from_string<int>("  0000000000000000000000123") == 123);
+
+    std::string digits = "12345678901234567890";
+    for (size_t len = 1; len <= digits.size(); ++len) {
+        const uint64_t val = std::stoull(digits.substr(0, len));
+        VERIFY(util::to_string(val) == digits.substr(0, len));
+        for (std::string_view tail : {"", "x", "-1", ".5", "abcdefghijklmnop"}) {
+            bool ok = false;
+            uint64_t val1 = 0;
+            std::string s = digits.substr(0, len) + std::string(tail);
+            const char* p = util::string_converter<uint64_t>::from_string(s, val1, &ok);
+            VERIFY(ok && val1 == val && p == s.data() + len);
+        }
+    }
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution;
+    for (int iter = 0; iter < 100000; ++iter) {
+        const auto val = static_cast<int64_t>(distribution(generator)) >> (iter % 64);
+        VERIFY(util::to_string(val) == std::to_string(val));
+        VERIFY(util::from_string<int64_t>(std::to_string(val)) == val);
+        VERIFY(util::to_string(static_cast<int32_t>(val)) == std::to_string(static_cast<int32_t>(val)));
+        VERIFY(util::from_string<int32_t>(std::to_string(static_cast<int32_t>(val))) == static_cast<int32_t>(val));
+    }
+}
+
+static void test_22() {  // batch conversions
+    std::vector<std::string_view> fields{"12", " -7 ", "", "3x", "  ", "2147483647", "-2147483648", "+5"};
+    std::vector<int32_t> ints(fields.size(), 100);
+    std::vector<uint64_t> mask(1, ~0ull);
+    VERIFY(util::from_strings<int32_t>(fields, ints, util::span<uint64_t>(mask)) == 3);
+    VERIFY(mask[0] == 0x1c);
+    VERIFY((ints == std::vector<int32_t>{12, -7, 0, 0, 0, 2147483647, -2147483647 - 1, 5}));
+    VERIFY(util::from_strings<int32_t>(util::span<const std::string_view>(fields.data(), 2), ints) == 0);
+
+    std::vector<std::string_view> fp_fields{"1.5", "-0.25e2", "nan?", "1e400"};
+    std::vector<double> doubles(fp_fields.size());
+    VERIFY(util::from_strings<double>(fp_fields, doubles) == 1);
+    VERIFY(doubles[0] == 1.5 && doubles[1] == -25. && doubles[2] == 0. && std::isinf(doubles[3]));
+
+    std::string out = "values:";
+    util::to_strings<int32_t>(ints, out, ",");
+    VERIFY(out == "values:12,-7,0,0,0,2147483647,-2147483648,5");
+    out.clear();
+    util::to_strings<int32_t>(ints, out, ",", util::scvt_base::kBase16);
+    VERIFY(out == "c,fffffff9,0,0,0,7fffffff,80000000,5");
+    out.clear();
+    util::to_strings<double>(doubles, out, "; ", util::scvt_fp::kShortest);
+    VERIFY(out == "1.5; -25; 0; inf");
+    out.clear();
+    util::to_strings<double>(util::span<const double>(), out);
+    VERIFY(out.empty());
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution;
+    std::vector<uint64_t> values(10000);
+    for (size_t n = 0; n < values.size(); ++n) { values[n] = distribution(generator) >> (n % 64); }
+    util::to_strings<uint64_t>(values, out);
+    auto lines = util::unpack_strings(out, '\n');
+    VERIFY(lines.size() == values.size());
+    std::vector<std::string_view> views(lines.begin(), lines.end());
+    std::vector<uint64_t> values1(values.size());
+    VERIFY(util::from_strings<uint64_t>(views, values1) == 0 && values1 == values);
+}
+
+static void test_23() {  // allocation-free conversions into caller buffers
+    char buf[32];
+    char* last = util::to_chars(buf, buf + sizeof(buf), -12345);
+    VERIFY(std::string_view(buf, last - buf) == "-12345");
+    last = util::to_chars(buf, buf + sizeof(buf), 255u, util::scvt_base::kBase16);
+    VERIFY(std::string_view(buf, last - buf) == "ff");
+    last = util::to_chars(buf, buf + sizeof(buf), 0.1, util::scvt_fp::kShortest);
+    VERIFY(std::string_view(buf, last - buf) == "0.1");
+    last = util::to_chars(buf, buf + sizeof(buf), true);
+    VERIFY(std::string_view(buf, last - buf) == "true");
+    VERIFY(util::to_chars(buf, buf + 5, -12345) == buf);
+    VERIFY(util::to_chars(buf, buf + 6, -12345) == buf + 6);
+
+    std::string s = "x=";
+    util::append_to(s, 42);
+    util::append_to(util::append_to(s, 42) += ',', 1.5, util::scvt_fp::kFixed, 2);
+    VERIFY(s == "x=4242,1.50");
+    util::basic_string<char, 15> s2;
+    util::append_to(s2, std::numeric_limits<uint64_t>::max());
+    VERIFY(s2 == "18446744073709551615");
+
+    std::vector<int> ints{1, -2, 3};
+    VERIFY(util::join_strings(ints, ", ") == "1, -2, 3");
+    std::vector<double> doubles{0.5, 2.};
+    VERIFY(util::join_strings(doubles, "; ") == "0.5; 2");
+    VERIFY(util::join_strings(ints, "|", [](int v) { return 10 * v; }) == "10|-20|30");
+
+    std::string out;
+    out.reserve(256);
+    auto new_cnt = new_counter::cnt.load();
+    util::append_to(out, 1.25e-300, util::scvt_fp::kScientific, 2);
+    util::append_to(out, std::numeric_limits<int64_t>::min());
+    VERIFY(new_counter::cnt == new_cnt && out == "1.25e-300-9223372036854775808");
+}
+
+static void test_24() {  // format layout parsed at compile time
+    const auto& layout = UTIL_SFORMAT_LAYOUT("%1%3%4%%abcdefghi%2%%");
+    using layout_t = std::decay_t<decltype(layout)>;
+    static_assert(layout_t::arg_count() == 4 && layout_t::size() == 6, "bad layout");
+    std::string s;
+    VERIFY(util::sformat_to(s, layout, "A", "B", "C", "D") == "ACD%abcdefghiB%");
+    s.clear();
+    VERIFY(util::sformat_to(s, UTIL_SFORMAT_LAYOUT("%1%3abcdefghi%2%"), "A", "B", "C") == "ACabcdefghiB");
+    s.clear();
+    VERIFY(util::sformat_to(s, UTIL_SFORMAT_LAYOUT("%4%3%2%1"), "1", "2", "3", "4") == "4321");
+    s.clear();
+    VERIFY(util::sformat_to(s, UTIL_SFORMAT_LAYOUT("%2"), "1", "2", "3") == "2");  // unused arguments are allowed
+    s.clear();
+    VERIFY(util::sformat_to(s, UTIL_SFORMAT_LAYOUT("%1"), util::sarg(5, util::sfield(150, '.'))) ==
+           std::string(149, '.') + "5");
+    s.clear();
+    VERIFY(util::sformat_to(s, UTIL_SFORMAT_LAYOUT("abcdefghi")) == "abcdefghi");
+    s.clear();
+    VERIFY(util::sformat_to(s, UTIL_SFORMAT_LAYOUT("%1|%2|%3"), 1, util::sarg(1, util::sfield(8, '*')),
+                            util::sarg(2.34, util::sfield(8, '*'), util::scvt_fp::kFixed, 2)) == "1|*******1|****2.34");
+    s.clear();
+    const std::string str = "str";
+    VERIFY(util::sformat_to(s, UTIL_SFORMAT_LAYOUT("%1 %2 %3 %4"), str, std::string_view("sv"),
+                            util::sarg(255u, util::scvt_base::kBase16), true) == "str sv ff true");
+
+    util::basic_string<char, 31> s2;
+    util::sformat_to(s2, UTIL_SFORMAT_LAYOUT("[%2] %1"), -5, 'x' == 'x');
+    VERIFY(s2 == "[true] -5");
+
+    std::ostringstream ss;
+    util::sformat_to(ss, UTIL_SFORMAT_LAYOUT("%1=%2;"), "a", 0.5) << "end";
+    VERIFY(ss.str() == "a=0.5;end");
+
+    s.clear();
+    s.reserve(256);
+    auto new_cnt = new_counter::cnt.load();
+    util::sformat_to(s, layout, 1.25, std::numeric_limits<int64_t>::min(), util::sarg(7, util::sfield(3, '0')), "x");
+    VERIFY(new_counter::cnt == new_cnt && s == "1.25007x%abcdefghi-9223372036854775808%");
+}
+
+static void test_25() {  // output sinks
+    std::ostringstream ss;
+    util::ostream_sink os_sink(ss);
+    util::append_to(os_sink, 42).append(" ", 1);
+    util::sformat("%1-%2").arg("a").arg(1.5).str(os_sink);
+    ss << ' ' << util::sformat("[%1]").arg(7, util::sfield(3, '0'));
+    VERIFY(ss.str() == "42 a-1.5 [007]");
+
+    char buf[10];
+    util::buffer_sink b_sink(buf);
+    util::sformat("%1=%2").arg("key").arg(-123).str(b_sink);
+    VERIFY(b_sink.view() == "key=-123" && !b_sink.truncated());
+    util::append_to(b_sink, 4567);
+    VERIFY(b_sink.view() == "key=-12345" && b_sink.truncated());
+    b_sink.clear();
+    util::sformat_to(b_sink, UTIL_SFORMAT_LAYOUT("%1%2"), "ab", 1.25);
+    VERIFY(b_sink.view() == "ab1.25" && !b_sink.truncated());
+
+    util::arena arena(1024);
+    util::arena_sink a_sink(arena, 4);
+    for (int n = 0; n < 100; ++n) { util::append_to(a_sink, n).append(",", 1); }
+    VERIFY(a_sink.size() == 290 && a_sink.view().substr(0, 6) == "0,1,2," && a_sink.view().substr(284) == "98,99,");
+    VERIFY(arena.allocated_size() == 1024);  // grown in place
+    util::arena_sink a_sink2(arena, 4);
+    util::append_to(a_sink, 1234567);
+    util::append_to(a_sink2, 8);
+    VERIFY(a_sink.view().substr(284) == "98,99,1234567" && a_sink2.view() == "8");
+
+    std::FILE* f = std::tmpfile();
+    VERIFY(f != nullptr);
+    std::string expected;
+    {
+        util::fd_sink fd_sink(file_descriptor(f), 16);
+        for (int n = 0; n < 100; ++n) {
+            util::sformat_to(fd_sink, UTIL_SFORMAT_LAYOUT("line %1\n"), n);
+            util::sformat_to(expected, UTIL_SFORMAT_LAYOUT("line %1\n"), n);
+        }
+        fd_sink.append(expected.data(), 40);  // bigger than the buffer
+        expected.append(expected.data(), 40);
+        VERIFY(fd_sink.good());
+    }
+    std::rewind(f);
+    std::string contents(expected.size() + 1, '\0');
+    contents.resize(std::fread(&contents[0], 1, contents.size(), f));
+    std::fclose(f);
+    VERIFY(contents == expected);
+
+#if !defined(_WIN32)  // invalid descriptors abort in Windows CRT
+    util::fd_sink bad_sink(-1, 16);  // writing fails: the rest of output is dropped
+    bad_sink.append(expected.data(), 10);
+    VERIFY(bad_sink.good());
+    bad_sink.append(expected.data(), 10).append(expected.data(), 40);
+    VERIFY(!bad_sink.good() && !bad_sink.flush());
+#endif  // !_WIN32
+}
+
+// Byte-by-byte finders: reference implementations
+struct simple_char_finder {
+    char ch;
+    using is_finder = int;
+    using iterator = std::string_view::const_iterator;
+    std::pair<iterator, iterator> operator()(iterator begin, iterator end) const {
+        for (; begin < end; ++begin) {
+            if (*begin == '\\') {
+                if (++begin == end) { break; }
+            } else if (*begin == ch) {
+                return std::make_pair(begin, begin + 1);
+            }
+        }
+        return std::make_pair(end, end);
+    }
+};
+
+struct simple_substring_finder {
+    std::string_view s;
+    using is_finder = int;
+    using iterator = std::string_view::const_iterator;
+    std::pair<iterator, iterator> operator()(iterator begin, iterator end) const {
+        if (static_cast<size_t>(end - begin) < s.size()) { return std::make_pair(end, end); }
+        for (auto last = end - s.size(); begin <= last; ++begin) {
+            if (std::equal(begin, begin + s.size(), s.begin())) { return std::make_pair(begin, begin + s.size()); }
+        }
+        return std::make_pair(end, end);
+    }
+};
+
+static void test_26() {  // vectorized finders
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> ch_distribution(0, 5);
+    const char alphabet[] = "ab,\\\0x";
+    for (int iter = 0; iter < 2000; ++iter) {
+        std::string s(iter % 100, 'a');
+        for (char& ch : s) { ch = alphabet[ch_distribution(generator)]; }
+        std::string_view sv(s);
+        for (size_t from = 0; from <= std::min<size_t>(sv.size(), 20); ++from) {
+            const auto begin = sv.begin() + from;
+            for (char ch : {',', 'b', '\0', 'z'}) {
+                VERIFY(util::sfind(ch)(begin, sv.end()) == simple_char_finder{ch}(begin, sv.end()));
+            }
+            for (std::string_view needle : {"", "a", ",", "ab", "a,b", "\\,", "aaa", "b,ab", "ab,ab,ab,ab,ab,ab"}) {
+                VERIFY(util::sfind(needle)(begin, sv.end()) == simple_substring_finder{needle}(begin, sv.end()));
+            }
+        }
+    }
+
+    std::string long_str(1000, 'a');
+    long_str[997] = 'b', long_str[998] = ',';
+    std::string_view long_sv(long_str);
+    VERIFY(util::sfind(std::string_view("ab,"))(long_sv.begin(), long_sv.end()).first == long_sv.begin() + 996);
+    VERIFY(util::sfind(',')(long_sv.begin(), long_sv.end()).first == long_sv.begin() + 998);
+    long_str[998] = '\\';
+    VERIFY(util::sfind('a')(long_sv.begin() + 997, long_sv.end()).first == long_sv.end());
+    VERIFY(util::split_string("a,b\\,c,,d", util::sfind(',')) ==
+           std::vector<std::string_view>{"a", "b\\,c", "", "d"});
+}
+
+static void test_27() {  // lazy split ranges
+    auto to_vector = [](const auto& r) {
+        std::vector<std::string> v;
+        for (std::string_view piece : r) { v.emplace_back(piece); }
+        return v;
+    };
+    auto to_strings = [](const std::vector<std::string_view>& v) {
+        return std::vector<std::string>(v.begin(), v.end());
+    };
+
+    for (std::string_view s : {"", ",", "a", "a,b", ",a,,b,", "a\\,b,c\\", "abc,def,,ghi,jkl", "  a  b, c ,,d ",
+                               "a\\ b,\\", "\\", "a,\\"}) {
+        VERIFY(to_vector(util::lazy_split_string(s, util::sfind(','))) ==
+               to_strings(util::split_string(s, util::sfind(','))));
+        VERIFY(to_vector(util::lazy_split_string<util::split_flags::kSkipEmpty>(s, util::sfind(','))) ==
+               to_strings(util::split_string<util::split_flags::kSkipEmpty>(s, util::sfind(','))));
+        VERIFY(to_vector(util::lazy_split_string(s, util::sfind(std::string_view(",,")))) ==
+               to_strings(util::split_string(s, util::sfind(std::string_view(",,")))));
+        VERIFY(to_vector(util::lazy_separate_words(s, ',')) == to_strings(util::separate_words(s, ',')));
+        VERIFY(to_vector(util::lazy_separate_words(s, ' ')) == to_strings(util::separate_words(s, ' ')));
+        VERIFY(to_vector(util::lazy_unpack_strings(s, ',')) == util::unpack_strings(s, ','));
+    }
+
+    const std::string_view csv = "2024-01-01,12:00:00,INFO,first field,second field,third field,fourth field";
+    auto new_cnt = new_counter::cnt.load();
+    auto range = util::lazy_split_string(csv, util::sfind(','));
+    auto it = range.begin();
+    VERIFY(*it == "2024-01-01" && *++it == "12:00:00" && *++it == "INFO");
+    VERIFY(std::distance(range.begin(), range.end()) == 7);
+    auto it2 = util::lazy_split_string(csv.substr(11), util::sfind(',')).begin();  // outlives the range
+    VERIFY(*it2 == "12:00:00" && *++it2 == "INFO");
+    it2 = range.begin();
+    VERIFY(*it2 == "2024-01-01" && *++it2 == "12:00:00");
+    size_t count = 0;
+    for (std::string_view word : util::lazy_separate_words("one two  three\\ four", ' ')) { count += word.size(); }
+    VERIFY(count == 17);  // "one", "two", "three\\ four"
+    count = 0;
+    for (std::string_view field : util::lazy_unpack_strings(csv, ',')) { count += field.size(); }
+    VERIFY(count == csv.size() - 6);
+    VERIFY(new_counter::cnt == new_cnt);
+
+    auto unpack_range = util::lazy_unpack_strings("a\\,b,c\\\\d,e", ',');
+    auto unpack_it = unpack_range.begin();
+    VERIFY(*unpack_it == "a,b" && *++unpack_it == "c\\d" && *++unpack_it == "e" && ++unpack_it == unpack_range.end());
+}
+
+static void test_28() {  // bulk UTF validation and transcoding
+    VERIFY(util::is_valid_utf8(""));
+    VERIFY(util::is_valid_utf8("plain ASCII text which is longer than sixteen bytes"));
+    VERIFY(util::is_valid_utf8("\xD0\x94\xD0\xBE\xE4\xB8\x8B\xF0\x9F\x98\x80\xF4\x8F\xBF\xBF\xEF\xBF\xBF"));
+    VERIFY(util::find_invalid_utf8("abc\x80") == 3);                      // stray continuation byte
+    VERIFY(util::find_invalid_utf8("abc\xC0\x80") == 3);                  // overlong
+    VERIFY(util::find_invalid_utf8("abcd\xE0\x9F\xBF") == 4);             // overlong
+    VERIFY(util::find_invalid_utf8("0123456789abcdef\xED\xA0\x80") == 16);  // surrogate
+    VERIFY(util::find_invalid_utf8("\xF4\x90\x80\x80") == 0);            // above 0x10FFFF
+    VERIFY(util::find_invalid_utf8("\xF8\x88\x80\x80\x80") == 0);
+    VERIFY(util::find_invalid_utf8("ab\xE4\xB8") == 2);                   // truncated
+    VERIFY(util::find_invalid_utf8("ab\xE4\xB8x") == 2);
+    VERIFY(util::find_invalid_utf16(u"ab\xD83D\xDE00" u"c") == 5);
+    VERIFY(util::find_invalid_utf16(u"ab\xDE00") == 2);
+    VERIFY(util::find_invalid_utf16(u"ab\xD83D") == 2);
+    char16_t ch16[2];
+    VERIFY(util::to_utf16(0xFE4E, ch16) == 1 && ch16[0] == 0xFE4E);  // not a surrogate
+
+    // compare with code point at a time conversion on random strings
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint32_t> kind_distribution(0, 7);
+    std::uniform_int_distribution<uint32_t> code_distribution(0, 0x10FFFF);
+    for (int iter = 0; iter < 2000; ++iter) {
+        std::string s;
+        std::u16string s16;
+        std::u32string s32;
+        for (int n = iter % 50; n > 0; --n) {
+            const uint32_t kind = kind_distribution(generator);
+            uint32_t code = kind < 4 ? code_distribution(generator) & 0x7F :
+                                       code_distribution(generator) >> (kind == 4 ? 9 : kind == 5 ? 4 : 0);
+            if ((code & 0xFFFFF800) == 0xD800) { code = 0xFFFD; }
+            util::to_utf8(code, std::back_inserter(s));
+            util::to_utf16(code, std::back_inserter(s16));
+            s32 += static_cast<char32_t>(code);
+        }
+        VERIFY(util::is_valid_utf8(s) && util::find_invalid_utf16(s16) == s16.size());
+        std::u16string out16(s.size(), 0);
+        auto res = util::utf8_to_utf16(s, &out16[0]);
+        VERIFY(res.ok && res.in_count == s.size() && out16.substr(0, res.out_count) == s16);
+        std::u32string out32(s.size(), 0);
+        res = util::utf8_to_utf32(s, &out32[0]);
+        VERIFY(res.ok && out32.substr(0, res.out_count) == s32);
+        std::string out8(4 * s32.size(), '\0');
+        res = util::utf16_to_utf8(s16, &out8[0]);
+        VERIFY(res.ok && res.in_count == s16.size() && out8.substr(0, res.out_count) == s);
+        res = util::utf32_to_utf8(s32, &out8[0]);
+        VERIFY(res.ok && out8.substr(0, res.out_count) == s);
+        VERIFY(util::from_wide_to_utf8(util::from_utf8_to_wide(s)) == s);
+        if (!s.empty()) {  // corrupt one byte
+            const size_t pos = iter % s.size();
+            s[pos] = '\xFF';
+            VERIFY(util::find_invalid_utf8(s) <= pos);
+            res = util::utf8_to_utf16(s, &out16[0]);
+            VERIFY(!res.ok && res.in_count == util::find_invalid_utf8(s));
+        }
+    }
+
+    std::u16string out16(32, 0);
+    auto res = util::utf8_to_utf16("0123456789abcdef\xD0\x94\xED\xA0\x80", &out16[0]);
+    VERIFY(!res.ok && res.in_count == 18 && res.out_count == 17 && out16.substr(0, 17) == u"0123456789abcdef\x414");
+    std::string out8(64, '\0');
+    res = util::utf16_to_utf8(u"0123456789abcdef\x414\xDC00", &out8[0]);
+    VERIFY(!res.ok && res.in_count == 17 && res.out_count == 18 && out8.substr(0, 18) == "0123456789abcdef\xD0\x94");
+    res = util::utf32_to_utf8(U"a\x110000", &out8[0]);
+    VERIFY(!res.ok && res.in_count == 1 && res.out_count == 1);
+    VERIFY(util::from_utf8_to_wide("abc\xC0\x80\xD0\x94") == std::wstring(L"abc\0\x414", 5));  // lenient
+
+    // wide strings hold UTF-16 with any `wchar_t` size; the rest of invalid input is converted leniently
+    const std::string_view emoji = "\xF0\x9F\x98\x80";
+    VERIFY(util::from_utf8_to_wide(emoji) == L"\xD83D\xDE00" && util::from_wide_to_utf8(L"\xD83D\xDE00") == emoji);
+    VERIFY(util::from_utf8_to_wide(std::string(emoji) + "\xFF" + std::string(emoji)) ==
+           L"\xD83D\xDE00\xFF\xD83D\xDE00");
+    VERIFY(util::from_wide_to_utf8(L"\xD83D\xDE00\xDC00\x42\xD83D\xDE00") ==
+           std::string(emoji) + "\xED\xB0\x80" "B" + std::string(emoji));
+    if (sizeof(wchar_t) == 4) {  // code points above 0xFFFF are accepted too
+        std::wstring wide{L'A', static_cast<wchar_t>(0x1F600), L'\xD83D', L'\xDE00'};
+        VERIFY(util::from_wide_to_utf8(wide) == "A" + std::string(emoji) + std::string(emoji));
+        wide.insert(1, 1, L'\xDC00');
+        VERIFY(util::from_wide_to_utf8(wide) == "A\xED\xB0\x80" + std::string(emoji) + std::string(emoji));
+    }
+    const std::string narrow = util::from_wide_to_utf8(std::wstring(1000, L'\x414'));
+    VERIFY(narrow.size() == 2000 && narrow.capacity() < 2 * narrow.size());  // no excess storage
+}
+
+// --------------------------------------------
+
+template<typename StrTy>
+void string_alloc_performance(int iter_count, StrTy& buf) {
+    std::vector<std::string_view> words{"alpha", "beta", "gamma", "delta", "epsilon"};
+    auto new_cnt = new_counter::cnt.load();
+    auto start = std::clock();
+    size_t total = 0;
+    for (int iter = 0; iter < iter_count; ++iter) {
+        buf.clear();
+        util::join_strings(words, ",", buf);
+        total += buf.size();
+        buf.clear();
+        util::replace_strings("path/to/some/file", util::sfind('/'), "::", buf);
+        total += buf.size();
+        buf.clear();
+        util::encode_escapes("a;b;c\\d", "\\;", "\\;", buf);
+        total += buf.size();
+    }
+    std::cout << " time=" << (std::clock() - start) << " allocs=" << (new_counter::cnt - new_cnt)
+              << " total=" << total << std::endl;
+}
+
+static void test_29() {  // case mapping and case-insensitive comparison
+    const auto upper = [](unsigned char ch) { return ch >= 'a' && ch <= 'z' ? ch - 'a' + 'A' : ch; };
+    const auto reference_compare = [&upper](std::string_view lhs, std::string_view rhs) {
+        for (size_t n = 0; n < std::min(lhs.size(), rhs.size()); ++n) {
+            const int ch1 = upper(lhs[n]), ch2 = upper(rhs[n]);
+            if (ch1 != ch2) { return ch1 < ch2 ? -1 : 1; }
+        }
+        return lhs.size() < rhs.size() ? -1 : (rhs.size() < lhs.size() ? 1 : 0);
+    };
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> ch_distribution(0, 11);
+    std::uniform_int_distribution<size_t> pos_distribution(0, 99);
+    const char alphabet[] = "aAzZ@[`{_\x80\xC3\xE1";
+    for (int iter = 0; iter < 2000; ++iter) {
+        std::string s1(iter % 100, 'a');
+        for (char& ch : s1) { ch = alphabet[ch_distribution(generator)]; }
+        std::string s2 = s1;
+        for (char& ch : s2) { ch = (ch_distribution(generator) & 1) ? ch : util::impl::to_lower_ascii(ch); }
+        if (!s2.empty() && (iter & 1)) { s2[pos_distribution(generator) % s2.size()] = alphabet[iter % 12]; }
+        if (iter & 2) { s2.resize(s2.size() - s2.size() / 8); }
+
+        const int result = util::compare_strings_nocase(s1, s2);
+        VERIFY(result == reference_compare(s1, s2) && -result == util::compare_strings_nocase(s2, s1));
+        std::string lower, expected_lower, expected_upper;
+        for (unsigned char ch : s1) {
+            expected_lower += static_cast<char>(ch >= 'A' && ch <= 'Z' ? ch - 'A' + 'a' : ch);
+            expected_upper += static_cast<char>(upper(ch));
+        }
+        VERIFY(util::to_lower(s1) == expected_lower && util::to_lower(s1, lower) == expected_lower);
+        VERIFY(util::to_upper(s1) == expected_upper);
+        const int folded_result = util::to_upper(s1).compare(util::to_upper(s2));  // compared with `memcmp`
+        VERIFY((folded_result > 0) - (folded_result < 0) == result);
+    }
+
+    util::map<std::string, int, util::less_nocase<>> nocase_map{{"Alpha", 1}, {"beta", 2}, {"GAMMA", 3}};
+    VERIFY(nocase_map.find(std::string_view("ALPHA"))->second == 1 && nocase_map.find("Gamma")->second == 3);
+    VERIFY(nocase_map.find("delta") == nocase_map.end());
+    VERIFY(util::equal_to_nocase<>{}("\xC3\xA9t\xC3\xA9", "\xC3\xA9T\xC3\xA9"));
+    VERIFY(!util::equal_to_nocase<>{}("\xC3\xA9", "\xC3\x89"));  // non-ASCII letters are not mapped
+}
+
+static void test_30() {  // escape table
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> ch_distribution(0, 9);
+    const char alphabet[] = "ab;\\\n\0\"x\t&";
+    const std::pair<std::string_view, std::string_view> tables[] = {
+        {"\\;", "\\;"},
+        {std::string_view("\\\n\t\"\0", 5), std::string_view("\\nt\"0", 5)},
+        {"\\;\n\t\"&abcdefgh", "\\;nt\"&ABCDEFGH"},  // too many characters for vectorized search
+    };
+    for (const auto& [symb, code] : tables) {
+        const util::escape_table table(symb, code);
+        for (int iter = 0; iter < 1000; ++iter) {
+            std::string s(iter % 200, 'a');
+            for (char& ch : s) { ch = alphabet[ch_distribution(generator)]; }
+            const std::string encoded = util::encode_escapes(s, symb, code);
+            VERIFY(table.encoded_size(s) == encoded.size() && table.encode(s) == encoded);
+            std::string buf = "prefix";
+            VERIFY(table.encode(s, buf) == "prefix" + encoded);
+            VERIFY(table.decode(encoded) == s);
+
+            // arbitrary input including unknown escape codes and trailing `\`
+            const std::string decoded = util::decode_escapes(s, symb, code);
+            VERIFY(table.decoded_size(s) == decoded.size() && table.decode(s) == decoded);
+            buf.clear();
+            VERIFY(table.decode(s, buf) == decoded);
+            table.decode_in_place(s);
+            VERIFY(s == decoded);
+        }
+    }
+}
+
+static void test_31() {  // linear-time pattern
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> len_distribution(0, 40), ch_distribution(0, 11);
+    const char alphabet[] = "aabbcx d,\t1\n";
+    const auto random_string = [&]() {
+        std::string s(len_distribution(generator), 'a');
+        for (char& ch : s) { ch = alphabet[ch_distribution(generator)]; }
+        return s;
+    };
+
+    // the same matches as `std::regex` gives
+    const char* patterns[] = {
+        "a", "ab", "a|b", "a*", "a+b", "(a|ab)(c|bcd)", "a*?b", "(a+)+b", "x{2,3}", "x{2,3}?", "x{2,}", "x{0,1}y",
+        "[a-c]+", "[^a]+", "\\d+", "\\w+\\s*", "^a", "b$", "^$", "\\bab", "a\\B", ".*", ".+?c", "(?:ab|a)(?:bc|c)?",
+        "(a*)*b", "(a|b)*abb", "[ \\t]+", ",\\s*", "(a?){3}a{3}", "ab|abc", "c|bc|abc", "a{0}b", "[]a]", "[\\]a-]+",
+        "\\x61", "(|a)+", "(a|)+b", "(a*)+", "(?:a*|b)*c", "a.c", "[\\d\\s]+", "\\D\\W", "b*$", "^b*", "(^a|b)+",
+    };
+    for (const char* re : patterns) {
+        const std::regex std_re(re);
+        const util::pattern pat(re);
+        for (int iter = 0; iter < 1000; ++iter) {
+            const std::string s = random_string();
+            const std::string_view v = s;
+            std::match_results<std::string_view::const_iterator> m;
+            const auto found = util::sfind(pat)(v.begin(), v.end());
+            if (std::regex_search(v.begin(), v.end(), m, std_re)) {
+                VERIFY(found.first == m[0].first && found.second == m[0].second);
+            } else {
+                VERIFY(found.first == v.end() && found.second == v.end());
+            }
+            VERIFY(pat.match(s) == std::regex_match(s, std_re));
+        }
+    }
+
+    // reversed finder gives the same for separators which can't be empty
+    for (const char* re : {"[ \\t]+", ",\\s*", "\\d+", "ab", "a+b", "x{2,3}"}) {
+        const std::regex std_re(re);
+        const util::pattern pat(re);
+        for (int iter = 0; iter < 1000; ++iter) {
+            const std::string s = random_string();
+            const std::string_view v = s;
+            VERIFY(util::rsfind(pat)(v.begin(), v.end()) == util::rsfind(std_re)(v.begin(), v.end()));
+        }
+    }
+
+    const std::string_view line = "forename\tmiddlename  surname \t \t phone";
+    const util::pattern sep("[ \\t]+");
+    VERIFY(util::string_section(line, util::sfind(sep), 2, 2) == "surname");
+    VERIFY(util::string_section(line, util::rsfind(sep), 2, 1) == "middlename  surname");
+    VERIFY(util::string_section(line, util::rsfind(sep), 0) == "phone");
+    CHECK(util::split_string(line, util::sfind(sep)), {"forename", "middlename", "surname", "phone"});
+    VERIFY(util::replace_strings(line, util::sfind(sep), " ") == "forename middlename surname phone");
+    VERIFY(util::replace_strings("a1b22c333", util::sfind(util::pattern("\\d+")), "#") == "a#b#c#");
+
+    // reversed search finds the match ending rightmost
+    const util::pattern alt("ab|abc"), lazy("a+?b");
+    std::pair<const char*, const char*> m;
+    const std::string_view s = "xaabcaab";
+    VERIFY(alt.reversed_search(s.data(), s.data() + 5, m) && m.first == s.data() + 2 && m.second == s.data() + 5);
+    VERIFY(lazy.reversed_search(s.data(), s.data() + s.size(), m) && m.first == s.data() + 6);
+    VERIFY(util::pattern("a+b").reversed_search(s.data(), s.data() + s.size(), m) && m.first == s.data() + 5);
+    VERIFY(!alt.reversed_search(s.data(), s.data() + 3, m));
+
+    VERIFY(util::pattern("abc+d").literal_prefix() == "ab");
+    VERIFY(util::pattern("(?:ab)|ac").literal_prefix().empty());
+
+    // no exponential backtracking
+    const std::string many_a(100000, 'a');
+    VERIFY(!util::pattern("(a*)*b").search(many_a.data(), many_a.data() + many_a.size(), m));
+    VERIFY(!util::pattern("(a|aa)*c").match(many_a));
+    VERIFY(util::pattern("(a|aa)*").match(many_a));
+
+    for (const char* re : {"(", "a)", "[a", "a**", "*", "a{2,1}", "a{", "a{1001}", "\\1", "(?=a)", "\\", "^*"}) {
+        bool is_thrown = false;
+        try {
+            const util::pattern pat(re);
+        } catch (const std::invalid_argument&) { is_thrown = true; }
+        VERIFY(is_thrown);
+    }
+}
+
+static void test_100() {
+    const int N = 1000000;
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- std::string results..." << std::flush;
+    {
+        std::vector<std::string_view> words{"alpha", "beta", "gamma", "delta", "epsilon"};
+        auto new_cnt = new_counter::cnt.load();
+        auto start = std::clock();
+        size_t total = 0;
+        for (int iter = 0; iter < N; ++iter) {
+            total += util::join_strings(words, ",").size();
+            total += util::replace_strings("path/to/some/file", util::sfind('/'), "::").size();
+            total += util::encode_escapes("a;b;c\\d", "\\;", "\\;").size();
+        }
+        std::cout << " time=" << (std::clock() - start) << " allocs=" << (new_counter::cnt - new_cnt)
+                  << " total=" << total << std::endl;
+    }
+    std::cout << "---------- reused std::string buffer..." << std::flush;
+    std::string std_buf;
+    string_alloc_performance(N, std_buf);
+    std::cout << "---------- util::string..." << std::flush;
+    util::basic_string<char, 31> buf;
+    string_alloc_performance(N, buf);
+    std::cout << "---------- util::string with arena allocator..." << std::flush;
+    util::arena arena;
+    util::string_with_alloc<util::arena_allocator<char>> arena_buf{util::arena_allocator<char>(arena)};
+    string_alloc_performance(N, arena_buf);
+}
+
+template<typename StrTy>
+size_t text_edit_performance(int iter_count, StrTy& text) {
+    std::default_random_engine generator;
+    std::uniform_int_distribution<size_t> distribution;
+    for (int iter = 0; iter < iter_count; ++iter) {
+        text.replace(distribution(generator) % (text.size() - 16), 4, "&amp;");
+        text.insert(distribution(generator) % text.size(), "<!-- -->");
+        text.erase(distribution(generator) % (text.size() - 16), 12);
+    }
+    return text.size();
+}
+
+static void test_101() {
+    const int N = 10000;
+    std::string doc;
+    for (int i = 0; doc.size() < 4 * 1024 * 1024; ++i) {
+        doc += "<item id=\"" + std::to_string(i) + "\">value</item>\n";
+    }
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- std::string edits..." << std::flush;
+    std::string s(doc);
+    auto start = std::clock();
+    size_t size1 = text_edit_performance(N, s);
+    std::cout << " time=" << (std::clock() - start) << std::endl;
+    std::cout << "---------- util::rope edits..." << std::flush;
+    util::rope r(doc);
+    start = std::clock();
+    size_t size2 = text_edit_performance(N, r);
+    std::cout << " time=" << (std::clock() - start) << std::endl;
+    VERIFY(size1 == size2 && r == s);
+}
+
+static void test_102() {
+    const int N = 2000000;
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> distribution(1., 10.);
+    std::uniform_int_distribution<int> exp_distribution(-300, 300);
+    std::vector<double> values(N);
+    for (auto& val : values) { val = distribution(generator) * std::pow(10, exp_distribution(generator)); }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    auto report = [N](const char* name, std::clock_t start, size_t total) {
+        std::cout << "---------- " << name << ": " << (std::clock() - start) * 1.e9 / CLOCKS_PER_SEC / N
+                  << " ns per value, total=" << total << std::endl;
+    };
+    size_t total = 0;
+    auto start = std::clock();
+    for (double val : values) { total += util::to_string(val, util::scvt_fp::kGeneral, 17).size(); }
+    report("util::to_string(kGeneral, 17)", start, total);
+    total = 0, start = std::clock();
+    for (double val : values) { total += util::to_string(val, util::scvt_fp::kShortest).size(); }
+    report("util::to_string(kShortest)", start, total);
+    char buf[64];
+    total = 0, start = std::clock();
+    for (double val : values) { total += snprintf(buf, sizeof(buf), "%.17g", val); }
+    report("snprintf(%.17g)", start, total);
+#if defined(__cpp_lib_to_chars) || defined(_MSC_VER)
+    total = 0, start = std::clock();
+    for (double val : values) { total += std::to_chars(buf, buf + sizeof(buf), val).ptr - buf; }
+    report("std::to_chars", start, total);
+#endif
+}
+
+static void test_103() {
+    const int N = 2000000;
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> distribution(1., 10.);
+    std::uniform_int_distribution<int> exp_distribution(-300, 300);
+    std::string text;
+    std::vector<std::string_view> numbers(N);
+    std::vector<size_t> offsets(N);
+    for (size_t& offset : offsets) {
+        offset = text.size();
+        text += util::to_string(distribution(generator) * std::pow(10, exp_distribution(generator)),
+                                util::scvt_fp::kShortest);
+        text += '\n';
+    }
+    for (int n = 0; n < N; ++n) {
+        numbers[n] = std::string_view(text.data() + offsets[n], text.find('\n', offsets[n]) - offsets[n]);
+    }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    auto report = [&text](const char* name, std::clock_t start, double total) {
+        const double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        std::cout << "---------- " << name << ": " << text.size() / (1024. * 1024.) / t << " MB/s, total=" << total
+                  << std::endl;
+    };
+    double total = 0, total_exact = 0;
+    auto start = std::clock();
+    for (std::string_view s : numbers) { total += util::from_string<double>(s); }
+    report("util::from_string<double>", start, total);
+    start = std::clock();
+    for (std::string_view s : numbers) { total_exact += std::strtod(s.data(), nullptr); }
+    report("std::strtod", start, total_exact);
+    VERIFY(total == total_exact);
+#if defined(__cpp_lib_to_chars) || defined(_MSC_VER)
+    total = 0, start = std::clock();
+    for (std::string_view s : numbers) {
+        double val = 0;
+        std::from_chars(s.data(), s.data() + s.size(), val);
+        total += val;
+    }
+    report("std::from_chars", start, total);
+#endif
+}
+
+static void test_104() {
+    const int N = 5000000;
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution;
+    std::vector<uint64_t> values(N);
+    for (uint64_t& val : values) { val = distribution(generator) >> (distribution(generator) % 64); }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    auto report = [](const char* name, std::clock_t start, size_t total) {
+        const double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        std::cout << "---------- " << name << ": " << total / (1024. * 1024.) / t << " MB/s" << std::endl;
+    };
+    for (auto base : {util::scvt_base::kBase8, util::scvt_base::kBase10, util::scvt_base::kBase16}) {
+        size_t total = 0;
+        auto start = std::clock();
+        for (uint64_t val : values) { total += util::to_string(val, base).size(); }
+        report(base == util::scvt_base::kBase8    ? "util::to_string base 8" :
+               base == util::scvt_base::kBase10 ? "util::to_string base 10" :
+                                                  "util::to_string base 16",
+               start, total);
+    }
+    size_t total = 0;
+    auto start = std::clock();
+    for (uint64_t val : values) { total += std::to_string(val).size(); }
+    report("std::to_string", start, total);
+
+    std::string text;
+    for (uint64_t val : values) { text += util::to_string(val) + '\n'; }
+    uint64_t sum = 0, sum_exact = 0;
+    start = std::clock();
+    for (const char *p = text.data(), *end = p + text.size(); p < end;) {
+        uint64_t val = 0;
+        p = util::string_converter<uint64_t>::from_string(std::string_view(p, end - p), val) + 1;
+        sum += val;
+    }
+    report("util::from_string base 10", start, text.size());
+    start = std::clock();
+    for (const char* p = text.data(); *p;) {
+        char* p_next = nullptr;
+        sum_exact += std::strtoull(p, &p_next, 10);
+        p = p_next + 1;
+    }
+    report("std::strtoull", start, text.size());
+    VERIFY(sum == sum_exact);
+}
+
+static void test_105() {
+    const int N = 2000000;
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int64_t> distribution(-1000000000, 1000000000);
+    std::vector<int64_t> values(N);
+    for (int64_t& val : values) { val = distribution(generator); }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    auto report = [](const char* name, std::clock_t start) {
+        std::cout << "---------- " << name << ": " << (std::clock() - start) * 1.e9 / CLOCKS_PER_SEC / N
+                  << " ns per value" << std::endl;
+    };
+    auto start = std::clock();
+    std::vector<std::string> strings(N);
+    for (int n = 0; n < N; ++n) { strings[n] = util::to_string(values[n]); }
+    report("util::to_string", start);
+    std::string column;
+    util::to_strings<int64_t>(values, column);
+    column.clear();
+    start = std::clock();
+    util::to_strings<int64_t>(values, column);
+    report("util::to_strings (reused buffer)", start);
+
+    std::vector<std::string_view> fields(strings.begin(), strings.end());
+    std::vector<int64_t> values1(N), values2(N);
+    start = std::clock();
+    for (int n = 0; n < N; ++n) {
+        bool ok = false;
+        util::string_converter<int64_t>::from_string(fields[n], values1[n], &ok);
+        if (!ok) { values1[n] = 0; }
+    }
+    report("util::from_string", start);
+    start = std::clock();
+    size_t n_errors = util::from_strings<int64_t>(fields, values2);
+    report("util::from_strings", start);
+    VERIFY(n_errors == 0 && values1 == values && values2 == values);
+}
+
+static void test_106() {
+    const int N = 1000000;
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> distribution(-1000., 1000.);
+    std::vector<double> values(N);
+    for (double& val : values) { val = distribution(generator); }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::string out;
+    auto report = [&out](const char* name, std::clock_t start, int64_t new_cnt) {
+        std::cout << "---------- " << name << ": time=" << (std::clock() - start)
+                  << " allocs=" << (new_counter::cnt - new_cnt) << " size=" << out.size() << std::endl;
+    };
+    out.reserve(32 * N);
+    auto new_cnt = new_counter::cnt.load();
+    auto start = std::clock();
+    for (double val : values) { (out += util::to_string(val, util::scvt_fp::kGeneral, 17)) += ' '; }
+    report("out += util::to_string", start, new_cnt);
+    out.clear(), new_cnt = new_counter::cnt.load(), start = std::clock();
+    for (double val : values) { util::append_to(out, val, util::scvt_fp::kGeneral, 17) += ' '; }
+    report("util::append_to", start, new_cnt);
+    out.clear(), new_cnt = new_counter::cnt.load(), start = std::clock();
+    for (int n = 0; n < N; n += 4) {
+        out += util::sformat("%1 %2 %3 %4 ")
+                   .arg(values[n], util::scvt_fp::kGeneral, 17)
+                   .arg(values[n + 1], util::scvt_fp::kGeneral, 17)
+                   .arg(values[n + 2], util::scvt_fp::kGeneral, 17)
+                   .arg(values[n + 3], util::scvt_fp::kGeneral, 17)
+                   .str();
+    }
+    report("util::sformat", start, new_cnt);
+}
+
+static void test_107() {
+    const int N = 1000000;
+    std::vector<std::string_view> levels{"INFO", "WARN", "DEBUG", "ERROR"};
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::string out;
+    size_t total = 0;
+    auto report = [&total](const char* name, std::clock_t start, int64_t new_cnt) {
+        std::cout << "---------- " << name << ": time=" << (std::clock() - start)
+                  << " allocs=" << (new_counter::cnt - new_cnt) << " total=" << total << std::endl;
+    };
+    auto new_cnt = new_counter::cnt.load();
+    auto start = std::clock();
+    for (int n = 0; n < N; ++n) {
+        out = util::sformat("[%1] %2: request %3 done in %4 ms")
+                  .arg(levels[n & 3])
+                  .arg(n, util::sfield(8, '0'))
+                  .arg(static_cast<unsigned>(n) * 2654435761u, util::scvt_base::kBase16)
+                  .arg(0.001 * n, util::scvt_fp::kFixed, 3)
+                  .str();
+        total += out.size();
+    }
+    report("util::sformat", start, new_cnt);
+    total = 0, new_cnt = new_counter::cnt.load(), start = std::clock();
+    const auto& layout = UTIL_SFORMAT_LAYOUT("[%1] %2: request %3 done in %4 ms");
+    for (int n = 0; n < N; ++n) {
+        out.clear();
+        util::sformat_to(out, layout, levels[n & 3], util::sarg(n, util::sfield(8, '0')),
+                         util::sarg(static_cast<unsigned>(n) * 2654435761u, util::scvt_base::kBase16),
+                         util::sarg(0.001 * n, util::scvt_fp::kFixed, 3));
+        total += out.size();
+    }
+    report("util::sformat_to", start, new_cnt);
+}
+
+static void test_108() {
+    const int N = 1000000;
+    std::vector<std::string_view> levels{"INFO", "WARN", "DEBUG", "ERROR"};
+    const auto& layout = UTIL_SFORMAT_LAYOUT("[%1] %2: request %3 done in %4 ms\n");
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    size_t total = 0;  // bytes logged by one run
+    auto log_with = [&levels, &total](const char* name, auto log_line) {
+        auto new_cnt = new_counter::cnt.load();
+        auto start = std::clock();
+        for (int n = 0; n < N; ++n) { log_line(levels[n & 3], n); }
+        const double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        std::cout << "---------- " << name << ": time=" << static_cast<int64_t>(t * CLOCKS_PER_SEC)
+                  << " allocs=" << (new_counter::cnt - new_cnt) << " speed=" << static_cast<int>(total / t / 1000000.)
+                  << " MB/s" << std::endl;
+    };
+
+    std::ofstream ofs(null_device());
+    VERIFY(ofs.is_open());
+    log_with("std::ostream << sformat::str()", [&ofs, &total](std::string_view level, int n) {
+        std::string line = util::sformat("[%1] %2: request %3 done in %4 ms\n")
+                               .arg(level)
+                               .arg(n, util::sfield(8, '0'))
+                               .arg(static_cast<unsigned>(n) * 2654435761u, util::scvt_base::kBase16)
+                               .arg(0.001 * n, util::scvt_fp::kFixed, 3)
+                               .str();
+        ofs << line;
+        total += line.size();
+    });
+    log_with("sformat_to(std::ostream)", [&ofs, &layout](std::string_view level, int n) {
+        util::sformat_to(ofs, layout, level, util::sarg(n, util::sfield(8, '0')),
+                         util::sarg(static_cast<unsigned>(n) * 2654435761u, util::scvt_base::kBase16),
+                         util::sarg(0.001 * n, util::scvt_fp::kFixed, 3));
+    });
+    VERIFY(ofs.good());
+
+    std::FILE* f = std::fopen(null_device(), "w");
+    VERIFY(f);
+    util::fd_sink sink(file_descriptor(f));
+    log_with("sformat_to(util::fd_sink)", [&sink, &layout](std::string_view level, int n) {
+        util::sformat_to(sink, layout, level, util::sarg(n, util::sfield(8, '0')),
+                         util::sarg(static_cast<unsigned>(n) * 2654435761u, util::scvt_base::kBase16),
+                         util::sarg(0.001 * n, util::scvt_fp::kFixed, 3));
+    });
+    VERIFY(sink.flush());
+    std::fclose(f);
+}
+
+static void test_109() {
+    const size_t size = 16 * 1024 * 1024;
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> len_distribution(1, 40);
+    std::uniform_int_distribution<int> ch_distribution('a', 'z');
+    std::string text;
+    text.reserve(size + 64);
+    while (text.size() < size) {
+        for (int n = len_distribution(generator); n > 0; --n) { text += static_cast<char>(ch_distribution(generator)); }
+        text += len_distribution(generator) > 38 ? '\n' : ',';
+    }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    auto run = [sv = std::string_view(text)](const char* name, auto finder) {
+        auto start = std::clock();
+        size_t count = 0;
+        for (int iter = 0; iter < 4; ++iter) {
+            for (auto p = sv.begin();; ++count) {
+                auto sub = finder(p, sv.end());
+                if (sub.first == sv.end()) { break; }
+                p = sub.second;
+            }
+        }
+        const double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        std::cout << "---------- " << name << ": count=" << count
+                  << " speed=" << static_cast<int>(4 * size / t / 1000000.) << " MB/s" << std::endl;
+        return count;
+    };
+
+    VERIFY(run("simple_char_finder(',')", simple_char_finder{','}) == run("util::sfind(',')", util::sfind(',')));
+    VERIFY(run("simple_char_finder('\\n')", simple_char_finder{'\n'}) == run("util::sfind('\\n')", util::sfind('\n')));
+    VERIFY(run("simple_substring_finder(\"ab,\")", simple_substring_finder{"ab,"}) ==
+           run("util::sfind(\"ab,\")", util::sfind(std::string_view("ab,"))));
+    VERIFY(run("simple_substring_finder(\"xyz\")", simple_substring_finder{"xyz"}) ==
+           run("util::sfind(\"xyz\")", util::sfind(std::string_view("xyz"))));
+}
+
+static void test_110() {
+    const int N = 1000000;
+    std::vector<std::string> lines;
+    for (int n = 0; n < 1000; ++n) {
+        lines.emplace_back(util::sformat("2024-01-01,12:00:%1,INFO,request %2,user,GET,/index.html,200,%3,0.5")
+                               .arg(n % 60, util::sfield(2, '0'))
+                               .arg(n)
+                               .arg(1000 + n));
+    }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    auto report = [](const char* name, std::clock_t start, int64_t new_cnt, size_t total) {
+        std::cout << "---------- " << name << ": time=" << (std::clock() - start)
+                  << " allocs=" << (new_counter::cnt - new_cnt) << " total=" << total << std::endl;
+    };
+    size_t total1 = 0, total2 = 0;
+    auto new_cnt = new_counter::cnt.load();
+    auto start = std::clock();
+    for (int n = 0; n < N; ++n) {
+        auto fields = util::split_string(lines[n % lines.size()], util::sfind(','));
+        total1 += fields[2].size() + fields[3].size();
+    }
+    report("util::split_string, fields 2-3", start, new_cnt, total1);
+    new_cnt = new_counter::cnt.load(), start = std::clock();
+    for (int n = 0; n < N; ++n) {
+        auto it = util::lazy_split_string(lines[n % lines.size()], util::sfind(',')).begin();
+        ++it, ++it;
+        total2 += (*it).size();
+        total2 += (*++it).size();
+    }
+    report("util::lazy_split_string, fields 2-3", start, new_cnt, total2);
+    VERIFY(total1 == total2);
+}
+
+static void test_111() {
+    const size_t size = 16 * 1024 * 1024;
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> len_distribution(1, 12);
+    std::uniform_int_distribution<uint32_t> ascii_distribution('a', 'z');
+    std::uniform_int_distribution<uint32_t> cjk_distribution(0x4E00, 0x9FFF);
+    std::string ascii_heavy, cjk_heavy;
+    while (ascii_heavy.size() < size) {  // mostly latin words with rare non-ASCII letters
+        for (int n = len_distribution(generator); n > 0; --n) {
+            util::to_utf8(ascii_distribution(generator), std::back_inserter(ascii_heavy));
+        }
+        if (len_distribution(generator) == 1) { ascii_heavy += "\xC3\xA9"; }
+        ascii_heavy += ' ';
+    }
+    while (cjk_heavy.size() < size) {  // CJK text with ASCII punctuation
+        for (int n = len_distribution(generator); n > 0; --n) {
+            util::to_utf8(cjk_distribution(generator), std::back_inserter(cjk_heavy));
+        }
+        cjk_heavy += ", ";
+    }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::u16string buf16(size + 16, 0);
+    std::string buf8(3 * size + 16, '\0');
+    auto run = [](const char* name, size_t bytes, auto func) {
+        auto start = std::clock();
+        size_t count = 0;
+        for (int iter = 0; iter < 4; ++iter) { count += func(); }
+        const double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        std::cout << "---------- " << name << ": " << std::setprecision(3) << 4 * bytes / t / 1.e9 << " GB/s"
+                  << std::endl;
+        return count;
+    };
+    for (const std::string* text : {&ascii_heavy, &cjk_heavy}) {
+        const std::string_view s(*text);
+        std::cout << (text == &ascii_heavy ? "ASCII-heavy:" : "CJK-heavy:") << std::endl;
+        const size_t count1 = run("code point at a time UTF-8 -> UTF-16", s.size(), [&s, &buf16]() {
+            uint32_t code;
+            char16_t* out = &buf16[0];
+            for (auto p = s.begin(), p1 = p; (p1 = util::from_utf8(p, s.end(), &code)) > p; p = p1) {
+                out += util::to_utf16(code, out);
+            }
+            return static_cast<size_t>(out - &buf16[0]);
+        });
+        const size_t count2 = run("util::utf8_to_utf16", s.size(), [&s, &buf16]() {
+            return util::utf8_to_utf16(s, &buf16[0]).out_count;
+        });
+        VERIFY(count1 == count2);
+        VERIFY(run("util::find_invalid_utf8", s.size(), [&s]() { return util::find_invalid_utf8(s); }) == 4 * s.size());
+        const std::u16string_view s16(buf16.data(), count1 / 4);
+        const size_t count3 = run("code point at a time UTF-16 -> UTF-8", s.size(), [&s16, &buf8]() {
+            uint32_t code;
+            char* out = &buf8[0];
+            for (auto p = s16.begin(), p1 = p; (p1 = util::from_utf16(p, s16.end(), &code)) > p; p = p1) {
+                out += util::to_utf8(code, out);
+            }
+            return static_cast<size_t>(out - &buf8[0]);
+        });
+        const size_t count4 = run("util::utf16_to_utf8", s.size(), [&s16, &buf8]() {
+            return util::utf16_to_utf8(s16, &buf8[0]).out_count;
+        });
+        VERIFY(count3 == count4 && count4 == 4 * s.size());
+    }
+}
+
+static void test_112() {
+    // the former implementation: `std::toupper` for each byte
+    struct toupper_less {
+        using is_transparent = int;
+        bool operator()(std::string_view lhs, std::string_view rhs) const {
+            for (size_t n = 0; n < std::min(lhs.size(), rhs.size()); ++n) {
+                const int ch1 = std::toupper(static_cast<unsigned char>(lhs[n]));
+                const int ch2 = std::toupper(static_cast<unsigned char>(rhs[n]));
+                if (ch1 != ch2) { return ch1 < ch2; }
+            }
+            return lhs.size() < rhs.size();
+        }
+    };
+
+    const int N = 100000;
+    std::default_random_engine generator;
+    std::vector<std::string> keys, queries;
+    for (int n = 0; n < N; ++n) {
+        keys.emplace_back("Configuration.Section_" + std::to_string(n % 100) + ".Parameter_Name_" + std::to_string(n));
+    }
+    for (int n = 0; n < 10 * N; ++n) {
+        std::string query = keys[generator() % N];
+        for (char& ch : query) { ch = (generator() & 1) ? util::impl::to_upper_ascii(ch) : ch; }
+        queries.emplace_back(std::move(query));
+    }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    size_t found = 0;
+    const auto run = [&queries, &found](const char* name, const auto& lookup) {
+        found = 0;
+        const auto start = std::clock();
+        for (const auto& query : queries) { found += lookup(query); }
+        std::cout << "---------- " << name << ": time=" << (std::clock() - start) << " found=" << found << std::endl;
+    };
+
+    util::map<std::string, int, toupper_less> toupper_map;
+    util::map<std::string, int, util::less_nocase<>> nocase_map;
+    util::map<std::string, int> folded_map;
+    for (int n = 0; n < N; ++n) {
+        toupper_map.emplace(keys[n], n), nocase_map.emplace(keys[n], n), folded_map.emplace(util::to_upper(keys[n]), n);
+    }
+    run("std::toupper comparison", [&toupper_map](const std::string& q) { return toupper_map.count(q); });
+    run("util::less_nocase", [&nocase_map](const std::string& q) { return nocase_map.count(q); });
+    VERIFY(found == queries.size());
+    std::string folded;
+    run("keys folded with util::to_upper", [&folded_map, &folded](const std::string& q) {
+        folded.clear();
+        return folded_map.count(util::to_upper(q, folded));
+    });
+    VERIFY(found == queries.size());
+}
+
+static void test_113() {
+    const size_t size = 64 * 1024 * 1024;
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> len_distribution(1, 80);
+    std::string payload;
+    while (payload.size() < size) {  // config-like lines with rare characters to escape
+        payload.append(len_distribution(generator), 'a' + static_cast<char>(payload.size() % 26));
+        payload += len_distribution(generator) < 8 ? "=\"quoted\";\n" : " = value;\n";
+    }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    const auto run = [&payload](const char* name, const auto& func) {
+        const auto start = std::clock();
+        size_t count = 0;
+        for (int iter = 0; iter < 4; ++iter) { count += func(); }
+        const double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        std::cout << "---------- " << name << ": " << std::setprecision(3) << 4 * payload.size() / t / 1.e9 << " GB/s"
+                  << std::endl;
+        return count;
+    };
+
+    const std::string_view symb = "\\\n\";", code = "\\n\";";
+    const util::escape_table table(symb, code);
+    const std::string encoded = table.encode(payload);
+    const size_t count1 = run("util::encode_escapes", [&]() {
+        return util::encode_escapes(payload, symb, code).size();
+    });
+    const size_t count2 = run("util::escape_table::encode", [&]() { return table.encode(payload).size(); });
+    std::string buf;
+    const size_t count6 = run("util::escape_table::encode to reused buffer", [&]() {
+        buf.resize(table.encoded_size(payload));
+        return static_cast<size_t>(table.encode(payload, &buf[0]) - buf.data());
+    });
+    VERIFY(count1 == count2 && count2 == count6 && count6 == 4 * encoded.size() && buf == encoded);
+    const size_t count3 = run("util::decode_escapes", [&]() {
+        return util::decode_escapes(encoded, symb, code).size();
+    });
+    const size_t count4 = run("util::escape_table::decode", [&]() { return table.decode(encoded).size(); });
+    const size_t count5 = run("util::escape_table::decode_in_place", [&]() {
+        buf = encoded;
+        table.decode_in_place(buf);
+        return buf.size();
+    });
+    VERIFY(count3 == count4 && count4 == count5 && count5 == 4 * payload.size() && buf == payload);
+}
+
+static void test_114() {
+    const size_t size = 4 * 1024 * 1024;
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> len_distribution(1, 12);
+    std::string text;
+    while (text.size() < size) {  // lines of comma-separated fields
+        for (int n = len_distribution(generator); n > 0; --n) {
+            text.append(len_distribution(generator), 'a' + static_cast<char>(text.size() % 26));
+            text += n % 3 ? ", " : " ,\t";
+        }
+        text += "last\n";
+    }
+    std::vector<std::string_view> lines;
+    for (auto line : util::split_string(text, util::sfind('\n'))) { lines.push_back(line); }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    const auto run = [](const char* name, const auto& func) {
+        const auto start = std::clock();
+        const size_t count = func();
+        std::cout << "---------- " << name << ": time=" << (std::clock() - start) << " count=" << count << std::endl;
+        return count;
+    };
+
+    const char* re = "\\s*,\\s*";
+    const std::regex std_sep(re);
+    const util::pattern sep(re);
+    const auto split = [&lines](const auto& finder) {
+        size_t count = 0;
+        for (auto line : lines) { count += util::split_string(line, finder).size(); }
+        return count;
+    };
+    const auto last_field = [&lines](const auto& finder) {
+        size_t count = 0;
+        for (auto line : lines) { count += util::string_section(line, finder, 0).size(); }
+        return count;
+    };
+    const size_t count1 = run("split with std::regex", [&]() { return split(util::sfind(std_sep)); });
+    const size_t count2 = run("split with util::pattern", [&]() { return split(util::sfind(sep)); });
+    VERIFY(count1 == count2);
+    const size_t count3 = run("last field with std::regex", [&]() { return last_field(util::rsfind(std_sep)); });
+    const size_t count4 = run("last field with util::pattern", [&]() { return last_field(util::rsfind(sep)); });
+    VERIFY(count3 == count4);
+
+    // exponential backtracking of `std::regex`
+    const util::pattern pat("(a|aa)*c");
+    const std::regex std_pat("(a|aa)*c");
+    std::pair<const char*, const char*> m;
+    for (size_t len : {16, 20, 24}) {
+        const std::string s(len, 'a');
+        std::cout << "---------- length " << len << ":" << std::endl;
+        run("std::regex", [&]() { return static_cast<size_t>(std::regex_search(s, std_pat)); });
+        run("util::pattern", [&]() { return static_cast<size_t>(pat.search(s.data(), s.data() + s.size(), m)); });
+    }
+    const std::string s(size, 'a');
+    run("util::pattern, 4M characters", [&]() {
+        return static_cast<size_t>(pat.search(s.data(), s.data() + s.size(), m));
+    });
+}
+
 // --------------------------------------------
 
 std::pair<std::pair<size_t, void (*)()>*, size_t> get_string_tests() {
     static std::pair<size_t, void (*)()> _tests[] = {
         {0, test_0}, {1, test_1}, {2, test_2}, {3, test_3},   {4, test_4},   {5, test_5},   {6, test_6},
         {7, test_7}, {8, test_8}, {9, test_9}, {10, test_10}, {11, test_11}, {12, test_12}, {12, test_13},
+        {14, test_14}, {15, test_15}, {16, test_16},   {17, test_17},   {18, test_18},   {19, test_19},
+        {20, test_20}, {21, test_21}, {22, test_22}, {23, test_23}, {24, test_24}, {25, test_25},
+        {26, test_26}, {27, test_27}, {28, test_28}, {29, test_29}, {30, test_30}, {31, test_31}, {100, test_100},
+        {101, test_101}, {102, test_102}, {103, test_103}, {104, test_104}, {105, test_105}, {106, test_106},
+        {107, test_107}, {108, test_108}, {109, test_109}, {110, test_110}, {111, test_111}, {112, test_112},
+        {113, test_113}, {114, test_114},
     };
 
     return std::make_pair(_tests, sizeof(_tests) / sizeof(_tests[0]));
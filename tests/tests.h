@@ -1,11 +1,17 @@
 #include "core/pool_allocator.h"
 
+#include <atomic>
+#include <cstdio>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
 
+#if defined(_WIN32)
+#    include <io.h>
+#endif  // _WIN32
+
 #define USE_UTIL
 #define USE_STD
 
@@ -79,6 +85,21 @@ struct T {
     }
 };
 
+// Null output device name and descriptor of a C stream for the platform
+#if defined(_WIN32)
+inline const char* null_device() { return "NUL"; }
+inline int file_descriptor(std::FILE* f) { return _fileno(f); }
+#else   // _WIN32
+inline const char* null_device() { return "/dev/null"; }
+inline int file_descriptor(std::FILE* f) { return fileno(f); }
+#endif  // _WIN32
+
+// Global `operator new` call counter: replacement operators are defined in main.cpp
+struct new_counter {
+    static std::atomic<std::int64_t> cnt;
+    static std::atomic<std::int64_t> fail_at;  // `operator new` throws when `cnt` reaches this value
+};
+
 template<typename Ty>
 class unfriendly_pool_allocator : public util::pool_allocator<Ty> {
  private:
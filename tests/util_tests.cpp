@@ -1,4 +1,5 @@
 #include "core/set.h"
+#include "core/string_pool.h"
 #include "core/util_algorithm.h"
 #include "core/util_span.h"
 
@@ -9,6 +10,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 // --------------------------------------------
@@ -261,12 +263,57 @@ static void test_9() {
     // util::span<int> s10(s6);
 }
 
+static void test_10() {  // arena
+    util::arena a(256);
+    auto* p1 = a.allocate<std::uint64_t>(4);
+    VERIFY(reinterpret_cast<uintptr_t>(p1) % alignof(std::uint64_t) == 0);
+    auto* p2 = static_cast<char*>(a.allocate(3, 1));
+    auto* p3 = a.allocate<std::uint32_t>(1);
+    VERIFY(reinterpret_cast<uintptr_t>(p3) % alignof(std::uint32_t) == 0 && p2 + 3 <= reinterpret_cast<char*>(p3));
+    VERIFY(a.allocated_size() == 256);
+    auto* big = static_cast<char*>(a.allocate(1000, 16));  // dedicated block
+    VERIFY(reinterpret_cast<uintptr_t>(big) % 16 == 0);
+    auto* p4 = static_cast<char*>(a.allocate(1, 1));
+    VERIFY(p4 >= p2 + 3 && p4 < p2 + 256);  // current block is still used
+    for (int i = 0; i < 100; ++i) { a.allocate(16, 8); }
+    auto s = a.copy_string("hello");
+    VERIFY(s == "hello" && s.data()[s.size()] == '\0');
+    a.clear();
+    VERIFY(a.allocated_size() == 256);
+    util::arena a2(std::move(a));
+    VERIFY(a.allocated_size() == 0 && a2.allocated_size() == 256);
+    a2.release();
+    VERIFY(a2.allocated_size() == 0);
+}
+
+static void test_11() {  // string pool
+    util::string_pool pool(64);
+    std::string s1 = "hello", s2 = "hello";
+    auto h1 = pool.intern(s1), h2 = pool.intern(s2);
+    VERIFY(h1.data() == h2.data() && h1.data() != s1.data() && h1 == h2 && pool.size() == 1);
+    VERIFY(pool.find("hello").data() == h1.data() && !pool.find("world").data() && !pool.contains("world"));
+    std::vector<util::hashed_string_view> views;
+    for (int i = 0; i < 1000; ++i) { views.push_back(pool.intern("name" + std::to_string(i))); }
+    for (int i = 0; i < 1000; ++i) {
+        auto view = pool.intern("name" + std::to_string(i));
+        VERIFY(view.data() == views[i].data() && view.view() == "name" + std::to_string(i));
+    }
+    VERIFY(pool.size() == 1001 && pool.intern("").data() != nullptr && pool.size() == 1002);
+
+    util::concurrent_string_pool cpool;
+    auto c1 = cpool.intern("abc");
+    VERIFY(cpool.intern(std::string("abc")).data() == c1.data() && cpool.find("abc").data() == c1.data());
+    VERIFY(!cpool.find("abcd").data() && cpool.size() == 1);
+    cpool.clear();
+    VERIFY(cpool.size() == 0);
+}
+
 // --------------------------------------------
 
 std::pair<std::pair<size_t, void (*)()>*, size_t> get_util_tests() {
     static std::pair<size_t, void (*)()> _tests[] = {
         {0, test_0}, {1, test_1}, {2, test_2}, {3, test_3}, {4, test_4},
-        {5, test_5}, {6, test_6}, {7, test_7}, {8, test_8}, {9, test_9},
+        {5, test_5}, {6, test_6}, {7, test_7}, {8, test_8}, {9, test_9}, {10, test_10}, {11, test_11},
     };
 
     return std::make_pair(_tests, sizeof(_tests) / sizeof(_tests[0]));
@@ -0,0 +1,988 @@
+#include "core/xml_document.h"
+#include "core/xml_parallel_parser.h"
+#include "core/xml_parser.h"
+#include "core/xml_writer.h"
+
+#include "tests.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#ifdef _DEBUG  // _DEBUG
+static const int N = 2000;
+#else   // _DEBUG
+static const int N = 200000;
+#endif  // _DEBUG
+
+static std::string_view attribute(const util::xml_parser& parser, std::string_view name) {
+    auto it = parser.attributes().find(name);
+    return it != parser.attributes().end() ? std::string_view(it->second) : std::string_view();
+}
+
+struct xml_token_t {
+    util::xml_parser_token type;
+    std::string value;  // name or text
+    unsigned line;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    friend bool operator==(const xml_token_t& lhs, const xml_token_t& rhs) {
+        return lhs.type == rhs.type && lhs.value == rhs.value && lhs.line == rhs.line &&
+               lhs.attributes == rhs.attributes;
+    }
+};
+
+static xml_token_t get_token(const util::xml_parser& parser, util::xml_parser_token tt) {
+    const std::string_view value = tt == util::xml_parser_token::kPlainText ? parser.text() :
+                                                                              std::string_view(parser.name());
+    xml_token_t tok{tt, std::string(value), parser.token_line(), {}};
+    if (tt == util::xml_parser_token::kSection || tt == util::xml_parser_token::kDeclaration) {
+        for (const auto& attr : parser.attributes()) { tok.attributes.emplace_back(attr.first, attr.second); }
+        std::sort(tok.attributes.begin(), tok.attributes.end());
+    }
+    return tok;
+}
+
+// --------------------------------------------
+
+static void test_0() {  // tokens
+    std::istringstream ss(
+        "<?xml version=\"1.0\"?>\n"
+        "<!DOCTYPE root>\n"
+        "<root a=\"1\" b=\"two &amp; three\">\n"
+        "  <!-- comment -->\n"
+        "  <item id=\"x\"/>text &lt;&gt;\n"
+        "</root>\n");
+    util::xml_parser parser(ss);
+
+    VERIFY(parser.next_token() == util::xml_parser_token::kDeclaration && parser.name() == "xml");
+    VERIFY(attribute(parser, "version") == "1.0");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText && parser.text() == "\n");
+    VERIFY(parser.next_token() == util::xml_parser_token::kDoctype && parser.name() == "root");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText);
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && parser.name() == "root");
+    VERIFY(parser.token_line() == 3 && parser.attributes().size() == 2);
+    VERIFY(attribute(parser, "a") == "1" && attribute(parser, "b") == "two & three");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText && parser.text() == "\n  ");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText && parser.text() == "\n  ");  // after comment
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && parser.name() == "item");
+    VERIFY(attribute(parser, "id") == "x" && parser.token_line() == 5);
+    VERIFY(parser.next_token() == util::xml_parser_token::kEndOfSection && parser.name() == "item");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText && parser.text() == "text <>\n");
+    VERIFY(parser.next_token() == util::xml_parser_token::kEndOfSection && parser.name() == "root");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText);
+    VERIFY(parser.next_token() == util::xml_parser_token::kEof);
+}
+
+static void test_1() {  // shared name pool
+    util::string_pool names;
+    std::istringstream ss1("<node name=\"a\"/>"), ss2("<node name=\"b\"></node>");
+    util::xml_parser parser1(ss1, &names), parser2(ss2, &names);
+
+    VERIFY(parser1.next_token() == util::xml_parser_token::kSection);
+    VERIFY(parser2.next_token() == util::xml_parser_token::kSection);
+    VERIFY(parser1.name().data() == parser2.name().data());
+    VERIFY(parser1.attributes().begin()->first.data() == parser2.attributes().begin()->first.data());
+    VERIFY(parser1.next_token() == util::xml_parser_token::kEndOfSection);
+    VERIFY(parser2.next_token() == util::xml_parser_token::kEndOfSection);
+    VERIFY(parser1.name().data() == parser2.name().data() && names.size() == 2);
+}
+
+static void test_2() {  // parsing buffer in place
+    const std::string_view doc(
+        "<root a=\"plain\" b=\"&#x41;&#65;\">\n"
+        "  text\n"
+        "  <item/>&#x41;&#65;&lt;\n"
+        "</root>");
+    util::xml_parser parser(doc);
+    const auto is_inside = [&doc](std::string_view s) {
+        return s.data() >= doc.data() && s.data() < doc.data() + doc.size();
+    };
+
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && parser.name() == "root");
+    VERIFY(attribute(parser, "a") == "plain" && is_inside(attribute(parser, "a")));
+    VERIFY(attribute(parser, "b") == "AA" && !is_inside(attribute(parser, "b")));
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText && parser.text() == "\n  text\n  ");
+    VERIFY(is_inside(parser.text()));
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && parser.name() == "item");
+    VERIFY(parser.next_token() == util::xml_parser_token::kEndOfSection && parser.name() == "item");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText && parser.text() == "AA<\n");
+    VERIFY(parser.next_token() == util::xml_parser_token::kEndOfSection && parser.name() == "root");
+    VERIFY(parser.next_token() == util::xml_parser_token::kEof && parser.token_line() == 4);
+
+    for (std::string_view bad : {"&#x;", "&#xG1;", "&#12a;", "&#x123456789;", "&#1", "&foo;"}) {
+        util::xml_parser bad_parser(bad);
+        VERIFY(bad_parser.next_token() == util::xml_parser_token::kParsingError);
+    }
+
+    // memory-mapped file
+    const char* path = "xml_parser_test.xml";
+    std::ofstream(path, std::ios::binary).write(doc.data(), doc.size());
+    {
+        util::mapped_file file(path);
+        VERIFY(file.is_open() && file.view() == doc);
+        util::mapped_file moved(std::move(file));
+        VERIFY(!file.is_open() && moved.view() == doc);
+        util::xml_parser mapped_parser(moved.view());
+        VERIFY(mapped_parser.next_token() == util::xml_parser_token::kSection && mapped_parser.name() == "root");
+        VERIFY(attribute(mapped_parser, "b") == "AA");
+    }
+    std::ofstream(path, std::ios::binary | std::ios::trunc);
+    {
+        util::mapped_file file(path);
+        VERIFY(file.is_open() && file.size() == 0);
+        util::xml_parser empty_parser(file.view());
+        VERIFY(empty_parser.next_token() == util::xml_parser_token::kEof);
+    }
+    std::remove(path);
+    VERIFY(!util::mapped_file(path).is_open());
+}
+
+static void test_3() {  // random documents: block boundaries, line numbers and character references
+    std::default_random_engine generator;
+    const std::string_view text_chars = "abcxyz \t\n\n;\"'=/#-";
+    const std::string_view value_chars = "abcxyz \t<>'=/#-";
+    const std::pair<std::string_view, std::string_view> refs[] = {
+        {"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&#x41;", "A"}, {"&#10;", "\n"},
+    };
+
+    for (int iter = 0; iter < 500; ++iter) {
+        std::string doc, text;
+        std::vector<xml_token_t> expected;
+        std::vector<std::string> open_tags;
+        unsigned line = 1, last_token_line = 1;
+
+        const auto random_string = [&](std::string_view chars, size_t max_len, std::string& decoded) {
+            const size_t len = std::uniform_int_distribution<size_t>{0, max_len}(generator);
+            for (size_t n = 0; n < len; ++n) {
+                if (std::uniform_int_distribution<int>{0, 15}(generator) == 0) {
+                    const auto& ref = refs[std::uniform_int_distribution<size_t>{0, 5}(generator)];
+                    doc += ref.first, decoded += ref.second;
+                    continue;
+                }
+                const char ch = chars[std::uniform_int_distribution<size_t>{0, chars.size() - 1}(generator)];
+                doc += ch, decoded += ch;
+                if (ch == '\n') { ++line; }
+            }
+        };
+
+        const auto flush_text = [&]() {
+            if (text.empty()) { return; }
+            expected.push_back({util::xml_parser_token::kPlainText, text, last_token_line, {}});
+            text.clear(), last_token_line = line;
+        };
+
+        const auto add_tag = [&](bool empty) {
+            flush_text();
+            xml_token_t tag{util::xml_parser_token::kSection, "t" + std::to_string(open_tags.size()), last_token_line,
+                            {}};
+            doc += '<' + tag.value;
+            const int attr_count = std::uniform_int_distribution<int>{0, 3}(generator);
+            for (int n = 0; n < attr_count; ++n) {
+                if (std::uniform_int_distribution<int>{0, 3}(generator) == 0) {
+                    doc += '\n', ++line;
+                }
+                std::string value;
+                doc += " a" + std::to_string(n) + "=\"";
+                random_string(value_chars, 80, value);
+                doc += '\"';
+                tag.attributes.emplace_back("a" + std::to_string(n), value);
+            }
+            doc += empty ? "/>" : ">";
+            last_token_line = line;
+            expected.push_back(tag);
+            if (empty) {
+                expected.push_back({util::xml_parser_token::kEndOfSection, tag.value, line, {}});
+            } else {
+                open_tags.push_back(tag.value);
+            }
+        };
+
+        const auto close_tag = [&]() {
+            flush_text();
+            doc += "</" + open_tags.back() + '>';
+            expected.push_back({util::xml_parser_token::kEndOfSection, open_tags.back(), last_token_line, {}});
+            open_tags.pop_back();
+            last_token_line = line;
+        };
+
+        add_tag(false);
+        for (int n = 0; n < 40; ++n) {
+            switch (std::uniform_int_distribution<int>{0, 5}(generator)) {
+                case 0: {
+                    if (open_tags.size() < 4) { add_tag(false); }
+                } break;
+                case 1: add_tag(true); break;
+                case 2: {
+                    if (open_tags.size() > 1) { close_tag(); }
+                } break;
+                case 3: {  // comment splits text tokens
+                    flush_text();
+                    std::string comment;
+                    doc += "<!--";
+                    random_string("abc <>&\n", 100, comment);
+                    doc += "-->";
+                } break;
+                default: random_string(text_chars, 150, text); break;
+            }
+        }
+        while (!open_tags.empty()) { close_tag(); }
+
+        util::xml_parser parser(doc);
+        for (const auto& tok : expected) {
+            VERIFY(parser.next_token() == tok.type && parser.token_line() == tok.line);
+            if (tok.type == util::xml_parser_token::kPlainText) {
+                VERIFY(parser.text() == tok.value);
+                continue;
+            }
+            VERIFY(parser.name() == tok.value);
+            if (tok.type == util::xml_parser_token::kEndOfSection) { continue; }
+            VERIFY(parser.attributes().size() == tok.attributes.size());
+            for (const auto& attr : tok.attributes) { VERIFY(attribute(parser, attr.first) == attr.second); }
+        }
+        VERIFY(parser.next_token() == util::xml_parser_token::kEof);
+    }
+}
+
+static void test_4() {  // push mode
+    const std::string_view doc(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<!DOCTYPE root>\n"
+        "<root a=\"1\" b=\"two &amp; three\">\n"
+        "  <!-- comment\n with < and > -->\n"
+        "  <item id=\"x\"\n        name=\"&#x41;&#66;\"/>text &lt;&gt; &#x1F600;\n"
+        "  <long>Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut "
+        "labore et dolore magna aliqua</long>\n"
+        "</root>\n");
+
+    std::vector<xml_token_t> expected;
+    util::xml_parser parser(doc);
+    for (auto tt = parser.next_token(); tt != util::xml_parser_token::kEof; tt = parser.next_token()) {
+        VERIFY(tt != util::xml_parser_token::kParsingError);
+        expected.emplace_back(get_token(parser, tt));
+    }
+
+    const auto parse_chunks = [](const std::vector<std::string_view>& chunks) {
+        std::vector<xml_token_t> tokens;
+        util::xml_parser push_parser;
+        auto drain = [&push_parser, &tokens]() {
+            for (auto tt = push_parser.next_token();; tt = push_parser.next_token()) {
+                if (tt == util::xml_parser_token::kEof || tt == util::xml_parser_token::kNeedMoreData) { return tt; }
+                VERIFY(tt != util::xml_parser_token::kParsingError);
+                tokens.emplace_back(get_token(push_parser, tt));
+            }
+        };
+        for (std::string_view chunk : chunks) {
+            push_parser.feed(chunk);
+            VERIFY(drain() == util::xml_parser_token::kNeedMoreData);
+        }
+        push_parser.finish();
+        VERIFY(drain() == util::xml_parser_token::kEof);
+        return tokens;
+    };
+
+    for (size_t pos = 0; pos <= doc.size(); ++pos) {  // every split point
+        VERIFY(parse_chunks({doc.substr(0, pos), doc.substr(pos)}) == expected);
+    }
+
+    for (size_t chunk_size : {1, 2, 3, 7, 64}) {
+        std::vector<std::string_view> chunks;
+        for (size_t pos = 0; pos < doc.size(); pos += chunk_size) { chunks.push_back(doc.substr(pos, chunk_size)); }
+        VERIFY(parse_chunks(chunks) == expected);
+    }
+
+    {  // stream is read in chunks too
+        std::istringstream ss{std::string(doc)};
+        util::xml_parser stream_parser(ss);
+        for (const auto& tok : expected) { VERIFY(get_token(stream_parser, stream_parser.next_token()) == tok); }
+        VERIFY(stream_parser.next_token() == util::xml_parser_token::kEof);
+    }
+
+    {  // long text spanning many reads is resumed where its scanning stopped
+        std::string text, decoded;
+        for (int i = 0; i < 30000; ++i) {
+            text += "line &amp; " + std::to_string(i) + "\n";
+            decoded += "line & " + std::to_string(i) + "\n";
+        }
+        std::istringstream ss("<a>" + text + "</a>");
+        util::xml_parser stream_parser(ss);
+        VERIFY(stream_parser.next_token() == util::xml_parser_token::kSection);
+        VERIFY(stream_parser.next_token() == util::xml_parser_token::kPlainText && stream_parser.text() == decoded);
+        VERIFY(stream_parser.next_token() == util::xml_parser_token::kEndOfSection);
+        VERIFY(stream_parser.token_line() == 30001);
+    }
+
+    {  // long markup fed in small chunks is parsed once its end is received
+        std::string comment, value, decoded_value;
+        for (int i = 0; i < 20000; ++i) {
+            comment += "comment - " + std::to_string(i) + " > \n";
+            value += "value &lt; " + std::to_string(i) + " >";
+            decoded_value += "value < " + std::to_string(i) + " >";
+        }
+        const std::string long_doc = "<a>\n<!--" + comment + "-->\n<b v=\"" + value + "\" w=\"1\"/></a>";
+        util::xml_parser push_parser;
+        std::vector<util::xml_parser_token> tokens;
+        std::string v;
+        for (size_t pos = 0; pos < long_doc.size(); pos += 64) {
+            push_parser.feed(std::string_view(long_doc).substr(pos, 64));
+            for (auto tt = push_parser.next_token(); tt != util::xml_parser_token::kNeedMoreData;
+                 tt = push_parser.next_token()) {
+                VERIFY(tt != util::xml_parser_token::kParsingError);
+                tokens.push_back(tt);
+                if (tt == util::xml_parser_token::kSection && push_parser.name() == "b") {
+                    VERIFY(push_parser.token_line() == 20003 && attribute(push_parser, "w") == "1");
+                    v = attribute(push_parser, "v");
+                }
+            }
+        }
+        push_parser.finish();
+        VERIFY(push_parser.next_token() == util::xml_parser_token::kEof);
+        VERIFY(tokens.size() == 6 && v == decoded_value);
+    }
+
+    {  // errors
+        util::xml_parser push_parser;
+        push_parser.feed("<a>");
+        VERIFY(push_parser.next_token() == util::xml_parser_token::kSection);
+        push_parser.feed("text>");
+        VERIFY(push_parser.next_token() == util::xml_parser_token::kParsingError);
+    }
+
+    {
+        util::xml_parser push_parser;
+        push_parser.feed("<a b=\"1");
+        VERIFY(push_parser.next_token() == util::xml_parser_token::kNeedMoreData);
+        push_parser.finish();
+        VERIFY(push_parser.next_token() == util::xml_parser_token::kParsingError);
+    }
+
+    {  // names of incomplete tags are not interned
+        util::xml_parser push_parser;
+        push_parser.feed("<na");
+        VERIFY(push_parser.next_token() == util::xml_parser_token::kNeedMoreData);
+        push_parser.feed("me a");
+        VERIFY(push_parser.next_token() == util::xml_parser_token::kNeedMoreData);
+        push_parser.feed("ttr=\"1\">");
+        VERIFY(push_parser.next_token() == util::xml_parser_token::kSection && push_parser.name() == "name");
+        VERIFY(attribute(push_parser, "attr") == "1" && push_parser.names().size() == 2);
+    }
+}
+
+static void test_5() {  // parallel parsing
+    std::string doc = "<?xml version=\"1.0\"?>\n<root>\n";
+    for (int i = 0; i < 20000; ++i) {
+        doc += "  <item id=\"" + std::to_string(i) + "\">text &amp; more</item>\n";
+        // split point candidates inside of markup
+        if (i % 97 == 0) { doc += "  <!--\n  <item id=\"commented\">\n  -->\n"; }
+        if (i % 89 == 0) { doc += "  <item note=\"<item> &lt;\" flag=\"\"/>\n"; }
+    }
+    doc += "</root>\n";
+
+    const auto parse_serial = [](std::string_view doc) {
+        std::vector<xml_token_t> tokens;
+        util::xml_parser parser(doc);
+        for (auto tt = parser.next_token(); tt != util::xml_parser_token::kEof; tt = parser.next_token()) {
+            tokens.emplace_back(get_token(parser, tt));
+            if (tt == util::xml_parser_token::kParsingError) { break; }
+        }
+        return tokens;
+    };
+
+    const auto to_token_list = [](const util::xml_parallel_parser& parser) {
+        std::vector<xml_token_t> tokens;
+        for (const auto& tok : parser.tokens()) {
+            xml_token_t t{tok.type, std::string(tok.value), tok.line, {}};
+            for (const auto& attr : parser.attributes(tok)) { t.attributes.emplace_back(attr.first, attr.second); }
+            std::sort(t.attributes.begin(), t.attributes.end());
+            tokens.emplace_back(std::move(t));
+        }
+        return tokens;
+    };
+
+    const auto expected = parse_serial(doc);
+    for (unsigned thread_count : {1, 2, 3, 4, 8}) {
+        util::xml_parallel_parser parser(thread_count);
+        VERIFY(parser.parse(doc) && to_token_list(parser) == expected);
+        VERIFY(parser.chunk_count() >= 1 && parser.chunk_count() <= thread_count);
+
+        // names are interned into one pool
+        const char* item_name = nullptr;
+        for (const auto& tok : parser.tokens()) {
+            if (tok.type != util::xml_parser_token::kSection || tok.value != "item") { continue; }
+            if (!item_name) { item_name = tok.value.data(); }
+            VERIFY(tok.value.data() == item_name);
+        }
+        VERIFY(parser.names().size() == 7);
+    }
+
+    // malformed document: error is reported with its actual line
+    std::string bad_doc = doc;
+    bad_doc.insert(bad_doc.find('\n', bad_doc.size() * 3 / 4) + 1, "<item a=1>");
+    const auto expected_bad = parse_serial(bad_doc);
+    VERIFY(expected_bad.back().type == util::xml_parser_token::kParsingError);
+    for (unsigned thread_count : {1, 4}) {
+        util::xml_parallel_parser parser(thread_count);
+        VERIFY(!parser.parse(bad_doc));
+        auto tokens = to_token_list(parser);
+        VERIFY(tokens.size() == expected_bad.size() && tokens.back().line == expected_bad.back().line);
+    }
+}
+
+static void test_6() {  // attribute storage
+    std::string many = "<tag";
+    for (int n = 0; n < 20; ++n) { many += " a" + std::to_string(n) + "=\"" + std::to_string(n) + "\""; }
+    many += " a3=\"duplicate\"/><small b=\"1\" a=\"2\" b=\"3\"/>";
+
+    util::xml_parser parser(many);
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && parser.attributes().size() == 20);
+    int n = 0;
+    for (const auto& attr : parser.attributes()) {  // in order of appearance
+        VERIFY(attr.first == "a" + std::to_string(n) && attr.second == std::to_string(n));
+        ++n;
+    }
+    for (n = 0; n < 20; ++n) { VERIFY(attribute(parser, "a" + std::to_string(n)) == std::to_string(n)); }
+    VERIFY(!parser.attributes().contains("a20") && !parser.attributes().contains("b"));
+    VERIFY(parser.next_token() == util::xml_parser_token::kEndOfSection);
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && parser.attributes().size() == 2);
+    VERIFY(attribute(parser, "b") == "1" && attribute(parser, "a") == "2" && !parser.attributes().contains("a3"));
+    VERIFY(parser.attributes().begin()->first == "b");
+
+    // the index built on a duplicate 9th attribute is not reused by the next tag
+    std::string dup = "<r";
+    for (n = 1; n <= 8; ++n) { dup += " a" + std::to_string(n) + "=\"" + std::to_string(n) + "\""; }
+    dup += " a1=\"dup\"/><s";
+    for (n = 1; n <= 8; ++n) { dup += " b" + std::to_string(n) + "=\"" + std::to_string(n) + "\""; }
+    dup += " a3=\"x\" a9=\"9\"/>";
+    util::xml_parser dup_parser(dup);
+    VERIFY(dup_parser.next_token() == util::xml_parser_token::kSection && dup_parser.attributes().size() == 8);
+    VERIFY(attribute(dup_parser, "a1") == "1");
+    VERIFY(dup_parser.next_token() == util::xml_parser_token::kEndOfSection);
+    VERIFY(dup_parser.next_token() == util::xml_parser_token::kSection && dup_parser.attributes().size() == 10);
+    VERIFY(!dup_parser.attributes().contains("a1") && attribute(dup_parser, "a3") == "x");
+    VERIFY(attribute(dup_parser, "b3") == "3" && attribute(dup_parser, "a9") == "9");
+
+    // no allocations per element once the storage is warmed up
+    std::string doc = "<root>\n";
+    for (int i = 0; i < 1000; ++i) {
+        doc += "  <item id=\"" + std::to_string(i) + "\" kind=\"a &amp; b\" x=\"1\"/>\n";
+        if (i % 10 == 0) { doc += "  <wide " + many.substr(5, many.find("/>") - 5) + ">&lt;text&gt;</wide>\n"; }
+    }
+    doc += "</root>\n";
+    util::xml_parser doc_parser(doc);
+    for (int i = 0; i < 50; ++i) { VERIFY(doc_parser.next_token() != util::xml_parser_token::kParsingError); }
+    const auto new_cnt = new_counter::cnt.load();
+    size_t count = 0;
+    for (auto tt = doc_parser.next_token(); tt != util::xml_parser_token::kEof; tt = doc_parser.next_token()) {
+        VERIFY(tt != util::xml_parser_token::kParsingError);
+        if (tt == util::xml_parser_token::kSection) { ++count; }
+    }
+    VERIFY(count > 1000 && new_counter::cnt == new_cnt);
+}
+
+static void test_7() {  // writer
+    std::string out;
+    util::xml_writer<std::string> writer(out);
+    writer.declaration().begin_section("root").attribute("a", "x & \"y\" <'z'>\nw").attribute("n", 42);
+    writer.begin_section("empty").end_section();
+    writer.text("a < b && c > d; 'quoted' \"text\"\n");
+    writer.comment(" comment ").begin_section("value").attribute("f", 1.5).text(-7).end_section();
+    writer.finish();
+    VERIFY(writer.depth() == 0);
+    VERIFY(out ==
+           "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+           "<root a=\"x &amp; &quot;y&quot; &lt;&apos;z&apos;&gt;&#10;w\" n=\"42\"><empty/>"
+           "a &lt; b &amp;&amp; c &gt; d; 'quoted' \"text\"\n"
+           "<!-- comment --><value f=\"1.5\">-7</value></root>");
+
+    util::xml_parser parser(out);
+    VERIFY(parser.next_token() == util::xml_parser_token::kDeclaration && attribute(parser, "encoding") == "UTF-8");
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && parser.name() == "root");
+    VERIFY(attribute(parser, "a") == "x & \"y\" <'z'>\nw" && attribute(parser, "n") == "42");
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && parser.name() == "empty");
+    VERIFY(parser.next_token() == util::xml_parser_token::kEndOfSection && parser.name() == "empty");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText);
+    VERIFY(parser.text() == "a < b && c > d; 'quoted' \"text\"\n");
+    VERIFY(parser.next_token() == util::xml_parser_token::kSection && attribute(parser, "f") == "1.5");
+    VERIFY(parser.next_token() == util::xml_parser_token::kPlainText && parser.text() == "-7");
+    VERIFY(parser.next_token() == util::xml_parser_token::kEndOfSection && parser.name() == "value");
+    VERIFY(parser.next_token() == util::xml_parser_token::kEndOfSection && parser.name() == "root");
+    VERIFY(parser.next_token() == util::xml_parser_token::kEof);
+
+    // long strings are escaped blockwise
+    std::string long_text;
+    for (int n = 0; n < 300; ++n) { long_text += static_cast<char>(n % 2 ? ' ' + n % 95 : 'a' + n % 26); }
+    out.clear();
+    util::xml_writer<std::string>(out).begin_section("t").attribute("v", long_text).text(long_text).finish();
+    util::xml_parser long_parser(out);
+    VERIFY(long_parser.next_token() == util::xml_parser_token::kSection && attribute(long_parser, "v") == long_text);
+    VERIFY(long_parser.next_token() == util::xml_parser_token::kPlainText && long_parser.text() == long_text);
+
+    // pretty-printing
+    const auto write_sample = [](auto& w) {
+        w.declaration().begin_section("root");
+        w.begin_section("list").attribute("size", 2);
+        w.begin_section("item").text("one").end_section();
+        w.begin_section("item").attribute("last", "yes").end_section();
+        w.end_section();
+        w.comment("mixed").begin_section("p").text("text ").begin_section("b").text("bold").end_section();
+        w.text(" more").end_section();
+        w.finish();
+    };
+    out.clear();
+    util::xml_writer<std::string> pretty_writer(out, 2);
+    write_sample(pretty_writer);
+    VERIFY(out ==
+           "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<root>\n"
+           "  <list size=\"2\">\n"
+           "    <item>one</item>\n"
+           "    <item last=\"yes\"/>\n"
+           "  </list>\n"
+           "  <!--mixed-->\n"
+           "  <p>text <b>bold</b> more</p>\n"
+           "</root>\n");
+
+    // the same tokens as without pretty-printing, except for whitespace text
+    const auto significant_tokens = [](std::string_view doc) {
+        std::vector<xml_token_t> tokens;
+        util::xml_parser parser(doc);
+        for (auto tt = parser.next_token(); tt != util::xml_parser_token::kEof; tt = parser.next_token()) {
+            VERIFY(tt != util::xml_parser_token::kParsingError);
+            if (tt == util::xml_parser_token::kPlainText &&
+                parser.text().find_first_not_of(" \n") == std::string_view::npos) {
+                continue;
+            }
+            tokens.emplace_back(get_token(parser, tt));
+            tokens.back().line = 0;
+        }
+        return tokens;
+    };
+    std::string compact;
+    util::xml_writer<std::string> compact_writer(compact);
+    write_sample(compact_writer);
+    VERIFY(significant_tokens(out) == significant_tokens(compact));
+
+    // stream sink
+    std::ostringstream ss;
+    util::ostream_sink sink(ss);
+    util::xml_writer<util::ostream_sink> stream_writer(sink);
+    write_sample(stream_writer);
+    VERIFY(ss.str() == compact);
+}
+
+static void dump_node(util::xml_node node, std::string& out) {
+    out += node.is_text() ? "text:" + std::string(node.text()) : "element:" + std::string(node.name());
+    out += '@' + std::to_string(node.line());
+    for (const auto& attr : node.attributes()) {
+        out += ' ' + std::string(attr.first) + '=' + std::string(attr.second);
+    }
+    out += '{';
+    for (util::xml_node child = node.first_child(); child; child = child.next_sibling()) {
+        VERIFY(child.parent() == node);
+        dump_node(child, out);
+    }
+    out += '}';
+}
+
+static void test_8() {  // document tree
+    const std::string_view doc =
+        "<?xml version=\"1.0\"?>\n"
+        "<config version=\"3\">\n"
+        "  <name>demo &amp; test</name>\n"
+        "  <size w=\"640\" h=\"480\" title=\"a &lt; b\"/>\n"
+        "  <ratio>1.5</ratio>\n"
+        "  <items>\n"
+        "    <item id=\"1\">first</item>\n"
+        "    <!-- <item id=\"0\"> -->\n"
+        "    <item id=\"2\" note=\"a > b\"><sub>deep</sub> tail</item>\n"
+        "  </items>\n"
+        "</config>\n";
+
+    util::xml_document eager;
+    VERIFY(eager.load(doc) && !eager.has_errors());
+    util::xml_node root = eager.root();
+    VERIFY(root && root.name() == "config" && root.line() == 2 && root.attribute_value<int>("version") == 3);
+    VERIFY(!root.parent().parent() && root.parent() == eager.document_node());
+    VERIFY(root.child("name").text() == "demo & test" && root.child("name").line() == 3);
+    VERIFY(root.child("size").attribute_value<unsigned>("w") == 640 && root.child("size").attribute("h") == "480");
+    VERIFY(root.child("size").attribute("title") == "a < b" && root.child("size").attribute("none", "-") == "-");
+    VERIFY(!root.child("size").first_child() && !root.child("size").attribute_value("none").valid());
+    VERIFY(root.child("ratio").value<double>() == 1.5 && root.child("ratio").value().value<std::string>() == "1.5");
+    VERIFY(!root.child("missing"));
+    util::xml_node item = root.child("items").child("item");
+    VERIFY(item.attribute("id") == "1" && item.text() == "first");
+    item = item.next_sibling("item");
+    VERIFY(item.attribute_value<int>("id") == 2 && item.attribute("note") == "a > b" && item.line() == 9);
+    VERIFY(item.text() == " tail" && item.child("sub").text() == "deep" && !item.next_sibling("item"));
+    VERIFY(eager.node_count() == 14);
+
+    std::string expected;
+    dump_node(eager.document_node(), expected);
+
+    // deferred content gives the same tree
+    for (unsigned eager_depth = 1; eager_depth < 4; ++eager_depth) {
+        util::xml_document lazy;
+        VERIFY(lazy.load(doc, eager_depth));
+        VERIFY(lazy.node_count() < eager.node_count() && lazy.root().is_materialized() == (eager_depth > 1));
+        std::string dump;
+        dump_node(lazy.document_node(), dump);
+        VERIFY(dump == expected && lazy.node_count() == eager.node_count() && !lazy.has_errors());
+    }
+
+    // only visited subtrees are parsed
+    util::xml_document lazy;
+    VERIFY(lazy.load(doc, 2) && lazy.node_count() == 8);
+    util::xml_node items = lazy.root().child("items");
+    VERIFY(!items.is_materialized() && items.line() == 6);
+    VERIFY(items.child("item").next_sibling("item").attribute("id") == "2" && items.is_materialized());
+    VERIFY(lazy.node_count() == 11 && !items.child("item").next_sibling("item").is_materialized());
+
+    // names are interned
+    util::string_pool names;
+    util::xml_document with_pool(&names);
+    std::istringstream iss{std::string(doc)};
+    VERIFY(with_pool.load(iss) && with_pool.root().name().data() == names.find("config").data());
+
+    // malformed documents
+    std::cout << "expected errors:" << std::endl;
+    VERIFY(!eager.load("<a><b></a>") && eager.has_errors());
+    VERIFY(!eager.load("<a><b>") && !eager.load("</a>"));
+    VERIFY(lazy.load("<a><b></c></a>", 1) && !lazy.has_errors());
+    VERIFY(lazy.root().first_child().name() == "b" && lazy.has_errors());  // nodes before the error are kept
+}
+
+// --------------------------------------------
+
+static void test_100() {
+    std::string doc;
+    doc += "<root>\n";
+    for (int i = 0; i < N; ++i) {
+        doc += "  <item id=\"" + std::to_string(i) + "\" kind=\"regular\">value &amp; more</item>\n";
+    }
+    doc += "</root>\n";
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- xml_parser performance..." << std::flush;
+    std::istringstream ss(doc);
+    util::xml_parser parser(ss);
+    size_t count = 0;
+    auto start = std::clock();
+    for (auto tt = parser.next_token(); tt != util::xml_parser_token::kEof; tt = parser.next_token()) {
+        VERIFY(tt != util::xml_parser_token::kParsingError);
+        if (tt == util::xml_parser_token::kSection) { count += parser.attributes().size(); }
+    }
+    std::cout << " parse=" << (std::clock() - start) << " names=" << parser.names().size() << std::endl;
+    VERIFY(count == 2 * size_t(N));
+}
+
+static void test_101() {
+    std::string doc;
+    doc += "<root>\n";
+    for (int i = 0; i < 10 * N; ++i) {
+        doc += "  <item id=\"" + std::to_string(i) + "\" kind=\"regular\">some plain text value</item>\n";
+    }
+    doc += "</root>\n";
+
+    const auto parse = [](util::xml_parser& parser) {
+        size_t count = 0;
+        for (auto tt = parser.next_token(); tt != util::xml_parser_token::kEof; tt = parser.next_token()) {
+            VERIFY(tt != util::xml_parser_token::kParsingError);
+            if (tt == util::xml_parser_token::kSection) { count += parser.attributes().size(); }
+        }
+        return count;
+    };
+
+    const auto mb_per_sec = [&doc](std::clock_t ticks) {
+        return static_cast<double>(doc.size()) * CLOCKS_PER_SEC / (1048576. * std::max<std::clock_t>(ticks, 1));
+    };
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- xml_parser buffer vs stream (" << doc.size() / 1048576 << " MB)..." << std::flush;
+
+    auto start = std::clock();
+    std::istringstream ss(doc);
+    util::xml_parser stream_parser(ss);
+    VERIFY(parse(stream_parser) == 20 * size_t(N));
+    const auto stream_ticks = std::clock() - start;
+
+    start = std::clock();
+    util::xml_parser buffer_parser(doc);
+    VERIFY(parse(buffer_parser) == 20 * size_t(N));
+    const auto buffer_ticks = std::clock() - start;
+
+    std::cout << " stream=" << mb_per_sec(stream_ticks) << " MB/s buffer=" << mb_per_sec(buffer_ticks) << " MB/s"
+              << std::endl;
+}
+
+static void test_102() {
+    std::string doc;
+    doc += "<root>\n";
+    for (int i = 0; i < 2 * N; ++i) {
+        doc += "  <p class=\"text\">\n    Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod\n"
+               "    tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud\n"
+               "    exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat.\n  </p>\n"
+               "  <!-- Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore -->\n";
+    }
+    doc += "</root>\n";
+
+    const auto mb_per_sec = [&doc](std::clock_t ticks) {
+        return static_cast<double>(doc.size()) * CLOCKS_PER_SEC / (1048576. * std::max<std::clock_t>(ticks, 1));
+    };
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- xml_parser text-heavy document (" << doc.size() / 1048576 << " MB)..." << std::flush;
+
+    auto start = std::clock();
+    size_t markup_count = 0, line_count = 0;
+    for (char ch : doc) {  // byte-by-byte reference scan
+        if (ch == '<') { ++markup_count; }
+        if (ch == '\n') { ++line_count; }
+    }
+    const auto byte_loop_ticks = std::clock() - start;
+
+    start = std::clock();
+    util::xml_parser parser(doc);
+    size_t text_size = 0;
+    for (auto tt = parser.next_token(); tt != util::xml_parser_token::kEof; tt = parser.next_token()) {
+        VERIFY(tt != util::xml_parser_token::kParsingError);
+        if (tt == util::xml_parser_token::kPlainText) { text_size += parser.text().size(); }
+    }
+    const auto parse_ticks = std::clock() - start;
+    VERIFY(markup_count == 6 * size_t(N) + 2 && parser.token_line() == line_count + 1 && text_size != 0);
+
+    std::cout << " byte loop=" << mb_per_sec(byte_loop_ticks) << " MB/s parse=" << mb_per_sec(parse_ticks) << " MB/s"
+              << std::endl;
+}
+
+static void test_103() {
+    std::string doc;
+    doc += "<root>\n";
+    for (int i = 0; i < 10 * N; ++i) {
+        doc += "  <item id=\"" + std::to_string(i) + "\" kind=\"regular\">some plain text value</item>\n";
+    }
+    doc += "</root>\n";
+
+    const auto mb_per_sec = [&doc](std::clock_t ticks) {
+        return static_cast<double>(doc.size()) * CLOCKS_PER_SEC / (1048576. * std::max<std::clock_t>(ticks, 1));
+    };
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- xml_parser push mode (" << doc.size() / 1048576 << " MB)..." << std::flush;
+
+    auto start = std::clock();
+    util::xml_parser buffer_parser(doc);
+    size_t count = 0;
+    for (auto tt = buffer_parser.next_token(); tt != util::xml_parser_token::kEof; tt = buffer_parser.next_token()) {
+        ++count;
+    }
+    const auto buffer_ticks = std::clock() - start;
+
+    start = std::clock();
+    util::xml_parser push_parser;
+    size_t push_count = 0;
+    const size_t chunk_size = 4096;
+    for (size_t pos = 0;; pos += chunk_size) {
+        if (pos < doc.size()) {
+            push_parser.feed(std::string_view(doc).substr(pos, chunk_size));
+        } else {
+            push_parser.finish();
+        }
+        auto tt = push_parser.next_token();
+        for (; tt != util::xml_parser_token::kEof && tt != util::xml_parser_token::kNeedMoreData;
+             tt = push_parser.next_token()) {
+            VERIFY(tt != util::xml_parser_token::kParsingError);
+            ++push_count;
+        }
+        if (tt == util::xml_parser_token::kEof) { break; }
+    }
+    const auto push_ticks = std::clock() - start;
+    VERIFY(push_count == count);
+
+    std::cout << " buffer=" << mb_per_sec(buffer_ticks) << " MB/s push (4K chunks)=" << mb_per_sec(push_ticks)
+              << " MB/s" << std::endl;
+}
+
+static void test_104() {
+    std::string doc;
+    doc += "<root>\n";
+    for (int i = 0; i < 10 * N; ++i) {
+        doc += "  <item id=\"" + std::to_string(i) + "\" kind=\"regular\">some plain text value</item>\n";
+    }
+    doc += "</root>\n";
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- xml_parallel_parser scaling (" << doc.size() / 1048576 << " MB, "
+              << std::thread::hardware_concurrency() << " hardware threads)..." << std::endl;
+
+    for (unsigned thread_count : {1, 2, 4, 8}) {
+        util::xml_parallel_parser parser(thread_count);
+        const auto start = std::chrono::steady_clock::now();
+        VERIFY(parser.parse(doc));
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        VERIFY(parser.tokens().size() == 40 * size_t(N) + 4);
+        std::cout << "  threads=" << thread_count << " chunks=" << parser.chunk_count()
+                  << " speed=" << static_cast<double>(doc.size()) / (1048576. * std::max(seconds, 1e-6)) << " MB/s"
+                  << std::endl;
+    }
+}
+
+static void test_105() {
+    std::vector<std::string> names, texts;
+    for (int i = 0; i < 100; ++i) {
+        names.emplace_back("user" + std::to_string(i * 7919 % 1000));
+        texts.emplace_back(i % 10 ? "plain record text without special characters, id " + std::to_string(i) :
+                                    "record text with <special> & \"quoted\" characters");
+    }
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- xml_writer performance..." << std::flush;
+
+    std::FILE* f = std::fopen(null_device(), "w");
+    VERIFY(f);
+    size_t total = 0;
+    {
+        util::fd_sink sink(file_descriptor(f));
+        struct counting_sink {
+            util::fd_sink& sink;
+            size_t& count;
+            counting_sink& append(const char* s, size_t n) {
+                count += n;
+                sink.append(s, n);
+                return *this;
+            }
+        } out{sink, total};
+
+        const auto start = std::chrono::steady_clock::now();
+        util::xml_writer<counting_sink> writer(out, 2);
+        writer.declaration().begin_section("records");
+        for (int i = 0; i < 50 * N; ++i) {
+            writer.begin_section("record").attribute("id", i).attribute("name", names[i % 100]);
+            writer.text(texts[i % 100]).end_section();
+        }
+        writer.finish();
+        VERIFY(sink.flush());
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << " " << total / 1048576 << " MB written, speed="
+                  << static_cast<double>(total) / (1048576. * std::max(seconds, 1e-6)) << " MB/s" << std::endl;
+    }
+    std::fclose(f);
+}
+
+namespace {
+// Tree of separately allocated nodes, as typically built from parser tokens
+struct naive_node {
+    std::string name;
+    std::string text;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    std::vector<std::unique_ptr<naive_node>> children;
+
+    // Estimated heap usage with 16 bytes of allocation overhead
+    size_t memory_usage() const {
+        const auto string_usage = [](const std::string& s) { return s.capacity() > 15 ? s.capacity() + 17 : 0; };
+        size_t size = sizeof(naive_node) + 16 + string_usage(name) + string_usage(text);
+        if (attributes.capacity()) { size += attributes.capacity() * sizeof(attributes[0]) + 16; }
+        if (children.capacity()) { size += children.capacity() * sizeof(children[0]) + 16; }
+        for (const auto& attr : attributes) { size += string_usage(attr.first) + string_usage(attr.second); }
+        for (const auto& child : children) { size += child->memory_usage(); }
+        return size;
+    }
+};
+}  // namespace
+
+static void test_106() {
+    std::string doc = "<?xml version=\"1.0\"?>\n<records>\n";
+    for (int i = 0; i < 5 * N; ++i) {
+        doc += "  <record id=\"" + std::to_string(i) + "\" kind=\"regular\">\n";
+        doc += "    <name>user " + std::to_string(i % 1000) + " &amp; co</name>\n";
+        doc += "    <value>" + std::to_string(i * 0.5) + "</value>\n";
+        doc += "    <tags><tag>first</tag><tag>second</tag></tags>\n";
+        doc += "  </record>\n";
+    }
+    doc += "</records>\n";
+
+    std::cout << std::endl << "-----------------------------------------------------------" << std::endl;
+    std::cout << "---------- DOM build (" << doc.size() / 1048576 << " MB)..." << std::endl;
+
+    const auto report = [&doc](const char* title, double seconds, int64_t allocs, size_t memory) {
+        std::cout << "  " << title << ": " << static_cast<double>(doc.size()) / (1048576. * std::max(seconds, 1e-6))
+                  << " MB/s, allocations=" << allocs << ", memory=" << memory / 1048576 << " MB" << std::endl;
+    };
+
+    {
+        auto new_cnt = new_counter::cnt.load();
+        const auto start = std::chrono::steady_clock::now();
+        naive_node root;
+        std::vector<naive_node*> stack{&root};
+        util::xml_parser parser(doc);
+        for (auto tt = parser.next_token(); tt != util::xml_parser_token::kEof; tt = parser.next_token()) {
+            VERIFY(tt != util::xml_parser_token::kParsingError);
+            if (tt == util::xml_parser_token::kSection) {
+                stack.back()->children.emplace_back(std::make_unique<naive_node>());
+                naive_node* node = stack.back()->children.back().get();
+                node->name = std::string(parser.name());
+                for (const auto& attr : parser.attributes()) {
+                    node->attributes.emplace_back(std::string(attr.first), std::string(attr.second));
+                }
+                stack.push_back(node);
+            } else if (tt == util::xml_parser_token::kEndOfSection) {
+                stack.pop_back();
+            } else if (tt == util::xml_parser_token::kPlainText &&
+                       parser.text().find_first_not_of(" \t\r\n") != std::string_view::npos) {
+                stack.back()->text += parser.text();
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        VERIFY(root.children[0]->children.size() == 5 * size_t(N));
+        report("naive     ", seconds, new_counter::cnt - new_cnt, root.memory_usage());
+    }
+
+    for (unsigned eager_depth : {static_cast<unsigned>(util::xml_document::kEagerAll), 2u}) {
+        auto new_cnt = new_counter::cnt.load();
+        const auto start = std::chrono::steady_clock::now();
+        util::xml_document document;
+        VERIFY(document.load(doc, eager_depth));
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report(eager_depth == 2 ? "deferred  " : "arena     ", seconds, new_counter::cnt - new_cnt,
+               document.memory_usage());
+
+        // visit each 100th record
+        const auto visit_start = std::chrono::steady_clock::now();
+        int n = 0;
+        for (util::xml_node record = document.root().child("record"); record; record = record.next_sibling(), ++n) {
+            if (n % 100) { continue; }
+            VERIFY(record.child("value").value<double>() == n * 0.5);
+        }
+        VERIFY(n == 5 * N);
+        std::cout << "    sparse visit: "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - visit_start).count() * 1000.
+                  << " ms" << std::endl;
+    }
+}
+
+// --------------------------------------------
+
+std::pair<std::pair<size_t, void (*)()>*, size_t> get_xml_tests() {
+    static std::pair<size_t, void (*)()> _tests[] = {
+        {0, test_0},
+        {1, test_1},
+        {2, test_2},
+        {3, test_3},
+        {4, test_4},
+        {5, test_5},
+        {6, test_6},
+        {7, test_7},
+        {8, test_8},
+        {100, test_100},
+        {101, test_101},
+        {102, test_102},
+        {103, test_103},
+        {104, test_104},
+        {105, test_105},
+        {106, test_106},
+    };
+
+    return std::make_pair(_tests, sizeof(_tests) / sizeof(_tests[0]));
+}